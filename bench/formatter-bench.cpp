@@ -6,6 +6,7 @@
 #include "benchmark/benchmark.h"
 
 #include "spdlog/spdlog.h"
+#include "spdlog/details/fmt_helper.h"
 #include "spdlog/pattern_formatter.h"
 
 void bench_formatter(benchmark::State &state, std::string pattern) {
@@ -25,6 +26,40 @@ void bench_formatter(benchmark::State &state, std::string pattern) {
     }
 }
 
+// bench the fixed width kernels used by the time and elapsed flags
+template <typename Kernel>
+void bench_kernel(benchmark::State &state, Kernel kernel, uint32_t max_value) {
+    spdlog::memory_buf_t dest;
+    uint32_t n = 0;
+    for (auto _ : state) {
+        dest.clear();
+        kernel(n, dest);
+        benchmark::DoNotOptimize(dest);
+        n = n + 7919 < max_value ? n + 7919 : 0;
+    }
+}
+
+void bench_kernels() {
+    using namespace spdlog::details::fmt_helper;
+    benchmark::RegisterBenchmark("pad2", [](benchmark::State &state) {
+        bench_kernel(state, [](uint32_t n, spdlog::memory_buf_t &d) { pad2(int(n), d); }, 100);
+    });
+    benchmark::RegisterBenchmark("pad3", [](benchmark::State &state) {
+        bench_kernel(state, [](uint32_t n, spdlog::memory_buf_t &d) { pad3(n, d); }, 1000);
+    });
+    benchmark::RegisterBenchmark("pad6", [](benchmark::State &state) {
+        bench_kernel(state, [](uint32_t n, spdlog::memory_buf_t &d) { pad6(n, d); }, 1000000);
+    });
+    benchmark::RegisterBenchmark("pad9", [](benchmark::State &state) {
+        bench_kernel(state, [](uint32_t n, spdlog::memory_buf_t &d) { pad9(n, d); },
+                     1000000000);
+    });
+    benchmark::RegisterBenchmark("append_int", [](benchmark::State &state) {
+        bench_kernel(state, [](uint32_t n, spdlog::memory_buf_t &d) { append_int(n, d); },
+                     1000000000);
+    });
+}
+
 void bench_formatters() {
     // basic patterns(single flag)
     std::string all_flags = "+vtPnlLaAbBcCYDmdHIMSefFprRTXzEisg@luioO%";
@@ -32,13 +67,6 @@ void bench_formatters() {
     for (auto &flag : all_flags) {
         auto pattern = std::string("%") + flag;
         benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern);
-
-        //        pattern = std::string("%16") + flag;
-        //        benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern);
-        //
-        //        // bench center padding
-        //        pattern = std::string("%=16") + flag;
-        //        benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern);
     }
 
     // complex patterns
@@ -53,16 +81,113 @@ void bench_formatters() {
     }
 }
 
+// custom flag used by the matrix, appends a fixed text
+class custom_bench_flag : public spdlog::custom_flag_formatter {
+public:
+    void format(const spdlog::details::log_msg &,
+                const std::tm &,
+                spdlog::memory_buf_t &dest) override {
+        static const spdlog::string_view_t text = "custom-flag";
+        dest.append(text.data(), text.data() + text.size());
+    }
+
+    std::unique_ptr<custom_flag_formatter> clone() const override {
+        return spdlog::details::make_unique<custom_bench_flag>();
+    }
+};
+
+struct matrix_entry {
+    char flag;
+    std::string pad;      // padding spec between the '%' and the flag
+    std::string time;     // cached, local, utc
+    std::string payload;  // short, long
+};
+
+// bench one cell of the matrix.
+// time=cached logs the same timestamp every time, so the formatter's per second std::tm cache
+// always hits. time=local and time=utc advance the timestamp by a second per message, so each
+// message pays the localtime / gmtime conversion.
+void bench_matrix_entry(benchmark::State &state, matrix_entry e) {
+    auto time_type =
+        e.time == "utc" ? spdlog::pattern_time_type::utc : spdlog::pattern_time_type::local;
+    auto pattern = e.flag == '\0' ? std::string() : "%" + e.pad + e.flag;
+    auto formatter =
+        spdlog::details::make_unique<spdlog::pattern_formatter>(pattern, time_type, "");
+    formatter->add_flag<custom_bench_flag>('*');
+    spdlog::memory_buf_t dest;
+    std::string logger_name = "logger-name";
+    std::string text = e.payload == "long" ? std::string(1024, 'x')
+                                           : std::string("Hello, short message");
+
+    spdlog::source_loc source_loc{"a/b/c/d/myfile.cpp", 123, "some_func()"};
+    spdlog::details::log_msg msg(source_loc, logger_name, spdlog::level::info, text);
+    const auto step = e.time == "cached" ? std::chrono::seconds(0) : std::chrono::seconds(1);
+
+    for (auto _ : state) {
+        dest.clear();
+        msg.time += step;
+        formatter->format(msg, dest);
+        benchmark::DoNotOptimize(dest);
+    }
+}
+
+// per flag cost matrix: every flag of pattern_formatter (and a custom flag '*'), without padding
+// (null_scoped_padder) and with left, right, center and truncate padding (scoped_padder). The time
+// flags also with local and utc conversions, the payload flags also with a long payload.
+// Benchmark names are "matrix/<flag>/pad=<side>/time=<type>/payload=<size>", and
+// "matrix/baseline" is the cost of an empty pattern, to be subtracted. For a machine readable
+// table, run with --benchmark_format=csv (or json).
+void bench_matrix() {
+    const std::string flags = "+vtPnlLaAbBcCYDmdHIMSefFEprRTXz^$@sg#!%uioOkKq&*";
+    const std::string time_flags = "+aAbBcCYDmdHIMSprRTXz";
+    const std::string payload_flags = "+v";
+    const std::vector<std::pair<std::string, std::string>> pads = {
+        {"none", ""}, {"left", "16"}, {"right", "-16"}, {"center", "=16"}, {"truncate", "4!"}};
+
+    auto add = [](const std::string &name, matrix_entry e) {
+        benchmark::RegisterBenchmark(name.c_str(), &bench_matrix_entry, std::move(e))
+            ->MinTime(0.05);
+    };
+    add("matrix/baseline", matrix_entry{'\0', "", "cached", "short"});
+    for (auto flag : flags) {
+        std::vector<std::string> times = {"cached"};
+        if (time_flags.find(flag) != std::string::npos) {
+            times.insert(times.end(), {"local", "utc"});
+        }
+        std::vector<std::string> payloads = {"short"};
+        if (payload_flags.find(flag) != std::string::npos) {
+            payloads.emplace_back("long");
+        }
+        for (auto &pad : pads) {
+            for (auto &time : times) {
+                for (auto &payload : payloads) {
+                    auto name = spdlog::fmt_lib::format("matrix/%{}/pad={}/time={}/payload={}",
+                                                        flag, pad.first, time, payload);
+                    add(name, matrix_entry{flag, pad.second, time, payload});
+                }
+            }
+        }
+    }
+}
+
 int main(int argc, char *argv[]) {
     spdlog::set_pattern("[%^%l%$] %v");
-    if (argc != 2) {
-        spdlog::error("Usage: {} <pattern> (or \"all\" to bench all)", argv[0]);
+    if (argc < 2) {
+        spdlog::error(
+            "Usage: {} <pattern> (or \"all\" to bench all, \"kernels\" for fmt_helper, "
+            "\"matrix\" for the per flag matrix), followed by google benchmark options",
+            argv[0]);
         exit(1);
     }
 
     std::string pattern = argv[1];
     if (pattern == "all") {
+        bench_kernels();
         bench_formatters();
+    } else if (pattern == "kernels") {
+        bench_kernels();
+    } else if (pattern == "matrix") {
+        bench_matrix();
     } else {
         benchmark::RegisterBenchmark(pattern.c_str(), &bench_formatter, pattern);
     }
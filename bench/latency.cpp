@@ -15,6 +15,7 @@
 #include "spdlog/sinks/daily_file_sink.h"
 #include "spdlog/sinks/null_sink.h"
 #include "spdlog/sinks/rotating_file_sink.h"
+#include "spdlog/static_logger.h"
 
 void bench_c_string(benchmark::State &state, std::shared_ptr<spdlog::logger> logger) {
     const char *msg =
@@ -39,6 +40,14 @@ void bench_logger(benchmark::State &state, std::shared_ptr<spdlog::logger> logge
         logger->info("Hello logger: msg number {}...............", ++i);
     }
 }
+template <typename StaticLogger>
+void bench_static_logger(benchmark::State &state, StaticLogger *logger) {
+    int i = 0;
+    for (auto _ : state) {
+        logger->info("Hello logger: msg number {}...............", ++i);
+    }
+}
+
 void bench_global_logger(benchmark::State &state, std::shared_ptr<spdlog::logger> logger) {
     spdlog::set_default_logger(std::move(logger));
     int i = 0;
@@ -121,6 +130,13 @@ int main(int argc, char *argv[]) {
     tracing_null_logger_st->enable_backtrace(64);
     benchmark::RegisterBenchmark("null_sink_st/backtrace", bench_logger, tracing_null_logger_st);
 
+    // compile time composed logger, no virtual calls
+    using static_null_logger_st =
+        spdlog::static_logger_st<spdlog::pattern_formatter, spdlog::sinks::static_null_sink>;
+    static_null_logger_st static_null_logger("bench", spdlog::sinks::static_null_sink());
+    benchmark::RegisterBenchmark("static_logger null_sink_st",
+                                 bench_static_logger<static_null_logger_st>, &static_null_logger);
+
 #ifdef __linux__
     bench_dev_null();
 #endif  // __linux__
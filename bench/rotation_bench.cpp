@@ -0,0 +1,227 @@
+//
+// Copyright(c) 2015 Gabi Melman.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+//
+
+//
+// rotation_bench.cpp : latency and throughput of file rotation (rotating and daily sinks).
+// Each scenario logs to a sink with a small max_size (rotating) or with accelerated time
+// (daily: the message timestamps advance by a day every 1000 messages), and reports
+// the per call latency percentiles of all calls and of the calls that rotated, the throughput and
+// the read/write syscalls and context switches per 1000 messages.
+// Usage: rotation_bench [messages] [dir ...]
+// By default runs in /dev/shm (tmpfs) and in ./rotation_logs (disk).
+//
+#include "spdlog/spdlog.h"
+#include "spdlog/sinks/daily_file_sink.h"
+#include "spdlog/sinks/rotating_file_sink.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+    #include <sys/resource.h>
+#endif
+#ifdef __linux__
+    #include <sys/vfs.h>
+#endif
+
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using clock_type = std::chrono::steady_clock;
+
+namespace {
+struct scenario {
+    std::string name;
+    // log times advance by this much per message (0 - real time)
+    std::chrono::seconds time_step;
+    std::function<spdlog::sink_ptr(const spdlog::filename_t &dir,
+                                   const spdlog::file_event_handlers &handlers)>
+        make_sink;
+};
+
+struct os_counters {
+    uint64_t read_calls = 0;
+    uint64_t write_calls = 0;
+    long context_switches = 0;
+};
+
+os_counters read_os_counters() {
+    os_counters c;
+#ifdef __linux__
+    if (auto *f = std::fopen("/proc/self/io", "r")) {
+        char key[64];
+        unsigned long long value;
+        while (std::fscanf(f, "%63[^:]: %llu\n", key, &value) == 2) {
+            if (std::string(key) == "syscr") {
+                c.read_calls = value;
+            } else if (std::string(key) == "syscw") {
+                c.write_calls = value;
+            }
+        }
+        std::fclose(f);
+    }
+#endif
+#ifndef _WIN32
+    rusage usage{};
+    ::getrusage(RUSAGE_SELF, &usage);
+    c.context_switches = usage.ru_nvcsw + usage.ru_nivcsw;
+#endif
+    return c;
+}
+
+std::string fs_type(const std::string &dir) {
+#ifdef __linux__
+    struct statfs st{};
+    if (::statfs(dir.c_str(), &st) == 0) {
+        return st.f_type == 0x01021994 ? "tmpfs" : "disk";
+    }
+#endif
+    (void)dir;
+    return "?";
+}
+
+// the given percentile of sorted latencies, in microseconds
+std::string percentile(const std::vector<uint64_t> &sorted, double p) {
+    if (sorted.empty()) {
+        return "-";
+    }
+    auto i = static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1));
+    return spdlog::fmt_lib::format("{:.1f}", static_cast<double>(sorted[i]) / 1000.0);
+}
+
+void run(const scenario &s, const std::string &dir, size_t messages) {
+    size_t opens = 0;
+    std::vector<spdlog::filename_t> files;
+    spdlog::file_event_handlers handlers;
+    handlers.after_open = [&](const spdlog::filename_t &filename, std::FILE *) {
+        opens++;
+        if (std::find(files.begin(), files.end(), filename) == files.end()) {
+            files.push_back(filename);
+        }
+    };
+    auto sink = s.make_sink(dir, handlers);
+    spdlog::logger logger("rotation_bench", sink);
+
+    std::vector<uint64_t> latencies, rotation_latencies;
+    latencies.reserve(messages);
+    const char *text = "rotation bench message with some payload to fill the files quickly...";
+    auto log_time = spdlog::log_clock::now();
+    auto counters_before = read_os_counters();
+    auto start = clock_type::now();
+    for (size_t i = 0; i < messages; i++) {
+        size_t opens_before = opens;
+        auto t0 = clock_type::now();
+        if (s.time_step.count() != 0) {
+            log_time += s.time_step;
+            logger.log(log_time, spdlog::source_loc{}, spdlog::level::info, text);
+        } else {
+            logger.info("{} #{}", text, i);
+        }
+        auto ns = static_cast<uint64_t>(duration_cast<nanoseconds>(clock_type::now() - t0).count());
+        latencies.push_back(ns);
+        if (opens != opens_before) {
+            rotation_latencies.push_back(ns);
+        }
+    }
+    logger.flush();
+    auto elapsed = std::chrono::duration<double>(clock_type::now() - start).count();
+    auto counters_after = read_os_counters();
+    size_t rotations = rotation_latencies.size();
+    sink.reset();
+
+    std::sort(latencies.begin(), latencies.end());
+    std::sort(rotation_latencies.begin(), rotation_latencies.end());
+    auto per_1k = [messages](uint64_t n) {
+        return static_cast<double>(n) * 1000.0 / static_cast<double>(messages);
+    };
+    spdlog::info(
+        "{:<26} {:<5} {:>9.0f}/s {:>6} rot | us p50 {:>5} p99 {:>6} p99.9 {:>7} max {:>8} | rot "
+        "p50 {:>7} max {:>8} | per 1k: {:.0f} writes {:.0f} reads {:.1f} ctx",
+        s.name, fs_type(dir), static_cast<double>(messages) / elapsed, rotations,
+        percentile(latencies, 50), percentile(latencies, 99), percentile(latencies, 99.9),
+        percentile(latencies, 100), percentile(rotation_latencies, 50),
+        percentile(rotation_latencies, 100),
+        per_1k(counters_after.write_calls - counters_before.write_calls),
+        per_1k(counters_after.read_calls - counters_before.read_calls),
+        per_1k(static_cast<uint64_t>(counters_after.context_switches -
+                                     counters_before.context_switches)));
+
+    // remove the files of the scenario, including the rotated ones
+    for (auto &f : files) {
+        spdlog::details::os::remove_if_exists(f);
+        for (size_t i = 1; i <= 20; i++) {
+            spdlog::details::os::remove_if_exists(
+                spdlog::sinks::rotating_file_sink_st::calc_filename(f, i));
+        }
+    }
+}
+
+std::vector<scenario> scenarios() {
+    using spdlog::filename_t;
+    std::vector<scenario> list;
+    for (size_t max_size : {size_t(64 * 1024), size_t(1024 * 1024)}) {
+        for (size_t max_files : {size_t(1), size_t(5), size_t(20)}) {
+            list.push_back(
+                {spdlog::fmt_lib::format("rotating {}KB x{}", max_size / 1024, max_files),
+                 std::chrono::seconds(0),
+                 [max_size, max_files](const filename_t &dir,
+                                       const spdlog::file_event_handlers &handlers) {
+                     return std::make_shared<spdlog::sinks::rotating_file_sink_st>(
+                         dir + "/rotating.log", max_size, max_files, false, handlers);
+                 }});
+        }
+    }
+    // a day every 1000 messages
+    for (uint16_t max_files : {uint16_t(0), uint16_t(5), uint16_t(20)}) {
+        list.push_back({spdlog::fmt_lib::format("daily 1day/1000msgs x{}", max_files),
+                        std::chrono::seconds(24 * 3600 / 1000),
+                        [max_files](const filename_t &dir,
+                                    const spdlog::file_event_handlers &handlers) {
+                            return std::make_shared<spdlog::sinks::daily_file_sink_st>(
+                                dir + "/daily.log", 0, 0, true, max_files, handlers);
+                        }});
+    }
+    return list;
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    size_t messages = 200000;
+    std::vector<std::string> dirs;
+    if (argc > 1) {
+        messages = static_cast<size_t>(std::atoll(argv[1]));
+    }
+    for (int i = 2; i < argc; i++) {
+        dirs.emplace_back(argv[i]);
+    }
+    if (dirs.empty()) {
+#ifdef __linux__
+        dirs.emplace_back("/dev/shm/spdlog_rotation_bench");
+#endif
+        dirs.emplace_back("rotation_logs");
+    }
+    if (messages == 0) {
+        std::fprintf(stderr, "Usage: %s [messages] [dir ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    spdlog::set_pattern("[%^%l%$] %v");
+    spdlog::info("{} messages per scenario", messages);
+    SPDLOG_TRY {
+        for (auto &dir : dirs) {
+            spdlog::details::os::create_dir(dir);
+            for (auto &s : scenarios()) {
+                run(s, dir, messages);
+            }
+        }
+    }
+    SPDLOG_CATCH_STD
+    return EXIT_SUCCESS;
+}
@@ -93,6 +93,14 @@ inline void init_thread_pool(size_t q_size, size_t thread_count) {
         q_size, thread_count, [] {}, [] {});
 }
 
+// set global thread pool with the given queue memory options (huge pages, prefault, mlock).
+inline void init_thread_pool(size_t q_size,
+                             size_t thread_count,
+                             const queue_memory_options &mem_options) {
+    auto tp = std::make_shared<details::thread_pool>(q_size, thread_count, mem_options);
+    details::registry::instance().set_tp(std::move(tp));
+}
+
 // get the global thread pool.
 inline std::shared_ptr<spdlog::details::thread_pool> thread_pool() {
     return details::registry::instance().get_tp();
@@ -42,6 +42,23 @@ else {
 SPDLOG_LOGGER_CATCH(msg.source)
 }
 
+// send the log message to the thread pool without copying its payload.
+// the worker releases the payload when done with it (see external_payload for the other cases).
+SPDLOG_INLINE void spdlog::async_logger::sink_external_(const details::log_msg &msg,
+                                                        const external_payload &payload) {
+    SPDLOG_TRY {
+        if (auto pool_ptr = thread_pool_.lock()) {
+            pool_ptr->post_log(shared_from_this(), msg, payload, overflow_policy_);
+        } else {
+            if (payload.release != nullptr) {
+                payload.release(payload.context);
+            }
+            throw_spdlog_ex("async log: thread pool doesn't exist anymore");
+        }
+    }
+    SPDLOG_LOGGER_CATCH(msg.source)
+}
+
 // send flush request to the thread pool
 SPDLOG_INLINE void spdlog::async_logger::flush_(){SPDLOG_TRY{auto pool_ptr = thread_pool_.lock();
 if (!pool_ptr) {
@@ -72,6 +89,60 @@ SPDLOG_INLINE void spdlog::async_logger::backend_sink_it_(const details::log_msg
     }
 }
 
+SPDLOG_INLINE void spdlog::async_logger::backend_format_(
+    const details::log_msg &msg, std::vector<details::sink_output> &outputs) {
+    outputs.resize(sinks_.size());
+    for (size_t i = 0; i < sinks_.size(); i++) {
+        auto &output = outputs[i];
+        output.formatted = false;
+        output.buf.clear();
+        if (sinks_[i]->should_log(msg.level)) {
+            SPDLOG_TRY { output.formatted = sinks_[i]->format_unlocked(msg, output.buf); }
+            SPDLOG_LOGGER_CATCH(msg.source)
+        }
+    }
+}
+
+SPDLOG_INLINE void spdlog::async_logger::backend_sink_formatted_(
+    const details::log_msg &msg, const std::vector<details::sink_output> &outputs) {
+    for (size_t i = 0; i < sinks_.size(); i++) {
+        auto &sink = sinks_[i];
+        if (sink->should_log(msg.level)) {
+            SPDLOG_TRY {
+                if (i < outputs.size() && outputs[i].formatted) {
+                    sink->log_formatted(msg, outputs[i].buf);
+                } else {
+                    sink->log(msg);
+                }
+            }
+            SPDLOG_LOGGER_CATCH(msg.source)
+        }
+    }
+
+    if (should_flush_(msg)) {
+        backend_flush_();
+    }
+}
+
+SPDLOG_INLINE void spdlog::async_logger::backend_check_sequence_(const details::log_msg &msg) {
+    auto expected = backend_sequence_ + 1;
+    backend_sequence_ = msg.sequence;
+    if (msg.sequence <= expected) {
+        return;
+    }
+    SPDLOG_TRY {
+        auto text = fmt_lib::format("{} messages dropped (seq {}..{})", msg.sequence - expected,
+                                    expected, msg.sequence - 1);
+        details::log_msg gap_msg(msg.time, source_loc{}, name_, level::warn, text);
+        for (auto &sink : sinks_) {
+            if (sink->should_log(gap_msg.level)) {
+                sink->log(gap_msg);
+            }
+        }
+    }
+    SPDLOG_LOGGER_CATCH(msg.source)
+}
+
 SPDLOG_INLINE void spdlog::async_logger::backend_flush_() {
     for (auto &sink : sinks_) {
         SPDLOG_TRY { sink->flush(); }
@@ -82,5 +153,8 @@ SPDLOG_INLINE void spdlog::async_logger::backend_flush_() {
 SPDLOG_INLINE std::shared_ptr<spdlog::logger> spdlog::async_logger::clone(std::string new_name) {
     auto cloned = std::make_shared<spdlog::async_logger>(*this);
     cloned->name_ = std::move(new_name);
+    cloned->enqueued_sequence_ = 0;
+    cloned->backend_sequence_ = 0;
+    cloned->backend_period_ = 0;
     return cloned;
 }
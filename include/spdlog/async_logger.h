@@ -13,6 +13,12 @@
 //    space is available in the queue)
 // Upon destruction, logs all remaining messages in the queue before
 // destructing..
+//
+// Each message is given the next sequence number of the logger when it enters the queue (the %q
+// flag). Messages lost to the overrun_oldest or discard_new policies leave gaps in the sequence,
+// and the worker writes a "N messages dropped (seq a..b)" warning to the sinks before the next
+// message of the logger (if the thread pool has a single thread or formats in parallel, otherwise
+// the messages of a logger may be processed out of order).
 
 #include <spdlog/logger.h>
 
@@ -28,11 +34,14 @@ enum class async_overflow_policy {
 
 namespace details {
 class thread_pool;
+struct sequence_stamp;
+struct sink_output;
 }
 
 class SPDLOG_API async_logger final : public std::enable_shared_from_this<async_logger>,
                                       public logger {
     friend class details::thread_pool;
+    friend struct details::sequence_stamp;
 
 public:
     template <typename It>
@@ -59,13 +68,27 @@ public:
 
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_external_(const details::log_msg &msg, const external_payload &payload) override;
     void flush_() override;
     void backend_sink_it_(const details::log_msg &incoming_log_msg);
+    // parallel formatting (see thread_pool::set_parallel_formatting()):
+    // format the message for each sink that can format it outside of its mutex,
+    // then write it to the sinks, after the messages queued before it.
+    void backend_format_(const details::log_msg &incoming_log_msg,
+                         std::vector<details::sink_output> &outputs);
+    void backend_sink_formatted_(const details::log_msg &incoming_log_msg,
+                                 const std::vector<details::sink_output> &outputs);
     void backend_flush_();
+    // write a record of the messages dropped before the given one, if any
+    void backend_check_sequence_(const details::log_msg &incoming_log_msg);
 
 private:
     std::weak_ptr<details::thread_pool> thread_pool_;
     async_overflow_policy overflow_policy_;
+    uint64_t enqueued_sequence_ = 0;  // last sequence number given, under the queue lock
+    uint64_t backend_sequence_ = 0;   // last sequence number seen by the worker
+    // parallel formatting period backend_sequence_ was last set in (see thread_pool::commit_())
+    uint64_t backend_period_ = 0;
 };
 }  // namespace spdlog
 
@@ -139,6 +139,8 @@ using filename_t = std::string;
 #endif
 
 using log_clock = std::chrono::system_clock;
+// monotonic clock, for elapsed times that are immune to wall clock adjustments (e.g. NTP)
+using mono_clock = std::chrono::steady_clock;
 using sink_ptr = std::shared_ptr<sinks::sink>;
 using sinks_init_list = std::initializer_list<sink_ptr>;
 using err_handler = std::function<void(const std::string &err_msg)>;
@@ -297,6 +299,16 @@ enum class pattern_time_type {
     utc     // log utc
 };
 
+//
+// Handling of newlines inside the payload (multi-line messages)
+//
+enum class multiline_policy {
+    keep,           // write the payload as is
+    escape,         // replace newlines with the two chars \n (crlf with \r\n)
+    repeat_header,  // start each continuation line with the header rendered before the payload
+    prefix          // start each continuation line with a fixed prefix
+};
+
 //
 // Log exception
 //
@@ -326,6 +338,31 @@ struct source_loc {
     const char *funcname{nullptr};
 };
 
+// Log payload whose memory is kept valid by the caller until it is released (a static string,
+// a memory mapped or arena owned region..).
+// Async loggers queue it without copying it, and call release(context) once the worker consumed
+// it (or the message was dropped). Other loggers call it before log() returns.
+// release is called exactly once, null for static data. With an async logger it is called by:
+// - the worker thread, once the message was processed,
+// - the logging thread, if the message was not queued (below the level, discarded for lack of
+//   room, or the byte ring queue copied the payload),
+// - the thread whose message overran it in the queue (overrun_oldest).
+// never while holding the queue lock, so release may log or use the thread pool.
+struct external_payload {
+    using release_fn = void (*)(void *context);
+
+    SPDLOG_CONSTEXPR external_payload(string_view_t data_in,
+                                      release_fn release_in = nullptr,
+                                      void *context_in = nullptr)
+        : data{data_in},
+          release{release_in},
+          context{context_in} {}
+
+    string_view_t data;
+    release_fn release;
+    void *context;
+};
+
 struct file_event_handlers {
     file_event_handlers()
         : before_open(nullptr),
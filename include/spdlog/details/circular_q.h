@@ -5,19 +5,20 @@
 #pragma once
 
 #include <cassert>
+#include <memory>
 #include <vector>
 
 #include "spdlog/common.h"
 
 namespace spdlog {
 namespace details {
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>>
 class circular_q {
     size_t max_items_ = 0;
-    typename std::vector<T>::size_type head_ = 0;
-    typename std::vector<T>::size_type tail_ = 0;
+    typename std::vector<T, Allocator>::size_type head_ = 0;
+    typename std::vector<T, Allocator>::size_type tail_ = 0;
     size_t overrun_counter_ = 0;
-    std::vector<T> v_;
+    std::vector<T, Allocator> v_;
 
 public:
     using value_type = T;
@@ -30,6 +31,13 @@ public:
           ,
           v_(max_items_) {}
 
+    // allocate the items with the given allocator
+    circular_q(size_t max_items, const Allocator &alloc)
+        : max_items_(max_items + 1),
+          v_(alloc) {
+        v_.resize(max_items_);
+    }
+
     circular_q(const circular_q &) = default;
     circular_q &operator=(const circular_q &) = default;
 
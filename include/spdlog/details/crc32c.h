@@ -0,0 +1,102 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// CRC32C (Castagnoli polynomial, as used by iSCSI, ext4 and friends).
+// Uses the SSE4.2 crc32 instruction when the cpu supports it (checked once at runtime, no
+// special compiler flags needed), and a table based implementation otherwise.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define SPDLOG_CRC32C_HW_X86
+    #include <nmmintrin.h>
+    #define SPDLOG_CRC32C_TARGET __attribute__((target("sse4.2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #define SPDLOG_CRC32C_HW_X86
+    #include <intrin.h>
+    #include <nmmintrin.h>
+    #define SPDLOG_CRC32C_TARGET
+#endif
+
+namespace spdlog {
+namespace details {
+
+namespace crc32c_impl {
+
+struct table {
+    uint32_t entries[256];
+
+    table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (0x82F63B78u & (0u - (crc & 1u)));
+            }
+            entries[i] = crc;
+        }
+    }
+};
+
+inline uint32_t update_sw(uint32_t crc, const unsigned char *p, size_t n) {
+    static const table t;
+    for (size_t i = 0; i < n; i++) {
+        crc = t.entries[(crc ^ p[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef SPDLOG_CRC32C_HW_X86
+SPDLOG_CRC32C_TARGET inline uint32_t update_hw(uint32_t crc, const unsigned char *p, size_t n) {
+    #if defined(__x86_64__) || defined(_M_X64)
+    uint64_t crc64 = crc;
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    #endif
+    for (; n >= 4; n -= 4, p += 4) {
+        uint32_t word;
+        std::memcpy(&word, p, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+    }
+    for (; n > 0; n--, p++) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+    return crc;
+}
+
+inline bool cpu_has_sse42() {
+    #if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+    #else
+    return __builtin_cpu_supports("sse4.2") != 0;
+    #endif
+}
+#endif
+
+}  // namespace crc32c_impl
+
+// Return the crc32c of the given data.
+// To checksum data in pieces, pass the result of the previous piece as crc.
+inline uint32_t crc32c(const void *data, size_t n, uint32_t crc = 0) {
+    auto *p = static_cast<const unsigned char *>(data);
+    crc = ~crc;
+#ifdef SPDLOG_CRC32C_HW_X86
+    static const bool has_hw = crc32c_impl::cpu_has_sse42();
+    if (has_hw) {
+        return ~crc32c_impl::update_hw(crc, p, n);
+    }
+#endif
+    return ~crc32c_impl::update_sw(crc, p, n);
+}
+
+}  // namespace details
+}  // namespace spdlog
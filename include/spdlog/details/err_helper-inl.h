@@ -0,0 +1,45 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/err_helper.h>
+#endif
+
+#include <spdlog/details/os.h>
+
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+
+namespace spdlog {
+namespace details {
+
+SPDLOG_INLINE void default_err_handler(const std::string &logger_name, const std::string &msg) {
+    using std::chrono::system_clock;
+    static std::mutex mutex;
+    static std::chrono::system_clock::time_point last_report_time;
+    static size_t err_counter = 0;
+    std::lock_guard<std::mutex> lk{mutex};
+    auto now = system_clock::now();
+    err_counter++;
+    if (now - last_report_time < std::chrono::seconds(1)) {
+        return;
+    }
+    last_report_time = now;
+    auto tm_time = os::localtime(system_clock::to_time_t(now));
+    char date_buf[64];
+    std::strftime(date_buf, sizeof(date_buf), "%Y-%m-%d %H:%M:%S", &tm_time);
+#if defined(USING_R) && defined(R_R_H)  // if in R environment
+    REprintf("[*** LOG ERROR #%04zu ***] [%s] [%s] %s\n", err_counter, date_buf,
+             logger_name.c_str(), msg.c_str());
+#else
+    std::fprintf(stderr, "[*** LOG ERROR #%04zu ***] [%s] [%s] %s\n", err_counter, date_buf,
+                 logger_name.c_str(), msg.c_str());
+#endif
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -0,0 +1,23 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+
+#include <string>
+
+namespace spdlog {
+namespace details {
+
+// default handler of the errors during logging (used when no custom handler was set).
+// prints the error of the given logger to stderr, at max rate of 1 message/sec shared by all
+// the loggers.
+SPDLOG_API void default_err_handler(const std::string &logger_name, const std::string &msg);
+
+}  // namespace details
+}  // namespace spdlog
+
+#ifdef SPDLOG_HEADER_ONLY
+    #include "err_helper-inl.h"
+#endif
@@ -35,9 +35,13 @@ SPDLOG_INLINE void file_helper::open(const filename_t &fname, bool truncate) {
     if (event_handlers_.before_open) {
         event_handlers_.before_open(filename_);
     }
+    const auto dir = os::dir_name(fname);
     for (int tries = 0; tries < open_tries_; ++tries) {
-        // create containing folder if not exists already.
-        os::create_dir(os::dir_name(fname));
+        // create containing folder if not known to exist already.
+        const bool dir_cached = dir_cached_(dir);
+        if (!dir_cached && os::create_dir(dir)) {
+            cache_dir_(dir);
+        }
         if (truncate) {
             // Truncate by opening-and-closing a tmp file in "wb" mode, always
             // opening the actual log-we-write-to in "ab" mode, since that
@@ -45,6 +49,7 @@ SPDLOG_INLINE void file_helper::open(const filename_t &fname, bool truncate) {
             // rotate/truncate the file underneath us.
             std::FILE *tmp;
             if (os::fopen_s(&tmp, fname, trunc_mode)) {
+                uncache_dir_(dir);
                 continue;
             }
             std::fclose(tmp);
@@ -56,6 +61,11 @@ SPDLOG_INLINE void file_helper::open(const filename_t &fname, bool truncate) {
             return;
         }
 
+        // the folder might have been removed since it was cached - create it and retry now
+        if (dir_cached) {
+            uncache_dir_(dir);
+            continue;
+        }
         details::os::sleep_for_millis(open_interval_);
     }
 
@@ -115,6 +125,49 @@ SPDLOG_INLINE size_t file_helper::size() const {
 
 SPDLOG_INLINE const filename_t &file_helper::filename() const { return filename_; }
 
+SPDLOG_INLINE void file_helper::create_dirs(const std::vector<filename_t> &fnames) {
+    for (const auto &fname : fnames) {
+        auto dir = os::dir_name(fname);
+        // a bare filename is in the current directory: nothing to create
+        if (dir.empty() || dir_cached_(dir)) {
+            continue;
+        }
+        if (!os::create_dir(dir)) {
+            throw_spdlog_ex("Failed creating directory " + os::filename_to_str(dir), errno);
+        }
+        cache_dir_(dir);
+    }
+}
+
+SPDLOG_INLINE void file_helper::clear_dir_cache() {
+    auto &cache = dir_cache_();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.dirs.clear();
+}
+
+SPDLOG_INLINE file_helper::dir_cache &file_helper::dir_cache_() {
+    static dir_cache cache;
+    return cache;
+}
+
+SPDLOG_INLINE bool file_helper::dir_cached_(const filename_t &dir) {
+    auto &cache = dir_cache_();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.dirs.find(dir) != cache.dirs.end();
+}
+
+SPDLOG_INLINE void file_helper::cache_dir_(const filename_t &dir) {
+    auto &cache = dir_cache_();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.dirs.insert(dir);
+}
+
+SPDLOG_INLINE void file_helper::uncache_dir_(const filename_t &dir) {
+    auto &cache = dir_cache_();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.dirs.erase(dir);
+}
+
 //
 // return file path and its extension:
 //
@@ -4,7 +4,10 @@
 #pragma once
 
 #include <spdlog/common.h>
+#include <mutex>
 #include <tuple>
+#include <unordered_set>
+#include <vector>
 
 namespace spdlog {
 namespace details {
@@ -12,6 +15,9 @@ namespace details {
 // Helper class for file sinks.
 // When failing to open a file, retry several times(5) with a delay interval(10 ms).
 // Throw spdlog_ex exception on errors.
+// Directories that were created (or found to exist) are remembered process wide, so
+// rotations don't mkdir the whole path again. A directory is forgotten if opening a file in
+// it fails (e.g. it was removed meanwhile), and the next try creates it again.
 
 class SPDLOG_API file_helper {
 public:
@@ -46,7 +52,24 @@ public:
     // "my_folder/.mylog.txt" => ("my_folder/.mylog", ".txt")
     static std::tuple<filename_t, filename_t> split_by_extension(const filename_t &fname);
 
+    // create the containing folders of all the given files in one go (e.g. at logger setup),
+    // so opening them later needs no directory syscalls.
+    // throw spdlog_ex if a folder could not be created.
+    static void create_dirs(const std::vector<filename_t> &fnames);
+
+    // forget all the directories known to exist
+    static void clear_dir_cache();
+
 private:
+    struct dir_cache {
+        std::mutex mutex;
+        std::unordered_set<filename_t> dirs;
+    };
+    static dir_cache &dir_cache_();
+    static bool dir_cached_(const filename_t &dir);
+    static void cache_dir_(const filename_t &dir);
+    static void uncache_dir_(const filename_t &dir);
+
     const int open_tries_ = 5;
     const unsigned int open_interval_ = 10;
     std::FILE *fd_{nullptr};
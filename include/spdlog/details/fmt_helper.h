@@ -3,6 +3,8 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <spdlog/common.h>
 #include <spdlog/fmt/fmt.h>
@@ -81,11 +83,56 @@ inline unsigned int count_digits(T n) {
 #endif
 }
 
+// Fixed width kernels used for the time and elapsed fields.
+// Digits are written in pairs from a lookup table, and 8 digits at once using SWAR
+// (SIMD within a register) where the byte order allows.
+
+// "00" "01" .. "99"
+inline const char *digit_pairs() {
+    static const char pairs[] =
+        "0001020304050607080910111213141516171819"
+        "2021222324252627282930313233343536373839"
+        "4041424344454647484950515253545556575859"
+        "6061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    return pairs;
+}
+
+// write the 2 digits of n (0-99)
+inline void write2(unsigned int n, char *out) {
+    const char *pair = digit_pairs() + n * 2;
+    out[0] = pair[0];
+    out[1] = pair[1];
+}
+
+#if (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) || defined(_WIN32)
+// write the 8 digits of n (0-99999999) with a few multiplications on a 64 bit word.
+// each step splits the numbers in all the lanes at once: 4 digits -> 2 x 2 digits -> 2 x 1 digit.
+inline void write8(uint32_t n, char *out) {
+    uint64_t v = n / 10000;                     // first 4 digits in the low lane
+    v |= static_cast<uint64_t>(n % 10000) << 32;  // last 4 digits in the high lane
+    uint64_t q = ((v * 10486) >> 20) & 0x0000007F0000007Full;  // lane / 100
+    v = q | ((v - q * 100) << 16);
+    q = ((v * 103) >> 10) & 0x000F000F000F000Full;  // lane / 10
+    v = q | ((v - q * 10) << 8);
+    v |= 0x3030303030303030ull;  // to ascii
+    std::memcpy(out, &v, 8);
+}
+#else
+inline void write8(uint32_t n, char *out) {
+    write2(n / 1000000, out);
+    write2(n / 10000 % 100, out + 2);
+    write2(n / 100 % 100, out + 4);
+    write2(n % 100, out + 6);
+}
+#endif
+
 inline void pad2(int n, memory_buf_t &dest) {
     if (n >= 0 && n < 100)  // 0-99
     {
-        dest.push_back(static_cast<char>('0' + n / 10));
-        dest.push_back(static_cast<char>('0' + n % 10));
+        char buf[2];
+        write2(static_cast<unsigned int>(n), buf);
+        dest.append(buf, buf + 2);
     } else  // unlikely, but just in case, let fmt deal with it
     {
         fmt_lib::format_to(std::back_inserter(dest), SPDLOG_FMT_STRING("{:02}"), n);
@@ -105,10 +152,10 @@ template <typename T>
 inline void pad3(T n, memory_buf_t &dest) {
     static_assert(std::is_unsigned<T>::value, "pad3 must get unsigned T");
     if (n < 1000) {
-        dest.push_back(static_cast<char>(n / 100 + '0'));
-        n = n % 100;
-        dest.push_back(static_cast<char>((n / 10) + '0'));
-        dest.push_back(static_cast<char>((n % 10) + '0'));
+        char buf[3];
+        buf[0] = static_cast<char>(n / 100 + '0');
+        write2(static_cast<unsigned int>(n % 100), buf + 1);
+        dest.append(buf, buf + 3);
     } else {
         append_int(n, dest);
     }
@@ -116,12 +163,31 @@ inline void pad3(T n, memory_buf_t &dest) {
 
 template <typename T>
 inline void pad6(T n, memory_buf_t &dest) {
-    pad_uint(n, 6, dest);
+    static_assert(std::is_unsigned<T>::value, "pad6 must get unsigned T");
+    if (n < 1000000) {
+        auto v = static_cast<unsigned int>(n);
+        char buf[6];
+        write2(v / 10000, buf);
+        write2(v / 100 % 100, buf + 2);
+        write2(v % 100, buf + 4);
+        dest.append(buf, buf + 6);
+    } else {
+        append_int(n, dest);
+    }
 }
 
 template <typename T>
 inline void pad9(T n, memory_buf_t &dest) {
-    pad_uint(n, 9, dest);
+    static_assert(std::is_unsigned<T>::value, "pad9 must get unsigned T");
+    if (n < 1000000000) {
+        auto v = static_cast<uint32_t>(n);
+        char buf[9];
+        buf[0] = static_cast<char>(v / 100000000 + '0');
+        write8(v % 100000000, buf + 1);
+        dest.append(buf, buf + 9);
+    } else {
+        append_int(n, dest);
+    }
 }
 
 // return fraction of a second of the given time_point.
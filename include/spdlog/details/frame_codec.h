@@ -0,0 +1,378 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Length framed, optionally compressed batches of log records (used by tcp_sink's framed modes).
+//
+// A stream is a sequence of frames, each one a 20 byte header followed by the frame payload:
+//     offset  size
+//     0       4     magic "SPLF"
+//     4       1     version (1)
+//     5       1     codec (frame_codec: 0 stored, 1 zstd, 2 lz4)
+//     6       2     reserved (0)
+//     8       4     payload length (little endian)
+//     12      4     decoded length (little endian)
+//     16      4     number of records in the frame (little endian)
+//
+// The frames of a stream (e.g. of one tcp connection) are compressed as a single stream, so
+// each frame benefits from the history of the previous ones:
+//  - zstd: one zstd frame, flushed (ZSTD_e_flush) at the end of each of our frames.
+//  - lz4: each frame is an lz4 block compressed with the preceding (up to 64KB of) decoded data
+//    as dictionary.
+// So a stream must be decoded from its first frame on, in order, by one frame_decoder.
+//
+// zstd requires SPDLOG_ZSTD and lz4 requires SPDLOG_LZ4 (and linking with the library).
+
+#include <spdlog/common.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef SPDLOG_ZSTD
+    #include <zstd.h>
+#endif
+#ifdef SPDLOG_LZ4
+    #include <lz4.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+enum class frame_codec : uint8_t { stored = 0, zstd = 1, lz4 = 2 };
+
+struct frame_header {
+    static constexpr size_t size = 20;
+    static constexpr uint8_t version = 1;
+
+    frame_codec codec = frame_codec::stored;
+    uint32_t payload_length = 0;
+    uint32_t decoded_length = 0;
+    uint32_t records = 0;
+
+    void write(char *dest) const {
+        std::memcpy(dest, "SPLF", 4);
+        dest[4] = static_cast<char>(version);
+        dest[5] = static_cast<char>(codec);
+        dest[6] = dest[7] = 0;
+        write_u32_(dest + 8, payload_length);
+        write_u32_(dest + 12, decoded_length);
+        write_u32_(dest + 16, records);
+    }
+
+    // throws spdlog_ex if src is not a valid header
+    static frame_header read(const char *src) {
+        if (std::memcmp(src, "SPLF", 4) != 0) {
+            throw_spdlog_ex("frame_decoder: bad magic");
+        }
+        if (static_cast<uint8_t>(src[4]) != version) {
+            throw_spdlog_ex("frame_decoder: unsupported version " +
+                            std::to_string(static_cast<uint8_t>(src[4])));
+        }
+        frame_header h;
+        h.codec = static_cast<frame_codec>(src[5]);
+        h.payload_length = read_u32_(src + 8);
+        h.decoded_length = read_u32_(src + 12);
+        h.records = read_u32_(src + 16);
+        return h;
+    }
+
+private:
+    static void write_u32_(char *dest, uint32_t v) {
+        for (int i = 0; i < 4; i++) {
+            dest[i] = static_cast<char>((v >> (8 * i)) & 0xff);
+        }
+    }
+
+    static uint32_t read_u32_(const char *src) {
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) {
+            v |= static_cast<uint32_t>(static_cast<unsigned char>(src[i])) << (8 * i);
+        }
+        return v;
+    }
+};
+
+// true if the codec was compiled in
+inline bool frame_codec_available(frame_codec codec) {
+    switch (codec) {
+        case frame_codec::stored:
+            return true;
+        case frame_codec::zstd:
+#ifdef SPDLOG_ZSTD
+            return true;
+#else
+            return false;
+#endif
+        case frame_codec::lz4:
+#ifdef SPDLOG_LZ4
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+// Encodes batches into the frames of one stream.
+// The compression context is created once and reused by all the frames (and streams).
+class frame_encoder {
+public:
+    // level: codec compression level (zstd level / lz4 acceleration), 0 for the codec's default.
+    // throws spdlog_ex if the codec was not compiled in.
+    explicit frame_encoder(frame_codec codec, int level = 0)
+        : codec_(codec),
+          level_(level) {
+        if (!frame_codec_available(codec)) {
+            throw_spdlog_ex("frame_encoder: codec not available (see SPDLOG_ZSTD / SPDLOG_LZ4)");
+        }
+#ifdef SPDLOG_ZSTD
+        if (codec_ == frame_codec::zstd) {
+            zstd_ctx_.reset(ZSTD_createCCtx());
+            if (level_ != 0) {
+                ZSTD_CCtx_setParameter(zstd_ctx_.get(), ZSTD_c_compressionLevel, level_);
+            }
+        }
+#endif
+#ifdef SPDLOG_LZ4
+        if (codec_ == frame_codec::lz4) {
+            lz4_stream_.reset(LZ4_createStream());
+            lz4_dict_.reset(new char[lz4_window]);
+        }
+#endif
+    }
+
+    frame_encoder(const frame_encoder &) = delete;
+    frame_encoder &operator=(const frame_encoder &) = delete;
+
+    frame_codec codec() const { return codec_; }
+
+    // start a new stream (e.g. after reconnecting)
+    void reset() {
+#ifdef SPDLOG_ZSTD
+        if (zstd_ctx_) {
+            ZSTD_CCtx_reset(zstd_ctx_.get(), ZSTD_reset_session_only);
+        }
+#endif
+#ifdef SPDLOG_LZ4
+        if (lz4_stream_) {
+            LZ4_resetStream_fast(lz4_stream_.get());
+        }
+#endif
+    }
+
+    // append the frame of the given data (holding the given number of records) to dest
+    void encode(string_view_t data, uint32_t records, memory_buf_t &dest) {
+        const size_t header_pos = dest.size();
+        dest.resize(header_pos + frame_header::size);
+        frame_header h;
+        h.codec = codec_;
+        h.decoded_length = static_cast<uint32_t>(data.size());
+        h.records = records;
+        switch (codec_) {
+            case frame_codec::stored:
+                dest.append(data.data(), data.data() + data.size());
+                break;
+            case frame_codec::zstd:
+                encode_zstd_(data, dest);
+                break;
+            case frame_codec::lz4:
+                encode_lz4_(data, dest);
+                break;
+        }
+        h.payload_length = static_cast<uint32_t>(dest.size() - header_pos - frame_header::size);
+        h.write(dest.data() + header_pos);
+    }
+
+private:
+    static constexpr int lz4_window = 64 * 1024;
+
+    frame_codec codec_;
+    int level_;
+
+#ifdef SPDLOG_ZSTD
+    struct zstd_cctx_deleter {
+        void operator()(ZSTD_CCtx *ctx) const { ZSTD_freeCCtx(ctx); }
+    };
+    std::unique_ptr<ZSTD_CCtx, zstd_cctx_deleter> zstd_ctx_;
+#endif
+#ifdef SPDLOG_LZ4
+    struct lz4_stream_deleter {
+        void operator()(LZ4_stream_t *stream) const { LZ4_freeStream(stream); }
+    };
+    std::unique_ptr<LZ4_stream_t, lz4_stream_deleter> lz4_stream_;
+    std::unique_ptr<char[]> lz4_dict_;  // the stream history, since the input isn't kept
+#endif
+
+    void encode_zstd_(string_view_t data, memory_buf_t &dest) {
+#ifdef SPDLOG_ZSTD
+        const size_t start = dest.size();
+        size_t capacity = ZSTD_compressBound(data.size()) + 64;
+        dest.resize(start + capacity);
+        ZSTD_inBuffer in{data.data(), data.size(), 0};
+        ZSTD_outBuffer out{dest.data() + start, capacity, 0};
+        for (;;) {
+            size_t remaining = ZSTD_compressStream2(zstd_ctx_.get(), &out, &in, ZSTD_e_flush);
+            if (ZSTD_isError(remaining)) {
+                dest.resize(start);
+                throw_spdlog_ex(std::string("frame_encoder: zstd: ") +
+                                ZSTD_getErrorName(remaining));
+            }
+            if (remaining == 0) {
+                break;
+            }
+            // grow the output and continue flushing
+            capacity += remaining + 64;
+            dest.resize(start + capacity);
+            out.dst = dest.data() + start;
+            out.size = capacity;
+        }
+        dest.resize(start + out.pos);
+#else
+        (void)data;
+        (void)dest;
+#endif
+    }
+
+    void encode_lz4_(string_view_t data, memory_buf_t &dest) {
+#ifdef SPDLOG_LZ4
+        const size_t start = dest.size();
+        const int src_size = static_cast<int>(data.size());
+        const int capacity = LZ4_compressBound(src_size);
+        dest.resize(start + static_cast<size_t>(capacity));
+        int n = LZ4_compress_fast_continue(lz4_stream_.get(), data.data(), dest.data() + start,
+                                           src_size, capacity, level_ > 0 ? level_ : 1);
+        if (n <= 0 && src_size > 0) {
+            dest.resize(start);
+            throw_spdlog_ex("frame_encoder: lz4 compression failed");
+        }
+        dest.resize(start + static_cast<size_t>(n));
+        LZ4_saveDict(lz4_stream_.get(), lz4_dict_.get(), lz4_window);
+#else
+        (void)data;
+        (void)dest;
+#endif
+    }
+};
+
+// Reference decoder for the collector side: decodes the frames of one stream.
+class frame_decoder {
+public:
+    static constexpr size_t default_max_frame_size = 64 * 1024 * 1024;
+
+    // max_frame_size: the largest payload or decoded length accepted from a frame header, so a
+    // corrupt or hostile stream can't make the decoder allocate without bound.
+    explicit frame_decoder(size_t max_frame_size = default_max_frame_size)
+        : max_frame_size_(max_frame_size) {}
+    frame_decoder(const frame_decoder &) = delete;
+    frame_decoder &operator=(const frame_decoder &) = delete;
+
+    // feed bytes of the stream (in any chunks). on_frame(string_view_t data, uint32_t records) is
+    // called with the decoded data of each complete frame.
+    // throws spdlog_ex on malformed input, on a frame larger than max_frame_size or if the frame's
+    // codec was not compiled in.
+    template <typename OnFrame>
+    void feed(const char *data, size_t size, OnFrame &&on_frame) {
+        pending_.append(data, size);
+        size_t pos = 0;
+        while (pending_.size() - pos >= frame_header::size) {
+            auto h = frame_header::read(pending_.data() + pos);
+            if (h.payload_length > max_frame_size_ || h.decoded_length > max_frame_size_) {
+                throw_spdlog_ex("frame_decoder: frame too large");
+            }
+            if (pending_.size() - pos - frame_header::size < h.payload_length) {
+                break;
+            }
+            string_view_t payload(pending_.data() + pos + frame_header::size, h.payload_length);
+            decode_(h, payload);
+            on_frame(string_view_t(decoded_.data(), decoded_.size()), h.records);
+            pos += frame_header::size + h.payload_length;
+        }
+        pending_.erase(0, pos);
+    }
+
+    // bytes received that are not a complete frame yet
+    size_t pending() const { return pending_.size(); }
+
+private:
+    static constexpr size_t lz4_window = 64 * 1024;
+
+    size_t max_frame_size_;
+    std::string pending_;
+    std::vector<char> decoded_;
+
+#ifdef SPDLOG_ZSTD
+    struct zstd_dctx_deleter {
+        void operator()(ZSTD_DCtx *ctx) const { ZSTD_freeDCtx(ctx); }
+    };
+    std::unique_ptr<ZSTD_DCtx, zstd_dctx_deleter> zstd_ctx_;
+#endif
+#ifdef SPDLOG_LZ4
+    std::vector<char> lz4_window_;  // last (up to) 64KB of decoded data
+#endif
+
+    void decode_(const frame_header &h, string_view_t payload) {
+        decoded_.resize(h.decoded_length);
+        switch (h.codec) {
+            case frame_codec::stored:
+                if (payload.size() != h.decoded_length) {
+                    throw_spdlog_ex("frame_decoder: bad stored frame length");
+                }
+                if (payload.size() != 0) {
+                    std::memcpy(decoded_.data(), payload.data(), payload.size());
+                }
+                return;
+#ifdef SPDLOG_ZSTD
+            case frame_codec::zstd: {
+                if (!zstd_ctx_) {
+                    zstd_ctx_.reset(ZSTD_createDCtx());
+                }
+                ZSTD_inBuffer in{payload.data(), payload.size(), 0};
+                ZSTD_outBuffer out{decoded_.data(), decoded_.size(), 0};
+                while (in.pos < in.size || out.pos < out.size) {
+                    const size_t in_before = in.pos, out_before = out.pos;
+                    size_t rv = ZSTD_decompressStream(zstd_ctx_.get(), &out, &in);
+                    if (ZSTD_isError(rv)) {
+                        throw_spdlog_ex(std::string("frame_decoder: zstd: ") +
+                                        ZSTD_getErrorName(rv));
+                    }
+                    if (in.pos == in_before && out.pos == out_before) {
+                        break;  // no progress: the length check below fails
+                    }
+                }
+                if (out.pos != out.size) {
+                    throw_spdlog_ex("frame_decoder: bad zstd frame length");
+                }
+                return;
+            }
+#endif
+#ifdef SPDLOG_LZ4
+            case frame_codec::lz4: {
+                int n = LZ4_decompress_safe_usingDict(
+                    payload.data(), decoded_.data(), static_cast<int>(payload.size()),
+                    static_cast<int>(decoded_.size()), lz4_window_.data(),
+                    static_cast<int>(lz4_window_.size()));
+                if (n < 0 || static_cast<size_t>(n) != decoded_.size()) {
+                    throw_spdlog_ex("frame_decoder: bad lz4 frame");
+                }
+                // the encoder's dictionary is the tail of this
+                lz4_window_.insert(lz4_window_.end(), decoded_.begin(), decoded_.end());
+                if (lz4_window_.size() > lz4_window) {
+                    lz4_window_.erase(lz4_window_.begin(),
+                                      lz4_window_.end() - static_cast<std::ptrdiff_t>(lz4_window));
+                }
+                return;
+            }
+#endif
+            default:
+                throw_spdlog_ex("frame_decoder: unsupported codec " +
+                                std::to_string(static_cast<int>(h.codec)));
+        }
+    }
+};
+
+}  // namespace details
+}  // namespace spdlog
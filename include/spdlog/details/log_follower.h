@@ -0,0 +1,357 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Follow the files written by rotating_file_sink or daily_file_sink, across rotations, and read
+// the records (lines) appended to them. Used by the spdlog_ship tool.
+//
+// The followed file is tracked by inode, so a rotation never makes it lose records: when the
+// writer moves on to a new file (rotating: the file was renamed to <base>.1.<ext>, daily: a file
+// for a later day exists), the current file is read to its end before opening the next one,
+// which is found with the sinks' own file name calculators.
+// The position (file inode and offset of the next record) can be saved and given back to resume
+// after a restart, including from a file that was rotated meanwhile (as long as it still exists).
+//
+// POSIX only. Changes are waited for with inotify on linux, by polling elsewhere.
+
+#include <spdlog/common.h>
+#include <spdlog/details/os.h>
+#include <spdlog/sinks/daily_file_sink.h>
+#include <spdlog/sinks/rotating_file_sink.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+    #include <sys/inotify.h>
+#endif
+
+namespace spdlog {
+namespace details {
+
+enum class follow_scheme {
+    rotating,  // rotating_file_sink: <base>, <base>.1.<ext> .. <base>.<max_files>.<ext>
+    daily      // daily_file_sink: <base>_YYYY-MM-DD.<ext>
+};
+
+// position in the followed files
+struct follow_position {
+    uint64_t inode = 0;  // 0 - none: start with the oldest rotated file (daily: today's file)
+    uint64_t offset = 0;  // of the next record
+    std::time_t file_time = 0;  // daily: a time in the file's day
+    filename_t filename;  // name of the file when it was opened (informational for rotating)
+};
+
+class log_follower {
+public:
+    // max_files: rotating_file_sink's max_files (how many rotated files to look at)
+    log_follower(filename_t base_filename,
+                 follow_scheme scheme,
+                 size_t max_files = 0,
+                 follow_position from = follow_position{})
+        : base_filename_(std::move(base_filename)),
+          scheme_(scheme),
+          max_files_(max_files) {
+#ifdef __linux__
+        inotify_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd_ >= 0) {
+            auto dir = os::dir_name(base_filename_);
+            ::inotify_add_watch(inotify_fd_, dir.empty() ? "." : dir.c_str(),
+                                IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM |
+                                    IN_CLOSE_WRITE);
+        }
+#endif
+        if (from.inode != 0) {
+            resume_(from);
+        }
+    }
+
+    ~log_follower() {
+        close_();
+        if (inotify_fd_ >= 0) {
+            ::close(inotify_fd_);
+        }
+    }
+
+    log_follower(const log_follower &) = delete;
+    log_follower &operator=(const log_follower &) = delete;
+
+    // append the complete records (without their eol) available now to records, stopping after
+    // about max_bytes. return the number of records appended.
+    size_t read(std::vector<std::string> &records, size_t max_bytes) {
+        size_t count = 0;
+        size_t bytes = 0;
+        bool rotated = false;
+        while (bytes < max_bytes) {
+            if (fd_ < 0 && !open_next_()) {
+                break;
+            }
+            char buf[16 * 1024];
+            auto n = ::pread(fd_, buf, sizeof(buf), static_cast<off_t>(read_offset_));
+            if (n < 0) {
+                throw_spdlog_ex(
+                    "log_follower: failed reading " + os::filename_to_str(pos_.filename), errno);
+            }
+            if (n > 0) {
+                read_offset_ += static_cast<uint64_t>(n);
+                partial_.append(buf, static_cast<size_t>(n));
+                count += split_records_(records, bytes);
+                continue;
+            }
+            // at the end of the file. if the writer moved on to the next file, read again to get
+            // what it wrote before that, and only then go to the next file.
+            if (!rotated) {
+                rotated = rotated_();
+                if (rotated) {
+                    continue;
+                }
+                break;
+            }
+            if (!partial_.empty()) {
+                records.push_back(partial_);
+                bytes += partial_.size();
+                count++;
+                partial_.clear();
+            }
+            pos_.offset = read_offset_;
+            close_();
+            rotated = false;
+            if (!open_next_()) {
+                break;
+            }
+        }
+        return count;
+    }
+
+    // position after the last record returned by read()
+    const follow_position &position() const { return pos_; }
+
+    // wait until the followed files might have changed, or for the timeout
+    void wait(std::chrono::milliseconds timeout) {
+        if (inotify_fd_ < 0) {
+            std::this_thread::sleep_for(timeout);
+            return;
+        }
+        pollfd pfd{inotify_fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, static_cast<int>(timeout.count())) > 0) {
+            char buf[4096];
+            while (::read(inotify_fd_, buf, sizeof(buf)) > 0) {
+            }
+        }
+    }
+
+    // save the position to a file, atomically (write to a temporary file, fsync and rename)
+    static void save_position(const filename_t &path, const follow_position &pos) {
+        filename_t tmp = path + SPDLOG_FILENAME_T(".tmp");
+        std::FILE *fp = std::fopen(tmp.c_str(), "wb");
+        if (fp == nullptr) {
+            throw_spdlog_ex("log_follower: failed opening " + os::filename_to_str(tmp), errno);
+        }
+        std::fprintf(fp, "spdlog-follow 1\n%llu %llu %lld\n%s\n",
+                     static_cast<unsigned long long>(pos.inode),
+                     static_cast<unsigned long long>(pos.offset),
+                     static_cast<long long>(pos.file_time), pos.filename.c_str());
+        bool ok = std::fflush(fp) == 0 && os::fsync(fp);
+        ok = std::fclose(fp) == 0 && ok;
+        if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            throw_spdlog_ex("log_follower: failed saving position to " + os::filename_to_str(path),
+                            errno);
+        }
+    }
+
+    // load a position saved by save_position(). return false if there is none (or it's invalid).
+    static bool load_position(const filename_t &path, follow_position &pos) {
+        std::FILE *fp = std::fopen(path.c_str(), "rb");
+        if (fp == nullptr) {
+            return false;
+        }
+        unsigned long long inode = 0, offset = 0;
+        long long file_time = 0;
+        char name[4096];
+        bool ok = std::fscanf(fp, "spdlog-follow 1\n%llu %llu %lld\n", &inode, &offset,
+                              &file_time) == 3 &&
+                  std::fgets(name, sizeof(name), fp) != nullptr;
+        std::fclose(fp);
+        if (!ok) {
+            return false;
+        }
+        std::string filename(name);
+        if (!filename.empty() && filename.back() == '\n') {
+            filename.pop_back();
+        }
+        pos.inode = inode;
+        pos.offset = offset;
+        pos.file_time = static_cast<std::time_t>(file_time);
+        pos.filename = filename;
+        return true;
+    }
+
+private:
+    filename_t base_filename_;
+    follow_scheme scheme_;
+    size_t max_files_;
+    int inotify_fd_ = -1;
+    int fd_ = -1;
+    follow_position pos_;
+    uint64_t read_offset_ = 0;  // >= pos_.offset, the bytes in between are in partial_
+    std::string partial_;
+
+    void close_() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    // move the complete lines of partial_ to records
+    size_t split_records_(std::vector<std::string> &records, size_t &bytes) {
+        size_t count = 0;
+        size_t start = 0;
+        size_t eol;
+        while ((eol = partial_.find('\n', start)) != std::string::npos) {
+            size_t end = eol > start && partial_[eol - 1] == '\r' ? eol - 1 : eol;
+            records.emplace_back(partial_, start, end - start);
+            bytes += eol + 1 - start;
+            count++;
+            start = eol + 1;
+        }
+        partial_.erase(0, start);
+        pos_.offset = read_offset_ - partial_.size();
+        return count;
+    }
+
+    static uint64_t inode_of_(const filename_t &filename) {
+        struct stat st;
+        return ::stat(filename.c_str(), &st) == 0 ? static_cast<uint64_t>(st.st_ino) : 0;
+    }
+
+    static std::time_t next_day_(std::time_t t) {
+        std::tm tm_time = os::localtime(t);
+        tm_time.tm_mday++;
+        tm_time.tm_hour = 12;  // clear of dst changes
+        tm_time.tm_min = tm_time.tm_sec = 0;
+        tm_time.tm_isdst = -1;
+        return std::mktime(&tm_time);
+    }
+
+    static bool same_day_(std::time_t a, std::time_t b) {
+        std::tm ta = os::localtime(a), tb = os::localtime(b);
+        return ta.tm_year == tb.tm_year && ta.tm_yday == tb.tm_yday;
+    }
+
+    filename_t daily_filename_(std::time_t t) const {
+        return sinks::daily_filename_calculator::calc_filename(base_filename_, os::localtime(t));
+    }
+
+    // daily: the first existing file of the days after the current one (up to today).
+    // none if the current file is of a later day (the clock was set back).
+    bool next_daily_(filename_t &filename, std::time_t &file_time) const {
+        auto now = std::time(nullptr);
+        for (auto t = pos_.file_time; t < now && !same_day_(t, now);) {
+            t = next_day_(t);
+            auto name = daily_filename_(t);
+            if (os::path_exists(name)) {
+                filename = std::move(name);
+                file_time = t;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // true if the writer moved on from the current file to a newer one
+    bool rotated_() const {
+        if (scheme_ == follow_scheme::rotating) {
+            return inode_of_(base_filename_) != pos_.inode;
+        }
+        filename_t filename;
+        std::time_t file_time;
+        return next_daily_(filename, file_time);
+    }
+
+    bool open_(const filename_t &filename, std::time_t file_time, uint64_t offset) {
+        int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        ::fstat(fd, &st);
+        fd_ = fd;
+        pos_.inode = static_cast<uint64_t>(st.st_ino);
+        pos_.offset = offset;
+        pos_.file_time = file_time;
+        pos_.filename = filename;
+        read_offset_ = offset;
+        partial_.clear();
+        return true;
+    }
+
+    // open the file after the current one, or the current file if there is none yet
+    bool open_next_() {
+        auto now = std::time(nullptr);
+        if (scheme_ == follow_scheme::daily) {
+            filename_t filename;
+            std::time_t file_time;
+            if (pos_.inode != 0 && next_daily_(filename, file_time)) {
+                return open_(filename, file_time, 0);
+            }
+            return open_(daily_filename_(now), now, 0);
+        }
+        // the current file is now <base>.i, the next one is <base>.(i-1) (or <base>).
+        // if it is gone already (rotated beyond max_files), or there is no current file yet, all
+        // the existing files are newer, so start with the oldest of them.
+        size_t oldest = 0;
+        for (size_t i = 1; i <= max_files_; i++) {
+            auto name = sinks::rotating_file_sink_st::calc_filename(base_filename_, i);
+            auto inode = inode_of_(name);
+            if (inode != 0 && inode == pos_.inode) {
+                oldest = i;
+                break;
+            }
+            if (inode != 0) {
+                oldest = i + 1;
+            }
+        }
+        for (size_t i = oldest; i > 1; i--) {
+            if (open_(sinks::rotating_file_sink_st::calc_filename(base_filename_, i - 1), now, 0)) {
+                return true;
+            }
+        }
+        return open_(base_filename_, now, 0);
+    }
+
+    // reopen the file at the given position
+    void resume_(const follow_position &from) {
+        std::vector<filename_t> candidates;
+        if (scheme_ == follow_scheme::daily) {
+            candidates.push_back(from.filename);
+        } else {
+            candidates.push_back(base_filename_);
+            for (size_t i = 1; i <= max_files_; i++) {
+                candidates.push_back(
+                    sinks::rotating_file_sink_st::calc_filename(base_filename_, i));
+            }
+        }
+        for (auto &name : candidates) {
+            if (inode_of_(name) == from.inode && open_(name, from.file_time, from.offset)) {
+                return;
+            }
+        }
+        // the file is gone, continue with the one after it
+        pos_ = from;
+    }
+};
+
+}  // namespace details
+}  // namespace spdlog
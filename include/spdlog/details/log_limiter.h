@@ -0,0 +1,122 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Per call site state of the rate controlled logging macros (SPDLOG_LOGGER_INFO_EVERY_N,
+// SPDLOG_LOGGER_INFO_FIRST_N, SPDLOG_LOGGER_INFO_ONCE, SPDLOG_LOGGER_INFO_EVERY_MS.. in spdlog.h).
+// Each macro expansion holds a static limiter, checked before the log arguments are evaluated.
+// A suppressed call costs one relaxed atomic operation (every_ms: a clock read, a load and an
+// increment).
+
+#include <spdlog/common.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+namespace spdlog {
+namespace details {
+
+// allow the 1st, n+1th, 2n+1th.. calls
+class every_n_limiter {
+public:
+    constexpr every_n_limiter() = default;
+
+    bool allow(size_t n, size_t &skipped) {
+        auto count = count_.fetch_add(1, std::memory_order_relaxed);
+        if (n <= 1) {
+            return true;
+        }
+        if (count % n != 0) {
+            return false;
+        }
+        skipped = count == 0 ? 0 : n - 1;
+        return true;
+    }
+
+private:
+    std::atomic<size_t> count_{0};
+};
+
+// allow the first n calls
+class first_n_limiter {
+public:
+    constexpr first_n_limiter() = default;
+
+    bool allow(size_t n, size_t &) {
+        if (count_.load(std::memory_order_relaxed) >= n) {
+            return false;
+        }
+        return count_.fetch_add(1, std::memory_order_relaxed) < n;
+    }
+
+private:
+    std::atomic<size_t> count_{0};
+};
+
+// allow a call every ms milliseconds at most
+class every_ms_limiter {
+public:
+    constexpr every_ms_limiter() = default;
+
+    bool allow(int64_t ms, size_t &skipped) {
+        auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                       .count();
+        auto next = next_.load(std::memory_order_relaxed);
+        if (now < next || !next_.compare_exchange_strong(next, now + ms * 1000000,
+                                                         std::memory_order_relaxed)) {
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        skipped = skipped_.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    std::atomic<int64_t> next_{0};  // steady clock nanos
+    std::atomic<size_t> skipped_{0};
+};
+
+// log the message, followed by " (N skipped)" if calls were skipped before it
+template <typename Logger, typename... Args>
+void log_limited(const Logger &logger,
+                 source_loc loc,
+                 level::level_enum lvl,
+                 size_t skipped,
+                 format_string_t<Args...> fmt,
+                 Args &&...args) {
+    if (skipped == 0) {
+        logger->log(loc, lvl, fmt, std::forward<Args>(args)...);
+        return;
+    }
+    if (!logger->should_log(lvl) && !logger->should_backtrace()) {
+        return;
+    }
+    memory_buf_t buf;
+#ifdef SPDLOG_USE_STD_FORMAT
+    fmt_lib::vformat_to(std::back_inserter(buf), to_string_view(fmt),
+                        fmt_lib::make_format_args(args...));
+    fmt_lib::format_to(std::back_inserter(buf), " ({} skipped)", skipped);
+#else
+    fmt::vformat_to(fmt::appender(buf), to_string_view(fmt), fmt::make_format_args(args...));
+    fmt::format_to(fmt::appender(buf), " ({} skipped)", skipped);
+#endif
+    logger->log(loc, lvl, string_view_t(buf.data(), buf.size()));
+}
+
+// T cannot be statically converted to format string (including string_view)
+template <typename Logger,
+          class T,
+          typename std::enable_if<!is_convertible_to_any_format_string<const T &>::value,
+                                  int>::type = 0>
+void log_limited(
+    const Logger &logger, source_loc loc, level::level_enum lvl, size_t skipped, const T &msg) {
+    log_limited(logger, loc, lvl, skipped, "{}", msg);
+}
+
+}  // namespace details
+}  // namespace spdlog
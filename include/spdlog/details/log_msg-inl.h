@@ -13,13 +13,15 @@ namespace spdlog {
 namespace details {
 
 SPDLOG_INLINE log_msg::log_msg(spdlog::log_clock::time_point log_time,
+                               spdlog::mono_clock::time_point mono_tp,
                                spdlog::source_loc loc,
                                string_view_t a_logger_name,
                                spdlog::level::level_enum lvl,
                                spdlog::string_view_t msg)
     : logger_name(a_logger_name),
       level(lvl),
-      time(log_time)
+      time(log_time),
+      mono_time(mono_tp)
 #ifndef SPDLOG_NO_THREAD_ID
       ,
       thread_id(os::thread_id())
@@ -29,16 +31,41 @@ SPDLOG_INLINE log_msg::log_msg(spdlog::log_clock::time_point log_time,
       payload(msg) {
 }
 
+SPDLOG_INLINE log_msg::log_msg(spdlog::log_clock::time_point log_time,
+                               spdlog::source_loc loc,
+                               string_view_t a_logger_name,
+                               spdlog::level::level_enum lvl,
+                               spdlog::string_view_t msg)
+    : log_msg(log_time, os::wall_to_mono(log_time), loc, a_logger_name, lvl, msg) {}
+
+SPDLOG_INLINE log_msg::log_msg(spdlog::mono_clock::time_point mono_tp,
+                               spdlog::source_loc loc,
+                               string_view_t a_logger_name,
+                               spdlog::level::level_enum lvl,
+                               spdlog::string_view_t msg)
+    : log_msg(os::mono_to_wall(mono_tp), mono_tp, loc, a_logger_name, lvl, msg) {}
+
+// capture the time with a single clock read, unless both clocks are wanted
+#if defined(SPDLOG_MONOTONIC_CLOCK_ONLY)
+    #define SPDLOG_LOG_MSG_NOW_ os::mono_now()
+#elif defined(SPDLOG_MONOTONIC_TIMESTAMPS)
+    #define SPDLOG_LOG_MSG_NOW_ os::now(), os::mono_now()
+#else
+    #define SPDLOG_LOG_MSG_NOW_ os::now()
+#endif
+
 SPDLOG_INLINE log_msg::log_msg(spdlog::source_loc loc,
                                string_view_t a_logger_name,
                                spdlog::level::level_enum lvl,
                                spdlog::string_view_t msg)
-    : log_msg(os::now(), loc, a_logger_name, lvl, msg) {}
+    : log_msg(SPDLOG_LOG_MSG_NOW_, loc, a_logger_name, lvl, msg) {}
 
 SPDLOG_INLINE log_msg::log_msg(string_view_t a_logger_name,
                                spdlog::level::level_enum lvl,
                                spdlog::string_view_t msg)
-    : log_msg(os::now(), source_loc{}, a_logger_name, lvl, msg) {}
+    : log_msg(SPDLOG_LOG_MSG_NOW_, source_loc{}, a_logger_name, lvl, msg) {}
+
+#undef SPDLOG_LOG_MSG_NOW_
 
 }  // namespace details
 }  // namespace spdlog
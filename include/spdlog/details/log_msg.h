@@ -11,6 +11,19 @@ namespace details {
 struct SPDLOG_API log_msg {
     log_msg() = default;
     log_msg(log_clock::time_point log_time,
+            mono_clock::time_point mono_time,
+            source_loc loc,
+            string_view_t logger_name,
+            level::level_enum lvl,
+            string_view_t msg);
+    // the monotonic time is derived from the given wall clock time
+    log_msg(log_clock::time_point log_time,
+            source_loc loc,
+            string_view_t logger_name,
+            level::level_enum lvl,
+            string_view_t msg);
+    // the wall clock time is derived from the given monotonic time
+    log_msg(mono_clock::time_point mono_time,
             source_loc loc,
             string_view_t logger_name,
             level::level_enum lvl,
@@ -23,7 +36,13 @@ struct SPDLOG_API log_msg {
     string_view_t logger_name;
     level::level_enum level{level::off};
     log_clock::time_point time;
+    // for elapsed times. captured with the message if SPDLOG_MONOTONIC_TIMESTAMPS or
+    // SPDLOG_MONOTONIC_CLOCK_ONLY is defined, derived from the wall clock time otherwise.
+    mono_clock::time_point mono_time;
     size_t thread_id{0};
+    // per logger sequence number, stamped by async loggers when the message enters the queue
+    // (0 - none). see async_logger.
+    uint64_t sequence{0};
 
     // wrapping the formatted text with color (updated by pattern_formatter).
     mutable size_t color_range_start{0};
@@ -17,6 +17,18 @@ SPDLOG_INLINE log_msg_buffer::log_msg_buffer(const log_msg &orig_msg)
     update_string_views();
 }
 
+SPDLOG_INLINE log_msg_buffer::log_msg_buffer(const log_msg &orig_msg,
+                                             const external_payload &payload)
+    : log_msg{orig_msg},
+      external_payload_{true},
+      release_{payload.release},
+      release_context_{payload.context} {
+    buffer.append(logger_name.begin(), logger_name.end());
+    update_string_views();
+}
+
+SPDLOG_INLINE log_msg_buffer::~log_msg_buffer() { release_payload_(); }
+
 SPDLOG_INLINE log_msg_buffer::log_msg_buffer(const log_msg_buffer &other)
     : log_msg{other} {
     buffer.append(logger_name.begin(), logger_name.end());
@@ -26,28 +38,50 @@ SPDLOG_INLINE log_msg_buffer::log_msg_buffer(const log_msg_buffer &other)
 
 SPDLOG_INLINE log_msg_buffer::log_msg_buffer(log_msg_buffer &&other) SPDLOG_NOEXCEPT
     : log_msg{other},
-      buffer{std::move(other.buffer)} {
+      buffer{std::move(other.buffer)},
+      external_payload_{other.external_payload_},
+      release_{other.release_},
+      release_context_{other.release_context_} {
+    other.release_ = nullptr;
     update_string_views();
 }
 
 SPDLOG_INLINE log_msg_buffer &log_msg_buffer::operator=(const log_msg_buffer &other) {
+    release_payload_();
     log_msg::operator=(other);
     buffer.clear();
-    buffer.append(other.buffer.data(), other.buffer.data() + other.buffer.size());
+    buffer.append(other.logger_name.begin(), other.logger_name.end());
+    buffer.append(other.payload.begin(), other.payload.end());
+    external_payload_ = false;
     update_string_views();
     return *this;
 }
 
 SPDLOG_INLINE log_msg_buffer &log_msg_buffer::operator=(log_msg_buffer &&other) SPDLOG_NOEXCEPT {
+    release_payload_();
     log_msg::operator=(other);
     buffer = std::move(other.buffer);
+    external_payload_ = other.external_payload_;
+    release_ = other.release_;
+    release_context_ = other.release_context_;
+    other.release_ = nullptr;
     update_string_views();
     return *this;
 }
 
 SPDLOG_INLINE void log_msg_buffer::update_string_views() {
     logger_name = string_view_t{buffer.data(), logger_name.size()};
-    payload = string_view_t{buffer.data() + logger_name.size(), payload.size()};
+    if (!external_payload_) {
+        payload = string_view_t{buffer.data() + logger_name.size(), payload.size()};
+    }
+}
+
+SPDLOG_INLINE void log_msg_buffer::release_payload_() {
+    if (release_ != nullptr) {
+        auto release = release_;
+        release_ = nullptr;
+        release(release_context_);
+    }
 }
 
 }  // namespace details
@@ -10,14 +10,22 @@ namespace details {
 
 // Extend log_msg with internal buffer to store its payload.
 // This is needed since log_msg holds string_views that points to stack data.
+// An external payload is not copied - the buffer holds only the logger name and releases the
+// payload when destroyed (copies of it do copy the payload).
 
 class SPDLOG_API log_msg_buffer : public log_msg {
     memory_buf_t buffer;
+    bool external_payload_ = false;
+    external_payload::release_fn release_ = nullptr;
+    void *release_context_ = nullptr;
     void update_string_views();
+    void release_payload_();
 
 public:
     log_msg_buffer() = default;
     explicit log_msg_buffer(const log_msg &orig_msg);
+    log_msg_buffer(const log_msg &orig_msg, const external_payload &payload);
+    ~log_msg_buffer();
     log_msg_buffer(const log_msg_buffer &other);
     log_msg_buffer(log_msg_buffer &&other) SPDLOG_NOEXCEPT;
     log_msg_buffer &operator=(const log_msg_buffer &other);
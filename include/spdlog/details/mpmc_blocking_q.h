@@ -7,31 +7,75 @@
 // enqueue(..) - will block until room found to put the new message.
 // enqueue_nowait(..) - will return immediately with false if no room left in
 // the queue.
+// enqueue_bulk*(..) - same as the above for a range of items, taking the lock once.
 // dequeue_for(..) - will block until the queue is not empty or timeout have
 // passed.
+// OnEnqueue(item) is called under the queue lock for each item about to be pushed, or discarded
+// for lack of room, in queue order.
+// Items overrun or discarded are destroyed by the enqueuing thread after it released the queue
+// lock, so their destructors may use the queue (an async_msg may release an external payload).
 
 #include <spdlog/details/circular_q.h>
+#include <spdlog/details/region_allocator.h>
 
 #include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
+#include <new>
+#include <vector>
 
 namespace spdlog {
 namespace details {
 
+// the default OnEnqueue, does nothing
+struct no_enqueue_hook {
+    template <typename T>
+    void operator()(T &) const {}
+};
+
+// room for an item that is constructed only if needed, and destroyed with the holder
 template <typename T>
+class lazy_item {
+public:
+    lazy_item() = default;
+    lazy_item(const lazy_item &) = delete;
+    lazy_item &operator=(const lazy_item &) = delete;
+    ~lazy_item() {
+        if (constructed_) {
+            reinterpret_cast<T *>(storage_)->~T();
+        }
+    }
+
+    // may be called once
+    void emplace(T &&item) {
+        new (storage_) T(std::move(item));
+        constructed_ = true;
+    }
+
+private:
+    alignas(T) unsigned char storage_[sizeof(T)];
+    bool constructed_ = false;
+};
+
+template <typename T, typename OnEnqueue = no_enqueue_hook>
 class mpmc_blocking_queue {
 public:
     using item_type = T;
     explicit mpmc_blocking_queue(size_t max_items)
         : q_(max_items) {}
 
+    // allocate the queue slots as specified by the memory options (see region_allocator.h)
+    mpmc_blocking_queue(size_t max_items, const queue_memory_options &mem_options)
+        : q_(max_items, region_allocator<T>(mem_options)) {}
+
 #ifndef __MINGW32__
     // try to enqueue and block if no room left
     void enqueue(T &&item) {
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
             pop_cv_.wait(lock, [this] { return !this->q_.full(); });
+            on_enqueue_(item);
             q_.push_back(std::move(item));
         }
         push_cv_.notify_one();
@@ -39,8 +83,13 @@ public:
 
     // enqueue immediately. overrun oldest message in the queue if no room left.
     void enqueue_nowait(T &&item) {
+        lazy_item<T> overrun;  // destroyed after the lock is released
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
+            on_enqueue_(item);
+            if (q_.full()) {
+                overrun.emplace(std::move(q_.front()));
+            }
             q_.push_back(std::move(item));
         }
         push_cv_.notify_one();
@@ -50,6 +99,7 @@ public:
         bool pushed = false;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
+            on_enqueue_(item);
             if (!q_.full()) {
                 q_.push_back(std::move(item));
                 pushed = true;
@@ -73,6 +123,7 @@ public:
             }
             popped_item = std::move(q_.front());
             q_.pop_front();
+            dequeued_++;
         }
         pop_cv_.notify_one();
         return true;
@@ -80,11 +131,19 @@ public:
 
     // blocking dequeue without a timeout.
     void dequeue(T &popped_item) {
+        uint64_t ticket;
+        dequeue(popped_item, ticket);
+    }
+
+    // blocking dequeue without a timeout, also giving the number of items dequeued before this
+    // one (the item's position in the dequeue order).
+    void dequeue(T &popped_item, uint64_t &ticket) {
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
             push_cv_.wait(lock, [this] { return !this->q_.empty(); });
             popped_item = std::move(q_.front());
             q_.pop_front();
+            ticket = dequeued_++;
         }
         pop_cv_.notify_one();
     }
@@ -97,13 +156,19 @@ public:
     void enqueue(T &&item) {
         std::unique_lock<std::mutex> lock(queue_mutex_);
         pop_cv_.wait(lock, [this] { return !this->q_.full(); });
+        on_enqueue_(item);
         q_.push_back(std::move(item));
         push_cv_.notify_one();
     }
 
     // enqueue immediately. overrun oldest message in the queue if no room left.
     void enqueue_nowait(T &&item) {
+        lazy_item<T> overrun;  // destroyed after the lock is released
         std::unique_lock<std::mutex> lock(queue_mutex_);
+        on_enqueue_(item);
+        if (q_.full()) {
+            overrun.emplace(std::move(q_.front()));
+        }
         q_.push_back(std::move(item));
         push_cv_.notify_one();
     }
@@ -111,6 +176,7 @@ public:
     void enqueue_if_have_room(T &&item) {
         bool pushed = false;
         std::unique_lock<std::mutex> lock(queue_mutex_);
+        on_enqueue_(item);
         if (!q_.full()) {
             q_.push_back(std::move(item));
             pushed = true;
@@ -132,21 +198,77 @@ public:
         }
         popped_item = std::move(q_.front());
         q_.pop_front();
+        dequeued_++;
         pop_cv_.notify_one();
         return true;
     }
 
     // blocking dequeue without a timeout.
     void dequeue(T &popped_item) {
+        uint64_t ticket;
+        dequeue(popped_item, ticket);
+    }
+
+    void dequeue(T &popped_item, uint64_t &ticket) {
         std::unique_lock<std::mutex> lock(queue_mutex_);
         push_cv_.wait(lock, [this] { return !this->q_.empty(); });
         popped_item = std::move(q_.front());
         q_.pop_front();
+        ticket = dequeued_++;
         pop_cv_.notify_one();
     }
 
 #endif
 
+    // enqueue a range of items under a single lock, moving them out of the range.
+    // the bulk variants notify while holding the lock, which is safe on all platforms.
+
+    // block whenever no room is left (see enqueue())
+    template <typename It>
+    void enqueue_bulk(It begin, It end) {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        for (; begin != end; ++begin) {
+            if (q_.full()) {
+                // let the consumers drain what was pushed so far
+                push_cv_.notify_all();
+                pop_cv_.wait(lock, [this] { return !this->q_.full(); });
+            }
+            on_enqueue_(*begin);
+            q_.push_back(std::move(*begin));
+        }
+        push_cv_.notify_all();
+    }
+
+    // overrun the oldest messages if no room left (see enqueue_nowait())
+    template <typename It>
+    void enqueue_bulk_nowait(It begin, It end) {
+        std::vector<T> overrun;  // destroyed after the lock is released
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        for (; begin != end; ++begin) {
+            on_enqueue_(*begin);
+            if (q_.full()) {
+                overrun.push_back(std::move(q_.front()));
+            }
+            q_.push_back(std::move(*begin));
+        }
+        push_cv_.notify_all();
+    }
+
+    // discard the items that don't fit (see enqueue_if_have_room())
+    template <typename It>
+    void enqueue_bulk_if_have_room(It begin, It end) {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        for (; begin != end && !q_.full(); ++begin) {
+            on_enqueue_(*begin);
+            q_.push_back(std::move(*begin));
+        }
+        for (; begin != end; ++begin) {
+            on_enqueue_(*begin);
+            ++discard_counter_;
+        }
+        push_cv_.notify_all();
+    }
+
     size_t overrun_counter() {
         std::lock_guard<std::mutex> lock(queue_mutex_);
         return q_.overrun_counter();
@@ -166,12 +288,22 @@ public:
 
     void reset_discard_counter() { discard_counter_.store(0, std::memory_order_relaxed); }
 
+    // call f(number of items dequeued so far) with the queue locked, so no item is dequeued
+    // meanwhile
+    template <typename F>
+    void with_dequeued_count(F &&f) {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        f(dequeued_);
+    }
+
 private:
     std::mutex queue_mutex_;
     std::condition_variable push_cv_;
     std::condition_variable pop_cv_;
-    spdlog::details::circular_q<T> q_;
+    spdlog::details::circular_q<T, region_allocator<T>> q_;
     std::atomic<size_t> discard_counter_{0};
+    OnEnqueue on_enqueue_;
+    uint64_t dequeued_ = 0;
 };
 }  // namespace details
 }  // namespace spdlog
@@ -0,0 +1,302 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// multi producer-multi consumer blocking queue of variable length records, stored back to back
+// in a contiguous ring of bytes (bip buffer style: a record that doesn't fit at the end of the
+// ring starts over at its beginning).
+// Each record is a Header followed by the bytes of the given chunks.
+// Capacity is given in bytes, so the memory used is fixed and small records pack densely.
+//
+// enqueue(..) - will block until room found to put the new record.
+// enqueue_nowait(..) - will drop the oldest records to make room for the new one.
+// enqueue_if_have_room(..) - will drop the new record if no room left.
+// take() - will block until there is a record. The record stays in the ring, so the consumer can
+// use it in place, until it is released with release(..).
+// Data too large to ever fit in the ring is truncated.
+// OnEnqueue(header) is called under the ring lock for each record about to be written, or
+// discarded for lack of room, in ring order (see mpmc_blocking_queue).
+
+#include <spdlog/common.h>
+#include <spdlog/details/mpmc_blocking_q.h>
+#include <spdlog/details/region_allocator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+template <typename Header, typename OnEnqueue = no_enqueue_hook>
+class mpmc_byte_ring {
+public:
+    struct record {
+        size_t size;  // of the whole record in the ring
+        size_t data_size;
+        bool released;
+        Header header;
+
+        string_view_t data() const {
+            return string_view_t(reinterpret_cast<const char *>(this) + sizeof(record), data_size);
+        }
+    };
+
+    static constexpr size_t alignment = alignof(record);
+
+    explicit mpmc_byte_ring(size_t capacity_bytes,
+                            const queue_memory_options &mem_options = queue_memory_options{})
+        : capacity_(capacity_bytes / alignment * alignment),
+          buf_(region_allocator<char>(mem_options)) {
+        if (capacity_ < record_size_(0)) {
+            throw_spdlog_ex("mpmc_byte_ring: capacity is too small");
+        }
+        buf_.resize(capacity_);
+    }
+
+    mpmc_byte_ring(const mpmc_byte_ring &) = delete;
+    mpmc_byte_ring &operator=(const mpmc_byte_ring &) = delete;
+
+    ~mpmc_byte_ring() {
+        // destroy the headers of the records left in the ring
+        while (untaken_ > 0) {
+            drop_oldest_();
+        }
+    }
+
+    // block until there is room for the record
+    void enqueue(Header &&header, std::initializer_list<string_view_t> chunks) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        size_t data_size = data_size_(chunks);
+        size_t size = record_size_(data_size);
+        size_t pos;
+        while ((pos = reserve_(size)) == npos) {
+            pop_cv_.wait(lock);
+        }
+        on_enqueue_(header);
+        write_(pos, size, data_size, std::move(header), chunks);
+        push_cv_.notify_one();
+    }
+
+    // drop the oldest records if no room left.
+    // space is freed from the oldest record on, so while a consumer holds it dropping the ones
+    // not taken yet frees nothing: the new record is dropped instead (also counted as overrun).
+    void enqueue_nowait(Header &&header, std::initializer_list<string_view_t> chunks) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        size_t data_size = data_size_(chunks);
+        size_t size = record_size_(data_size);
+        size_t pos;
+        while ((pos = reserve_(size)) == npos) {
+            if (untaken_ == 0 || untaken_ != count_) {
+                on_enqueue_(header);
+                ++overrun_counter_;
+                return;  // header is destroyed by the caller
+            }
+            drop_oldest_();
+            ++overrun_counter_;
+        }
+        on_enqueue_(header);
+        write_(pos, size, data_size, std::move(header), chunks);
+        push_cv_.notify_one();
+    }
+
+    // drop the new record if no room left
+    void enqueue_if_have_room(Header &&header, std::initializer_list<string_view_t> chunks) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        size_t data_size = data_size_(chunks);
+        size_t size = record_size_(data_size);
+        size_t pos = reserve_(size);
+        on_enqueue_(header);
+        if (pos == npos) {
+            ++discard_counter_;
+            return;  // header is destroyed by the caller
+        }
+        write_(pos, size, data_size, std::move(header), chunks);
+        push_cv_.notify_one();
+    }
+
+    // wait for the oldest record not taken yet and take it.
+    // it must be released with release() once done with.
+    record *take() {
+        uint64_t ticket;
+        return take(ticket);
+    }
+
+    // same, also giving the number of records taken before this one
+    record *take(uint64_t &ticket) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        push_cv_.wait(lock, [this] { return this->untaken_ > 0; });
+        take_ = skip_wrap_(take_);
+        auto *r = at_(take_);
+        take_ += r->size;
+        --untaken_;
+        ticket = taken_++;
+        return r;
+    }
+
+    // destroy the record's header and free its space
+    void release(record *r) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            r->header.~Header();
+            r->released = true;
+            advance_head_();
+        }
+        pop_cv_.notify_all();
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    // the largest data size that fits in the ring
+    size_t max_data_size() const { return capacity_ - sizeof(record); }
+
+    // call f(number of records taken so far) with the ring locked, so no record is taken meanwhile
+    template <typename F>
+    void with_taken_count(F &&f) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        f(taken_);
+    }
+
+    // number of records not taken yet
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return untaken_;
+    }
+
+    size_t overrun_counter() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return overrun_counter_;
+    }
+
+    void reset_overrun_counter() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        overrun_counter_ = 0;
+    }
+
+    size_t discard_counter() { return discard_counter_.load(std::memory_order_relaxed); }
+
+    void reset_discard_counter() { discard_counter_.store(0, std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    const size_t capacity_;
+    std::vector<char, region_allocator<char>> buf_;
+    std::mutex mutex_;
+    std::condition_variable push_cv_;
+    std::condition_variable pop_cv_;
+
+    // [head_, tail_) holds the records (wrapping around the end of the ring), the ones from take_
+    // on are not taken yet. a record size of 0 marks the end of the used part before a wrap.
+    size_t head_ = 0;
+    size_t take_ = 0;
+    size_t tail_ = 0;
+    size_t count_ = 0;
+    size_t untaken_ = 0;
+    size_t overrun_counter_ = 0;
+    std::atomic<size_t> discard_counter_{0};
+    OnEnqueue on_enqueue_;
+    uint64_t taken_ = 0;
+
+    static size_t record_size_(size_t data_size) {
+        return (sizeof(record) + data_size + alignment - 1) / alignment * alignment;
+    }
+
+    size_t data_size_(std::initializer_list<string_view_t> chunks) const {
+        size_t n = 0;
+        for (auto &c : chunks) {
+            n += c.size();
+        }
+        return (std::min)(n, max_data_size());
+    }
+
+    record *at_(size_t pos) { return reinterpret_cast<record *>(&buf_[pos]); }
+
+    // the position of the record at pos, after following a wrap marker
+    size_t skip_wrap_(size_t pos) const {
+        if (pos == capacity_) {
+            return 0;
+        }
+        size_t size;
+        std::memcpy(&size, &buf_[pos], sizeof(size));
+        return size == 0 ? 0 : pos;
+    }
+
+    // where a record of the given size can be written, or npos if there is no room
+    size_t reserve_(size_t size) {
+        if (count_ == 0) {
+            head_ = take_ = tail_ = 0;
+            return size <= capacity_ ? 0 : npos;
+        }
+        if (tail_ > head_) {
+            if (size <= capacity_ - tail_) {
+                return tail_;
+            }
+            if (size <= head_) {
+                if (tail_ < capacity_) {
+                    const size_t wrap = 0;
+                    std::memcpy(&buf_[tail_], &wrap, sizeof(wrap));
+                }
+                return 0;
+            }
+            return npos;
+        }
+        // wrapped (or full if tail_ == head_)
+        return size <= head_ - tail_ ? tail_ : npos;
+    }
+
+    void write_(size_t pos,
+                size_t size,
+                size_t data_size,
+                Header &&header,
+                std::initializer_list<string_view_t> chunks) {
+        auto *r = new (&buf_[pos]) record{size, data_size, false, std::move(header)};
+        char *dest = reinterpret_cast<char *>(r) + sizeof(record);
+        size_t left = data_size;
+        for (auto &c : chunks) {
+            size_t n = (std::min)(c.size(), left);
+            if (n > 0) {
+                std::memcpy(dest, c.data(), n);
+            }
+            dest += n;
+            left -= n;
+        }
+        tail_ = pos + size;
+        ++count_;
+        ++untaken_;
+    }
+
+    // drop the oldest record not taken yet
+    void drop_oldest_() {
+        take_ = skip_wrap_(take_);
+        auto *r = at_(take_);
+        take_ += r->size;
+        --untaken_;
+        r->header.~Header();
+        r->released = true;
+        advance_head_();
+    }
+
+    // free the space of the released records at the head of the ring
+    void advance_head_() {
+        while (count_ > 0) {
+            head_ = skip_wrap_(head_);
+            auto *r = at_(head_);
+            if (!r->released) {
+                return;
+            }
+            head_ += r->size;
+            --count_;
+        }
+        head_ = take_ = tail_ = 0;
+    }
+};
+}  // namespace details
+}  // namespace spdlog
@@ -85,6 +85,49 @@ SPDLOG_INLINE spdlog::log_clock::time_point now() SPDLOG_NOEXCEPT {
     return log_clock::now();
 #endif
 }
+SPDLOG_INLINE spdlog::mono_clock::time_point mono_now() SPDLOG_NOEXCEPT {
+#if defined __linux__ && defined SPDLOG_CLOCK_COARSE
+    timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return std::chrono::time_point<mono_clock, typename mono_clock::duration>(
+        std::chrono::duration_cast<typename mono_clock::duration>(
+            std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec)));
+#else
+    return mono_clock::now();
+#endif
+}
+
+// both clocks sampled once, to convert between them
+struct clock_anchor {
+    log_clock::time_point wall;
+    mono_clock::time_point mono;
+
+    clock_anchor()
+        : wall(now()),
+          mono(mono_now()) {}
+
+    static const clock_anchor &get() SPDLOG_NOEXCEPT {
+        static const clock_anchor anchor;
+        return anchor;
+    }
+};
+
+SPDLOG_INLINE spdlog::mono_clock::time_point mono_start() SPDLOG_NOEXCEPT {
+    return clock_anchor::get().mono;
+}
+
+SPDLOG_INLINE spdlog::log_clock::time_point mono_to_wall(mono_clock::time_point tp)
+    SPDLOG_NOEXCEPT {
+    const auto &anchor = clock_anchor::get();
+    return anchor.wall + std::chrono::duration_cast<log_clock::duration>(tp - anchor.mono);
+}
+
+SPDLOG_INLINE spdlog::mono_clock::time_point wall_to_mono(log_clock::time_point tp)
+    SPDLOG_NOEXCEPT {
+    const auto &anchor = clock_anchor::get();
+    return anchor.mono + std::chrono::duration_cast<mono_clock::duration>(tp - anchor.wall);
+}
+
 SPDLOG_INLINE std::tm localtime(const std::time_t &time_tt) SPDLOG_NOEXCEPT {
 #ifdef _WIN32
     std::tm tm;
@@ -12,6 +12,17 @@ namespace os {
 
 SPDLOG_API spdlog::log_clock::time_point now() SPDLOG_NOEXCEPT;
 
+// monotonic time (CLOCK_MONOTONIC_COARSE under linux if SPDLOG_CLOCK_COARSE is defined)
+SPDLOG_API spdlog::mono_clock::time_point mono_now() SPDLOG_NOEXCEPT;
+
+// monotonic time when spdlog started (sampled on first use of the clocks, or registry creation)
+SPDLOG_API spdlog::mono_clock::time_point mono_start() SPDLOG_NOEXCEPT;
+
+// convert between wall clock and monotonic time points, using the offset between the two
+// clocks at mono_start()
+SPDLOG_API spdlog::log_clock::time_point mono_to_wall(mono_clock::time_point tp) SPDLOG_NOEXCEPT;
+SPDLOG_API spdlog::mono_clock::time_point wall_to_mono(log_clock::time_point tp) SPDLOG_NOEXCEPT;
+
 SPDLOG_API std::tm localtime(const std::time_t &time_tt) SPDLOG_NOEXCEPT;
 
 SPDLOG_API std::tm localtime() SPDLOG_NOEXCEPT;
@@ -0,0 +1,160 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#ifndef SPDLOG_HEADER_ONLY
+    #include <spdlog/details/profiler.h>
+#endif
+
+#ifdef SPDLOG_PROFILE
+
+    #include <algorithm>
+    #include <mutex>
+    #include <tuple>
+    #include <utility>
+
+namespace spdlog {
+namespace details {
+
+namespace profiler_detail {
+struct atomic_counters {
+    std::atomic<uint64_t> ticks[profile_counters::n_stages];
+    std::atomic<uint64_t> calls[profile_counters::n_stages];
+
+    atomic_counters() {
+        for (size_t i = 0; i < profile_counters::n_stages; i++) {
+            ticks[i].store(0, std::memory_order_relaxed);
+            calls[i].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+// the counters of one thread. only the owning thread inserts (under the mutex, which collect()
+// takes to read them) and adds, so it can look them up without the mutex.
+// the counters of the last few owners are cached, since a message goes through a logger and its
+// sinks in turn. counters are never erased (reset() zeroes them), so the pointers stay valid.
+struct thread_table {
+    static constexpr size_t n_recent = 4;
+
+    std::mutex mutex;
+    std::unordered_map<const void *, atomic_counters> counters;
+    const void *recent_owners[n_recent] = {};
+    atomic_counters *recent[n_recent] = {};
+    size_t next_recent = 0;
+
+    atomic_counters &counters_of(const void *owner) {
+        for (size_t i = 0; i < n_recent; i++) {
+            if (recent_owners[i] == owner && recent[i] != nullptr) {
+                return *recent[i];
+            }
+        }
+        auto it = counters.find(owner);
+        if (it == counters.end()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            it = counters.emplace(std::piecewise_construct, std::forward_as_tuple(owner),
+                                  std::forward_as_tuple())
+                     .first;
+        }
+        recent_owners[next_recent] = owner;
+        recent[next_recent] = &it->second;
+        next_recent = (next_recent + 1) % n_recent;
+        return it->second;
+    }
+};
+
+// the tables of the live threads, and the totals of the threads that exited.
+// never destroyed, threads may exit after static destruction started.
+struct tables {
+    std::mutex mutex;
+    std::vector<thread_table *> live;
+    std::unordered_map<const void *, profile_counters> retired;
+
+    static tables &instance() {
+        static auto *t = new tables();
+        return *t;
+    }
+};
+
+inline void add_to(profile_counters &dest, const atomic_counters &src) {
+    for (size_t i = 0; i < profile_counters::n_stages; i++) {
+        dest.ticks[i] += src.ticks[i].load(std::memory_order_relaxed);
+        dest.calls[i] += src.calls[i].load(std::memory_order_relaxed);
+    }
+}
+
+// registers the calling thread's table, and moves its counters to the retired ones at exit
+struct thread_registration {
+    thread_table table;
+
+    thread_registration() {
+        auto &t = tables::instance();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        t.live.push_back(&table);
+    }
+
+    ~thread_registration() {
+        auto &t = tables::instance();
+        std::lock_guard<std::mutex> lock(t.mutex);
+        t.live.erase(std::remove(t.live.begin(), t.live.end(), &table), t.live.end());
+        for (auto &c : table.counters) {
+            add_to(t.retired[c.first], c.second);
+        }
+    }
+};
+
+inline thread_table &this_thread_table() {
+    static thread_local thread_registration r;
+    return r.table;
+}
+}  // namespace profiler_detail
+
+SPDLOG_INLINE void profiler::add(const void *owner, profile_stage stage, uint64_t n) {
+    auto &counters = profiler_detail::this_thread_table().counters_of(owner);
+    auto i = static_cast<size_t>(stage);
+    counters.ticks[i].fetch_add(n, std::memory_order_relaxed);
+    counters.calls[i].fetch_add(1, std::memory_order_relaxed);
+}
+
+SPDLOG_INLINE const void *&profiler::current_owner() {
+    static thread_local const void *owner = nullptr;
+    return owner;
+}
+
+SPDLOG_INLINE uint64_t &profiler::nested_ticks() {
+    static thread_local uint64_t ticks = 0;
+    return ticks;
+}
+
+SPDLOG_INLINE std::unordered_map<const void *, profile_counters> profiler::collect() {
+    auto &t = profiler_detail::tables::instance();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    auto result = t.retired;
+    for (auto *table : t.live) {
+        std::lock_guard<std::mutex> table_lock(table->mutex);
+        for (auto &c : table->counters) {
+            profiler_detail::add_to(result[c.first], c.second);
+        }
+    }
+    return result;
+}
+
+SPDLOG_INLINE void profiler::reset() {
+    auto &t = profiler_detail::tables::instance();
+    std::lock_guard<std::mutex> lock(t.mutex);
+    t.retired.clear();
+    for (auto *table : t.live) {
+        std::lock_guard<std::mutex> table_lock(table->mutex);
+        for (auto &c : table->counters) {
+            for (size_t i = 0; i < profile_counters::n_stages; i++) {
+                c.second.ticks[i].store(0, std::memory_order_relaxed);
+                c.second.calls[i].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+}  // namespace details
+}  // namespace spdlog
+
+#endif  // SPDLOG_PROFILE
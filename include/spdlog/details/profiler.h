@@ -0,0 +1,169 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Self profiling (compiled in only if SPDLOG_PROFILE is defined).
+// The logger and base_sink count the cpu ticks (rdtsc / cntvct, steady_clock elsewhere) spent in
+// each stage of logging a message:
+//   vformat        - formatting the message arguments (logger::log_), per logger
+//   pattern_format - formatting the message with the sink's pattern_formatter, per sink
+//   lock_wait      - waiting for the sink's mutex, per sink
+//   write          - the rest of the sink's work (sink_it_ / sink_formatted_), per sink
+//   flush          - the sink's flush_(), per sink
+// Ticks are added to per thread accumulators, keyed by the logger / sink address, so the hot path
+// takes no shared lock. spdlog::profile_report() sums them up for the loggers in the registry.
+// Without SPDLOG_PROFILE the SPDLOG_PROFILE_* macros expand to nothing.
+
+#include <spdlog/common.h>
+
+#ifdef SPDLOG_PROFILE
+    #ifdef SPDLOG_NO_TLS
+        #error "SPDLOG_PROFILE requires thread local storage (SPDLOG_NO_TLS is defined)"
+    #endif
+
+    #include <atomic>
+    #include <chrono>
+    #include <cstdint>
+    #include <string>
+    #include <unordered_map>
+    #include <vector>
+
+    #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        #include <intrin.h>
+    #elif defined(__x86_64__) || defined(__i386__)
+        #include <x86intrin.h>
+    #endif
+
+namespace spdlog {
+
+enum class profile_stage { vformat = 0, pattern_format, lock_wait, write, flush };
+
+struct profile_counters {
+    static constexpr size_t n_stages = 5;
+    uint64_t ticks[n_stages] = {};
+    uint64_t calls[n_stages] = {};
+
+    uint64_t ticks_of(profile_stage s) const { return ticks[static_cast<size_t>(s)]; }
+    uint64_t calls_of(profile_stage s) const { return calls[static_cast<size_t>(s)]; }
+};
+
+// the counters of a logger (sink empty), or of one of its sinks
+struct profile_entry {
+    std::string logger;
+    std::string sink;  // "sink[i]" - index in the logger's sinks
+    profile_counters counters;
+};
+
+namespace details {
+
+class SPDLOG_API profiler {
+public:
+    static uint64_t ticks() {
+    #if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+    #elif defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+    #elif defined(__aarch64__)
+        uint64_t v;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(v));
+        return v;
+    #else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    #endif
+    }
+
+    // add ticks to the calling thread's counters of the owner (a logger or sink)
+    static void add(const void *owner, profile_stage stage, uint64_t n);
+
+    // the owner of the pattern formatting done by the calling thread (the sink logging)
+    static const void *&current_owner();
+
+    // ticks of pattern formatting done by the calling thread so far, so the enclosing write can
+    // exclude them
+    static uint64_t &nested_ticks();
+
+    // the sum of the counters of all threads, by owner
+    static std::unordered_map<const void *, profile_counters> collect();
+
+    static void reset();
+};
+
+// count the ticks from construction to stop() or destruction
+class profile_scope {
+public:
+    profile_scope(const void *owner, profile_stage stage, bool exclude_nested = false)
+        : owner_(owner),
+          stage_(stage),
+          nested_start_(exclude_nested ? profiler::nested_ticks() : no_nested),
+          start_(profiler::ticks()) {}
+
+    ~profile_scope() { stop(); }
+
+    profile_scope(const profile_scope &) = delete;
+    profile_scope &operator=(const profile_scope &) = delete;
+
+    void stop() {
+        if (owner_ == nullptr) {
+            return;
+        }
+        uint64_t n = profiler::ticks() - start_;
+        if (stage_ == profile_stage::pattern_format) {
+            profiler::nested_ticks() += n;
+        } else if (nested_start_ != no_nested) {
+            uint64_t nested = profiler::nested_ticks() - nested_start_;
+            n = n > nested ? n - nested : 0;
+        }
+        profiler::add(owner_, stage_, n);
+        owner_ = nullptr;
+    }
+
+private:
+    static constexpr uint64_t no_nested = static_cast<uint64_t>(-1);
+    const void *owner_;
+    profile_stage stage_;
+    uint64_t nested_start_;
+    uint64_t start_;
+};
+
+// make the given sink the owner of the pattern formatting done in this scope
+class profile_owner_scope {
+public:
+    explicit profile_owner_scope(const void *owner)
+        : prev_(profiler::current_owner()) {
+        profiler::current_owner() = owner;
+    }
+
+    ~profile_owner_scope() { profiler::current_owner() = prev_; }
+
+    profile_owner_scope(const profile_owner_scope &) = delete;
+    profile_owner_scope &operator=(const profile_owner_scope &) = delete;
+
+private:
+    const void *prev_;
+};
+
+}  // namespace details
+}  // namespace spdlog
+
+    #define SPDLOG_PROFILE_SCOPE(name, owner, stage) \
+        spdlog::details::profile_scope name(owner, spdlog::profile_stage::stage)
+    // like SPDLOG_PROFILE_SCOPE, excluding the pattern formatting done inside the scope
+    #define SPDLOG_PROFILE_SCOPE_EXCLUSIVE(name, owner, stage) \
+        spdlog::details::profile_scope name(owner, spdlog::profile_stage::stage, true)
+    #define SPDLOG_PROFILE_STOP(name) name.stop()
+    #define SPDLOG_PROFILE_OWNER(owner) \
+        spdlog::details::profile_owner_scope spdlog_profile_owner_(owner)
+
+    #ifdef SPDLOG_HEADER_ONLY
+        #include "profiler-inl.h"
+    #endif
+
+#else
+    #define SPDLOG_PROFILE_SCOPE(name, owner, stage)
+    #define SPDLOG_PROFILE_SCOPE_EXCLUSIVE(name, owner, stage)
+    #define SPDLOG_PROFILE_STOP(name)
+    #define SPDLOG_PROFILE_OWNER(owner)
+#endif  // SPDLOG_PROFILE
@@ -0,0 +1,263 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Allocation of large, long lived buffers (e.g. the async queue slots) that can be backed by huge
+// pages, pre-faulted and locked in RAM.
+// Each option is best effort: if huge pages are not available (none reserved, no THP support,
+// not Linux) the memory is backed by regular pages, and if the memory cannot be locked (e.g.
+// RLIMIT_MEMLOCK is too low) it is left unlocked.
+
+#include <spdlog/common.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+#ifdef _WIN32
+    #include <spdlog/details/windows_include.h>
+#else
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+namespace spdlog {
+
+struct queue_memory_options {
+    // back the memory with huge pages: MAP_HUGETLB if huge pages are reserved, otherwise
+    // transparent huge pages (madvise(MADV_HUGEPAGE)). large pages on windows.
+    bool huge_pages = false;
+    // touch every page at allocation, so the first messages take no page faults
+    bool prefault = false;
+    // lock the memory in RAM (mlock / VirtualLock)
+    bool lock = false;
+    // if not 0, queue messages as variable length records in a ring of this many bytes
+    // (see mpmc_byte_ring.h) rather than in fixed size slots. the thread pool's q_max_items is
+    // then ignored.
+    size_t ring_bytes = 0;
+
+    // any of the allocation options is set
+    bool any() const { return huge_pages || prefault || lock; }
+};
+
+inline bool operator==(const queue_memory_options &a, const queue_memory_options &b) {
+    return a.huge_pages == b.huge_pages && a.prefault == b.prefault && a.lock == b.lock &&
+           a.ring_bytes == b.ring_bytes;
+}
+
+inline bool operator!=(const queue_memory_options &a, const queue_memory_options &b) {
+    return !(a == b);
+}
+
+namespace details {
+
+class memory_region {
+public:
+    // the region starts with this header, the memory handed out follows it
+    struct header {
+        size_t map_size;  // size of the whole mapping
+        size_t map_offset;  // distance from the start of the mapping to the header
+        bool huge_pages;  // backed by huge pages (explicitly or, possibly, transparently)
+        bool locked;
+    };
+    static constexpr size_t header_size = 64;
+    static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+
+    // allocate at least n bytes, aligned to header_size. throws spdlog_ex on failure.
+    static void *allocate(size_t n, const queue_memory_options &opts) {
+        const size_t page = page_size();
+        size_t size = round_up(n + header_size, page);
+        header h{};
+        char *base = nullptr;
+        size_t offset = 0;
+        size_t map_size = 0;
+#ifdef _WIN32
+        if (opts.huge_pages) {
+            size_t large_page = ::GetLargePageMinimum();
+            if (large_page != 0) {
+                size_t large_size = round_up(size, large_page);
+                base = static_cast<char *>(::VirtualAlloc(
+                    nullptr, large_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                    PAGE_READWRITE));
+                if (base != nullptr) {
+                    size = large_size;
+                    h.huge_pages = true;
+                }
+            }
+        }
+        if (base == nullptr) {
+            base = static_cast<char *>(
+                ::VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+        }
+        if (base == nullptr) {
+            throw_spdlog_ex("memory_region: VirtualAlloc failed",
+                            static_cast<int>(::GetLastError()));
+        }
+        map_size = size;
+#else
+    #ifdef MAP_HUGETLB
+        if (opts.huge_pages) {
+            // fails unless huge pages were reserved (vm.nr_hugepages)
+            size_t huge_size = round_up(size, huge_page_size);
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+        #ifdef MAP_POPULATE
+            if (opts.prefault) {
+                flags |= MAP_POPULATE;
+            }
+        #endif
+            void *p = ::mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (p != MAP_FAILED) {
+                base = static_cast<char *>(p);
+                size = huge_size;
+                map_size = huge_size;
+                h.huge_pages = true;
+            }
+        }
+    #endif
+        if (base == nullptr) {
+            map_size = size;
+    #ifdef MADV_HUGEPAGE
+            // transparent huge pages are only used for huge page aligned ranges,
+            // so over allocate and start at the first huge page boundary.
+            const bool thp = opts.huge_pages && size >= huge_page_size;
+            if (thp) {
+                size = round_up(size, huge_page_size);
+                map_size = size + huge_page_size;
+            }
+    #endif
+            void *p = ::mmap(nullptr, map_size, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) {
+                throw_spdlog_ex("memory_region: mmap failed", errno);
+            }
+            base = static_cast<char *>(p);
+    #ifdef MADV_HUGEPAGE
+            if (thp) {
+                auto addr = reinterpret_cast<uintptr_t>(base);
+                offset = static_cast<size_t>(round_up(addr, huge_page_size) - addr);
+                h.huge_pages = ::madvise(base + offset, size, MADV_HUGEPAGE) == 0;
+            }
+    #endif
+        }
+#endif
+        // after madvise, so the pages are faulted in as huge pages
+        if (opts.prefault) {
+            touch(base + offset, size, page);
+        }
+        if (opts.lock) {
+#ifdef _WIN32
+            h.locked = ::VirtualLock(base, size) != 0;
+#else
+            h.locked = ::mlock(base + offset, size) == 0;
+#endif
+        }
+        h.map_size = map_size;
+        h.map_offset = offset;
+        auto *hp = reinterpret_cast<header *>(base + offset);
+        *hp = h;
+        return base + offset + header_size;
+    }
+
+    static void deallocate(void *p) {
+        if (p == nullptr) {
+            return;
+        }
+        const header &h = region_header(p);
+        char *base = static_cast<char *>(p) - header_size - h.map_offset;
+#ifdef _WIN32
+        if (h.locked) {
+            ::VirtualUnlock(base, h.map_size);
+        }
+        ::VirtualFree(base, 0, MEM_RELEASE);
+#else
+        // munmap also unlocks the pages
+        ::munmap(base, h.map_size);
+#endif
+    }
+
+    // the header of a region returned by allocate()
+    static const header &region_header(const void *p) {
+        return *reinterpret_cast<const header *>(static_cast<const char *>(p) - header_size);
+    }
+
+    static size_t page_size() {
+#ifdef _WIN32
+        SYSTEM_INFO si;
+        ::GetSystemInfo(&si);
+        return static_cast<size_t>(si.dwPageSize);
+#else
+        static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        return size;
+#endif
+    }
+
+private:
+    template <typename U>
+    static U round_up(U n, size_t multiple) {
+        return (n + multiple - 1) / multiple * multiple;
+    }
+
+    static void touch(char *p, size_t n, size_t page) {
+        volatile char *vp = p;
+        for (size_t i = 0; i < n; i += page) {
+            vp[i] = 0;
+        }
+    }
+};
+
+// Allocator that places the memory in a memory_region when any of the options is set, and uses
+// operator new otherwise.
+template <typename T>
+class region_allocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    region_allocator() = default;
+
+    explicit region_allocator(const queue_memory_options &opts)
+        : opts_(opts) {}
+
+    template <typename U>
+    region_allocator(const region_allocator<U> &other)  // NOLINT(google-explicit-constructor)
+        : opts_(other.options()) {}
+
+    T *allocate(size_t n) {
+        static_assert(alignof(T) <= memory_region::header_size, "over aligned type");
+        if (!opts_.any()) {
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T *>(memory_region::allocate(n * sizeof(T), opts_));
+    }
+
+    void deallocate(T *p, size_t) {
+        if (!opts_.any()) {
+            ::operator delete(p);
+        } else {
+            memory_region::deallocate(p);
+        }
+    }
+
+    const queue_memory_options &options() const { return opts_; }
+
+private:
+    queue_memory_options opts_;
+};
+
+template <typename T, typename U>
+bool operator==(const region_allocator<T> &a, const region_allocator<U> &b) {
+    return a.options() == b.options();
+}
+
+template <typename T, typename U>
+bool operator!=(const region_allocator<T> &a, const region_allocator<U> &b) {
+    return !(a == b);
+}
+
+}  // namespace details
+}  // namespace spdlog
@@ -21,6 +21,7 @@
     #endif
 #endif  // SPDLOG_DISABLE_DEFAULT_LOGGER
 
+#include <algorithm>
 #include <chrono>
 #include <functional>
 #include <memory>
@@ -30,20 +31,13 @@
 namespace spdlog {
 namespace details {
 
-SPDLOG_INLINE registry::registry()
-    : formatter_(new pattern_formatter()) {
+// The default logger and the global formatter are created on first use, so programs that never
+// log don't pay for probing the terminal or compiling patterns.
+SPDLOG_INLINE registry::registry() {
+    // anchor the clocks (%k prints the time since then)
+    os::mono_start();
 #ifndef SPDLOG_DISABLE_DEFAULT_LOGGER
-    // create default logger (ansicolor_stdout_sink_mt or wincolor_stdout_sink_mt in windows).
-    #ifdef _WIN32
-    auto color_sink = std::make_shared<sinks::wincolor_stdout_sink_mt>();
-    #else
-    auto color_sink = std::make_shared<sinks::ansicolor_stdout_sink_mt>();
-    #endif
-
-    const char *default_logger_name = "";
-    default_logger_ = std::make_shared<spdlog::logger>(default_logger_name, std::move(color_sink));
-    loggers_[default_logger_name] = default_logger_;
-
+    default_logger_pending_.store(true, std::memory_order_relaxed);
 #endif  // SPDLOG_DISABLE_DEFAULT_LOGGER
 }
 
@@ -56,7 +50,7 @@ SPDLOG_INLINE void registry::register_logger(std::shared_ptr<logger> new_logger)
 
 SPDLOG_INLINE void registry::initialize_logger(std::shared_ptr<logger> new_logger) {
     std::lock_guard<std::mutex> lock(logger_map_mutex_);
-    new_logger->set_formatter(formatter_->clone());
+    new_logger->set_formatter(clone_formatter_());
 
     if (err_handler_) {
         new_logger->set_error_handler(err_handler_);
@@ -80,21 +74,19 @@ SPDLOG_INLINE void registry::initialize_logger(std::shared_ptr<logger> new_logge
 
 SPDLOG_INLINE std::shared_ptr<logger> registry::get(const std::string &logger_name) {
     std::lock_guard<std::mutex> lock(logger_map_mutex_);
+    if (logger_name.empty()) {
+        create_default_logger_locked_();
+    }
     auto found = loggers_.find(logger_name);
     return found == loggers_.end() ? nullptr : found->second;
 }
 
 SPDLOG_INLINE std::shared_ptr<logger> registry::default_logger() {
     std::lock_guard<std::mutex> lock(logger_map_mutex_);
+    create_default_logger_locked_();
     return default_logger_;
 }
 
-// Return raw ptr to the default logger.
-// To be used directly by the spdlog default api (e.g. spdlog::info)
-// This make the default API faster, but cannot be used concurrently with set_default_logger().
-// e.g do not call set_default_logger() from one thread while calling spdlog::info() from another.
-SPDLOG_INLINE logger *registry::get_default_raw() { return default_logger_.get(); }
-
 // set default logger.
 // default logger is stored in default_logger_ (for faster retrieval) and in the loggers_ map.
 SPDLOG_INLINE void registry::set_default_logger(std::shared_ptr<logger> new_default_logger) {
@@ -103,6 +95,7 @@ SPDLOG_INLINE void registry::set_default_logger(std::shared_ptr<logger> new_defa
         loggers_[new_default_logger->name()] = new_default_logger;
     }
     default_logger_ = std::move(new_default_logger);
+    default_logger_pending_.store(false, std::memory_order_release);
 }
 
 SPDLOG_INLINE void registry::set_tp(std::shared_ptr<thread_pool> tp) {
@@ -124,6 +117,30 @@ SPDLOG_INLINE void registry::set_formatter(std::unique_ptr<formatter> formatter)
     }
 }
 
+#ifdef SPDLOG_PROFILE
+SPDLOG_INLINE std::vector<profile_entry> registry::profile_report() {
+    auto counters = profiler::collect();
+    std::vector<profile_entry> report;
+    std::lock_guard<std::mutex> lock(logger_map_mutex_);
+    for (auto &l : loggers_) {
+        profile_entry entry;
+        entry.logger = l.first;
+        entry.counters = counters[l.second.get()];
+        report.push_back(entry);
+        auto &sinks = l.second->sinks();
+        for (size_t i = 0; i < sinks.size(); i++) {
+            entry.sink = fmt_lib::format("sink[{}]", i);
+            entry.counters = counters[sinks[i].get()];
+            report.push_back(entry);
+        }
+    }
+    std::sort(report.begin(), report.end(), [](const profile_entry &a, const profile_entry &b) {
+        return a.logger < b.logger || (a.logger == b.logger && a.sink < b.sink);
+    });
+    return report;
+}
+#endif
+
 SPDLOG_INLINE void registry::enable_backtrace(size_t n_messages) {
     std::lock_guard<std::mutex> lock(logger_map_mutex_);
     backtrace_n_messages_ = n_messages;
@@ -168,6 +185,7 @@ SPDLOG_INLINE void registry::set_error_handler(err_handler handler) {
 SPDLOG_INLINE void registry::apply_all(
     const std::function<void(const std::shared_ptr<logger>)> &fun) {
     std::lock_guard<std::mutex> lock(logger_map_mutex_);
+    create_default_logger_locked_();
     for (auto &l : loggers_) {
         fun(l.second);
     }
@@ -187,12 +205,16 @@ SPDLOG_INLINE void registry::drop(const std::string &logger_name) {
     if (is_default_logger) {
         default_logger_.reset();
     }
+    if (logger_name.empty()) {
+        default_logger_pending_.store(false, std::memory_order_release);
+    }
 }
 
 SPDLOG_INLINE void registry::drop_all() {
     std::lock_guard<std::mutex> lock(logger_map_mutex_);
     loggers_.clear();
     default_logger_.reset();
+    default_logger_pending_.store(false, std::memory_order_release);
 }
 
 // clean all resources and threads started by the registry
@@ -253,9 +275,62 @@ SPDLOG_INLINE void registry::throw_if_exists_(const std::string &logger_name) {
 
 SPDLOG_INLINE void registry::register_logger_(std::shared_ptr<logger> new_logger) {
     auto logger_name = new_logger->name();
+    if (logger_name.empty()) {
+        // the (not yet created) default logger owns the empty name
+        create_default_logger_locked_();
+    }
     throw_if_exists_(logger_name);
     loggers_[logger_name] = std::move(new_logger);
 }
 
+SPDLOG_INLINE void registry::create_default_logger_() {
+    std::lock_guard<std::mutex> lock(logger_map_mutex_);
+    create_default_logger_locked_();
+}
+
+SPDLOG_INLINE void registry::create_default_logger_locked_() {
+#ifndef SPDLOG_DISABLE_DEFAULT_LOGGER
+    if (!default_logger_pending_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // create default logger (ansicolor_stdout_sink_mt or wincolor_stdout_sink_mt in windows).
+    #ifdef _WIN32
+    auto color_sink = std::make_shared<sinks::wincolor_stdout_sink_mt>();
+    #else
+    auto color_sink = std::make_shared<sinks::ansicolor_stdout_sink_mt>();
+    #endif
+
+    const char *default_logger_name = "";
+    auto new_logger = std::make_shared<spdlog::logger>(default_logger_name, std::move(color_sink));
+
+    // apply the global settings made so far, like they would have been applied to it had it
+    // existed already
+    if (formatter_ != nullptr) {
+        new_logger->set_formatter(formatter_->clone());
+    }
+    if (err_handler_) {
+        new_logger->set_error_handler(err_handler_);
+    }
+    auto it = log_levels_.find(default_logger_name);
+    new_logger->set_level(it != log_levels_.end() ? it->second : global_log_level_);
+    new_logger->flush_on(flush_level_);
+    if (backtrace_n_messages_ > 0) {
+        new_logger->enable_backtrace(backtrace_n_messages_);
+    }
+
+    loggers_[default_logger_name] = new_logger;
+    default_logger_ = std::move(new_logger);
+    default_logger_pending_.store(false, std::memory_order_release);
+#endif  // SPDLOG_DISABLE_DEFAULT_LOGGER
+}
+
+// clone of the global formatter (the default pattern formatter if none was set)
+SPDLOG_INLINE std::unique_ptr<formatter> registry::clone_formatter_() {
+    if (formatter_ == nullptr) {
+        return details::make_unique<pattern_formatter>();
+    }
+    return formatter_->clone();
+}
+
 }  // namespace details
 }  // namespace spdlog
@@ -10,13 +10,16 @@
 
 #include <spdlog/common.h>
 #include <spdlog/details/periodic_worker.h>
+#include <spdlog/details/profiler.h>
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace spdlog {
 class logger;
@@ -40,7 +43,12 @@ public:
     // This make the default API faster, but cannot be used concurrently with set_default_logger().
     // e.g do not call set_default_logger() from one thread while calling spdlog::info() from
     // another.
-    logger *get_default_raw();
+    logger *get_default_raw() {
+        if (default_logger_pending_.load(std::memory_order_acquire)) {
+            create_default_logger_();
+        }
+        return default_logger_.get();
+    }
 
     // set default logger and add it to the registry if not registered already.
     // default logger is stored in default_logger_ (for faster retrieval) and in the loggers_ map.
@@ -81,6 +89,11 @@ public:
 
     void flush_all();
 
+#ifdef SPDLOG_PROFILE
+    // the profile counters of the registered loggers and their sinks
+    std::vector<profile_entry> profile_report();
+#endif
+
     void drop(const std::string &logger_name);
 
     void drop_all();
@@ -105,6 +118,11 @@ private:
 
     void throw_if_exists_(const std::string &logger_name);
     void register_logger_(std::shared_ptr<logger> new_logger);
+    // create the default logger if it wasn't created (or replaced/dropped) yet
+    void create_default_logger_();
+    // same, with logger_map_mutex_ held
+    void create_default_logger_locked_();
+    std::unique_ptr<formatter> clone_formatter_();
     bool set_level_from_cfg_(logger *logger);
     std::mutex logger_map_mutex_, flusher_mutex_;
     std::recursive_mutex tp_mutex_;
@@ -117,6 +135,8 @@ private:
     std::shared_ptr<thread_pool> tp_;
     std::unique_ptr<periodic_worker> periodic_flusher_;
     std::shared_ptr<logger> default_logger_;
+    // the default logger is created on first use (see create_default_logger_())
+    std::atomic<bool> default_logger_pending_{false};
     bool automatic_registration_ = true;
     size_t backtrace_n_messages_ = 0;
 };
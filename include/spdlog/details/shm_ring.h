@@ -0,0 +1,345 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Multi producer-single consumer ring of log records in POSIX shared memory ("/spdlog.<name>"),
+// written by shm_sink in any number of processes and drained by one collector process
+// (tools/spdlog_collect).
+//
+// The ring is an array of fixed size slots, each with a sequence word (the scheme of Dmitry
+// Vyukov's bounded queue) that tells whose turn the slot is:
+//   2 * t                 - free, for the producer that claims ticket t
+//   (pid << 1) | 1        - being written by the producer process pid
+//   2 * t + 2             - holds the record of ticket t, ready to be consumed
+// A producer claims a ticket from the shared tail, waits until the slot is free for it (this is
+// the back-pressure when the ring is full) and takes it with a CAS, so a slot is written by one
+// producer at a time, and the consumer can tell if that producer crashed:
+// - a ticket claimed but never started (the producer died right after claiming it) is skipped
+//   after the stale timeout. if the producer was just slow, its CAS fails and it claims another
+//   ticket.
+// - a slot being written is skipped after the stale timeout too, and only if kill(pid, 0) also
+//   says its process no longer exists.
+// So a crashed producer costs at most its own record and never blocks the ring.
+// The pid check assumes the collector and the producers share a PID namespace (e.g. containers
+// sharing the memory but not the host pid namespace don't). Otherwise a writer's pid might name
+// no process, or an unrelated one, in the collector's namespace: a live writer stalled for longer
+// than the stale timeout could then have its slot skipped (and its record lost or garbled), and
+// the slot of a crashed one might never be skipped, blocking the ring.
+// The consumer's position is kept in the shared memory too, so a restarted collector continues
+// where the previous one stopped.
+//
+// POSIX only. On glibc older than 2.34, link with -lrt.
+
+#include <spdlog/common.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace spdlog {
+namespace details {
+
+class shm_ring {
+public:
+    struct ring_header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t slot_count;
+        uint64_t slot_size;  // including the slot_header
+        std::atomic<uint32_t> ready;
+        alignas(64) std::atomic<uint64_t> tail;  // next ticket to claim
+        alignas(64) std::atomic<uint64_t> head;  // next ticket to consume
+        std::atomic<uint64_t> dropped;  // records dropped because the ring was full
+        std::atomic<uint64_t> skipped;  // records lost to crashed producers
+    };
+
+    struct slot_header {
+        std::atomic<uint64_t> seq;
+        int64_t time;  // nanoseconds since epoch
+        uint32_t size;
+        int32_t level;
+    };
+
+    static constexpr uint32_t magic = 0x53504c52;  // "SPLR"
+    static constexpr uint32_t version = 1;
+    static constexpr size_t header_size = (sizeof(ring_header) + 63) / 64 * 64;
+
+    // open the ring with the given name, creating it with the given geometry if it doesn't exist
+    // (an existing ring keeps its own geometry)
+    shm_ring(const std::string &name, size_t slot_count, size_t slot_size)
+        : name_(name) {
+        static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+                      "shm_ring needs lock free atomics");
+        if (name.empty() || name.find('/') != std::string::npos) {
+            throw_spdlog_ex("shm_ring: invalid name \"" + name + "\"");
+        }
+        if (slot_count < 2 || slot_size < sizeof(slot_header) + 16) {
+            throw_spdlog_ex("shm_ring: invalid geometry for \"" + name + "\"");
+        }
+        slot_size = (slot_size + 63) / 64 * 64;
+        auto path = shm_path(name);
+        bool created = true;
+        int fd = ::shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+        if (fd < 0 && errno == EEXIST) {
+            created = false;
+            fd = ::shm_open(path.c_str(), O_RDWR, 0);
+        }
+        if (fd < 0) {
+            throw_spdlog_ex("shm_ring: failed opening " + path, errno);
+        }
+        const char *error = created ? create_(fd, slot_count, slot_size) : attach_(fd);
+        int err = errno;
+        ::close(fd);
+        if (error != nullptr) {
+            if (map_ != nullptr) {
+                ::munmap(map_, map_size_);
+            }
+            if (created) {
+                remove(name);
+            }
+            throw_spdlog_ex(std::string("shm_ring: ") + error + " " + path, err);
+        }
+    }
+
+    ~shm_ring() {
+        if (map_ != nullptr) {
+            ::munmap(map_, map_size_);
+        }
+    }
+
+    shm_ring(const shm_ring &) = delete;
+    shm_ring &operator=(const shm_ring &) = delete;
+
+    // remove the ring's name. processes that have it open keep using it.
+    static void remove(const std::string &name) { ::shm_unlink(shm_path(name).c_str()); }
+
+    static std::string shm_path(const std::string &name) { return "/spdlog." + name; }
+
+    // put a record in the ring (truncated to fit in a slot).
+    // if the ring is full, wait for room if block is true, otherwise drop the record.
+    // return false if the record was dropped.
+    bool push(level::level_enum lvl, log_clock::time_point time, string_view_t data, bool block) {
+        const uint64_t writing = (static_cast<uint64_t>(::getpid()) << 1) | 1;
+        for (;;) {
+            if (!block && hdr_->tail.load(std::memory_order_relaxed) -
+                                  hdr_->head.load(std::memory_order_relaxed) >=
+                              slot_count_) {
+                hdr_->dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            const uint64_t t = hdr_->tail.fetch_add(1, std::memory_order_relaxed);
+            auto *s = slot_(t);
+            if (!acquire_slot_(s, t, writing)) {
+                continue;  // skipped by the consumer meanwhile, claim another ticket
+            }
+            size_t n = (std::min)(data.size(), slot_size_ - sizeof(slot_header));
+            s->time = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch())
+                          .count();
+            s->size = static_cast<uint32_t>(n);
+            s->level = static_cast<int32_t>(lvl);
+            if (n > 0) {
+                std::memcpy(slot_data_(s), data.data(), n);
+            }
+            uint64_t expected = writing;
+            return s->seq.compare_exchange_strong(expected, 2 * t + 2, std::memory_order_release,
+                                                  std::memory_order_relaxed);
+        }
+    }
+
+    // consumer: pass up to max_records records, oldest first, to
+    // on_record(level::level_enum, log_clock::time_point, string_view_t) and free their slots.
+    // return the number of records passed.
+    template <typename OnRecord>
+    size_t drain(OnRecord &&on_record, size_t max_records) {
+        size_t count = 0;
+        uint64_t h = hdr_->head.load(std::memory_order_relaxed);
+        while (count < max_records) {
+            auto *s = slot_(h);
+            uint64_t seq = s->seq.load(std::memory_order_acquire);
+            const uint64_t next_lap = 2 * (h + slot_count_);
+            if (seq == 2 * h + 2) {
+                auto time = log_clock::time_point(std::chrono::duration_cast<log_clock::duration>(
+                    std::chrono::nanoseconds(s->time)));
+                on_record(static_cast<level::level_enum>(s->level), time,
+                          string_view_t(slot_data_(s), s->size));
+                s->seq.store(next_lap, std::memory_order_release);
+                hdr_->head.store(++h, std::memory_order_release);
+                count++;
+                continue;
+            }
+            if (seq == next_lap) {
+                // consumed by a collector that stopped before moving the head
+                hdr_->head.store(++h, std::memory_order_release);
+                continue;
+            }
+            if (hdr_->tail.load(std::memory_order_acquire) <= h) {
+                break;  // empty
+            }
+            // claimed but not written yet
+            auto now = log_clock::now();
+            if (stale_ticket_ != h) {
+                stale_ticket_ = h;
+                stale_since_ = now;
+            }
+            bool dead = now - stale_since_ > stale_timeout_;
+            if (dead && (seq & 1)) {
+                auto pid = static_cast<pid_t>(seq >> 1);
+                dead = ::kill(pid, 0) != 0 && errno == ESRCH;
+            }
+            if (!dead ||
+                !s->seq.compare_exchange_strong(seq, next_lap, std::memory_order_acq_rel)) {
+                break;
+            }
+            hdr_->skipped.fetch_add(1, std::memory_order_relaxed);
+            hdr_->head.store(++h, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // how long a claimed ticket may stay unwritten before the consumer skips it (see above)
+    void set_stale_timeout(std::chrono::milliseconds timeout) { stale_timeout_ = timeout; }
+
+    const std::string &name() const { return name_; }
+    size_t slot_count() const { return slot_count_; }
+    size_t slot_size() const { return slot_size_; }
+
+    // the largest record that fits in a slot
+    size_t max_record_size() const { return slot_size_ - sizeof(slot_header); }
+
+    // number of records in the ring (approximate while producers are active)
+    size_t size() const {
+        auto head = hdr_->head.load(std::memory_order_relaxed);
+        auto tail = hdr_->tail.load(std::memory_order_relaxed);
+        return tail > head ? static_cast<size_t>(tail - head) : 0;
+    }
+
+    size_t dropped() const {
+        return static_cast<size_t>(hdr_->dropped.load(std::memory_order_relaxed));
+    }
+
+    size_t skipped() const {
+        return static_cast<size_t>(hdr_->skipped.load(std::memory_order_relaxed));
+    }
+
+private:
+    std::string name_;
+    void *map_ = nullptr;
+    size_t map_size_ = 0;
+    ring_header *hdr_ = nullptr;
+    char *slots_ = nullptr;
+    size_t slot_count_ = 0;
+    size_t slot_size_ = 0;
+    std::chrono::milliseconds stale_timeout_{1000};
+    uint64_t stale_ticket_ = static_cast<uint64_t>(-1);
+    log_clock::time_point stale_since_;
+
+    slot_header *slot_(uint64_t ticket) const {
+        return reinterpret_cast<slot_header *>(slots_ + (ticket % slot_count_) * slot_size_);
+    }
+
+    static char *slot_data_(slot_header *s) { return reinterpret_cast<char *>(s + 1); }
+
+    // wait until the slot is free for ticket t and mark it as being written.
+    // return false if the consumer skipped the ticket.
+    bool acquire_slot_(slot_header *s, uint64_t t, uint64_t writing) {
+        for (unsigned spins = 0;; spins++) {
+            uint64_t seq = s->seq.load(std::memory_order_acquire);
+            if (seq == 2 * t) {
+                if (s->seq.compare_exchange_weak(seq, writing, std::memory_order_acquire,
+                                                 std::memory_order_relaxed)) {
+                    return true;
+                }
+                continue;
+            }
+            if ((seq & 1) == 0 && seq > 2 * t) {
+                return false;
+            }
+            // the slot still holds the previous lap's record: the ring is full
+            if (spins < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+
+    bool map_fd_(int fd, size_t size) {
+        void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        map_ = p;
+        map_size_ = size;
+        hdr_ = static_cast<ring_header *>(p);
+        slots_ = static_cast<char *>(p) + header_size;
+        return true;
+    }
+
+    // size and initialize a new ring. return an error message on failure.
+    const char *create_(int fd, size_t slot_count, size_t slot_size) {
+        size_t size = header_size + slot_count * slot_size;
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            return "ftruncate failed for";
+        }
+        if (!map_fd_(fd, size)) {
+            return "mmap failed for";
+        }
+        slot_count_ = slot_count;
+        slot_size_ = slot_size;
+        auto *h = new (map_) ring_header{};
+        h->magic = magic;
+        h->version = version;
+        h->slot_count = slot_count;
+        h->slot_size = slot_size;
+        for (size_t i = 0; i < slot_count; i++) {
+            new (slot_(i)) slot_header{};
+            slot_(i)->seq.store(2 * i, std::memory_order_relaxed);
+        }
+        h->ready.store(1, std::memory_order_release);
+        return nullptr;
+    }
+
+    // map a ring created by another process, waiting a bit for it to be initialized.
+    // return an error message on failure.
+    const char *attach_(int fd) {
+        for (int i = 0;; i++) {
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= header_size) {
+                if (map_ == nullptr && !map_fd_(fd, static_cast<size_t>(st.st_size))) {
+                    return "mmap failed for";
+                }
+                if (hdr_->ready.load(std::memory_order_acquire) == 1) {
+                    break;
+                }
+            }
+            if (i == 1000) {
+                return "timed out waiting for the initialization of";
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (hdr_->magic != magic || hdr_->version != version || hdr_->slot_count < 2 ||
+            header_size + hdr_->slot_count * hdr_->slot_size > map_size_) {
+            errno = 0;
+            return "not a valid ring:";
+        }
+        slot_count_ = static_cast<size_t>(hdr_->slot_count);
+        slot_size_ = static_cast<size_t>(hdr_->slot_size);
+        return nullptr;
+    }
+};
+
+}  // namespace details
+}  // namespace spdlog
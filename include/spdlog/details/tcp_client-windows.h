@@ -8,6 +8,7 @@
 #include <spdlog/common.h>
 #include <spdlog/details/os.h>
 
+#include <chrono>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
@@ -58,8 +59,22 @@ public:
 
     SOCKET fd() const { return socket_; }
 
-    // try to connect or throw on failure
-    void connect(const std::string &host, int port) {
+    // make send() fail if it blocks longer than the given timeout (zero - block forever).
+    // must be called after connect().
+    void set_send_timeout(std::chrono::milliseconds timeout) {
+        DWORD ms = static_cast<DWORD>(timeout.count());
+        ::setsockopt(socket_, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char *>(&ms),
+                     sizeof(ms));
+    }
+
+    // number of bytes written but not yet acknowledged by the server (0 if unknown)
+    size_t outstanding_bytes() const { return 0; }
+
+    // try to connect or throw on failure.
+    // timeout: give up on an address after this long (zero - the system's connect timeout).
+    void connect(const std::string &host,
+                 int port,
+                 std::chrono::milliseconds timeout = std::chrono::milliseconds::zero()) {
         if (is_connected()) {
             close();
         }
@@ -90,7 +105,7 @@ public:
                 WSACleanup();
                 continue;
             }
-            if (::connect(socket_, rp->ai_addr, (int)rp->ai_addrlen) == 0) {
+            if (connect_(rp->ai_addr, (int)rp->ai_addrlen, timeout) == 0) {
                 break;
             } else {
                 last_error = ::WSAGetLastError();
@@ -130,6 +145,47 @@ public:
             bytes_sent += static_cast<size_t>(write_result);
         }
     }
+
+private:
+    // connect socket_, waiting at most timeout (unless zero).
+    // return 0, or SOCKET_ERROR with the error in WSAGetLastError().
+    int connect_(const sockaddr *addr, int addrlen, std::chrono::milliseconds timeout) {
+        if (timeout.count() <= 0) {
+            return ::connect(socket_, addr, addrlen);
+        }
+        u_long non_blocking = 1;
+        ::ioctlsocket(socket_, FIONBIO, &non_blocking);
+        int rv = ::connect(socket_, addr, addrlen);
+        if (rv != 0 && ::WSAGetLastError() == WSAEWOULDBLOCK) {
+            fd_set write_set, error_set;
+            FD_ZERO(&write_set);
+            FD_ZERO(&error_set);
+            FD_SET(socket_, &write_set);
+            FD_SET(socket_, &error_set);
+            auto ms = timeout.count();
+            timeval tv{};
+            tv.tv_sec = static_cast<long>(ms / 1000);
+            tv.tv_usec = static_cast<long>((ms % 1000) * 1000);
+            int ready = ::select(0, nullptr, &write_set, &error_set, &tv);
+            int err = 0;
+            int len = sizeof(err);
+            if (ready == 0) {
+                err = WSAETIMEDOUT;
+            } else if (ready == SOCKET_ERROR) {
+                err = ::WSAGetLastError();
+            } else if (::getsockopt(socket_, SOL_SOCKET, SO_ERROR, reinterpret_cast<char *>(&err),
+                                    &len) != 0) {
+                err = ::WSAGetLastError();
+            }
+            rv = err == 0 ? 0 : SOCKET_ERROR;
+            ::WSASetLastError(err);
+        }
+        if (rv == 0) {
+            u_long blocking = 0;
+            ::ioctlsocket(socket_, FIONBIO, &blocking);
+        }
+        return rv;
+    }
 };
 }  // namespace details
 }  // namespace spdlog
@@ -12,12 +12,20 @@
 #include <spdlog/details/os.h>
 
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#if defined(__linux__)
+    #include <linux/sockios.h>
+#endif
 
+#include <cerrno>
+#include <chrono>
 #include <string>
 
 namespace spdlog {
@@ -39,8 +47,32 @@ public:
 
     ~tcp_client() { close(); }
 
-    // try to connect or throw on failure
-    void connect(const std::string &host, int port) {
+    // make send() fail if it blocks longer than the given timeout (zero - block forever).
+    // must be called after connect().
+    void set_send_timeout(std::chrono::milliseconds timeout) {
+        auto ms = timeout.count();
+        struct timeval tv {};
+        tv.tv_sec = static_cast<decltype(tv.tv_sec)>(ms / 1000);
+        tv.tv_usec = static_cast<decltype(tv.tv_usec)>((ms % 1000) * 1000);
+        ::setsockopt(socket_, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<char *>(&tv), sizeof(tv));
+    }
+
+    // number of bytes written but not yet acknowledged by the server (0 if unknown)
+    size_t outstanding_bytes() const {
+#if defined(SIOCOUTQ)
+        int outq = 0;
+        if (is_connected() && ::ioctl(socket_, SIOCOUTQ, &outq) == 0 && outq > 0) {
+            return static_cast<size_t>(outq);
+        }
+#endif
+        return 0;
+    }
+
+    // try to connect or throw on failure.
+    // timeout: give up on an address after this long (zero - the system's connect timeout).
+    void connect(const std::string &host,
+                 int port,
+                 std::chrono::milliseconds timeout = std::chrono::milliseconds::zero()) {
         close();
         struct addrinfo hints {};
         memset(&hints, 0, sizeof(struct addrinfo));
@@ -69,7 +101,7 @@ public:
                 last_errno = errno;
                 continue;
             }
-            rv = ::connect(socket_, rp->ai_addr, rp->ai_addrlen);
+            rv = connect_(rp->ai_addr, rp->ai_addrlen, timeout);
             if (rv == 0) {
                 break;
             }
@@ -122,6 +154,42 @@ public:
             bytes_sent += static_cast<size_t>(write_result);
         }
     }
+
+private:
+    // connect(2) socket_, waiting at most timeout (unless zero).
+    // return 0, or -1 with errno set.
+    int connect_(const sockaddr *addr, socklen_t addrlen, std::chrono::milliseconds timeout) {
+        if (timeout.count() <= 0) {
+            return ::connect(socket_, addr, addrlen);
+        }
+        const int flags = ::fcntl(socket_, F_GETFL, 0);
+        ::fcntl(socket_, F_SETFL, flags | O_NONBLOCK);
+        int rv = ::connect(socket_, addr, addrlen);
+        if (rv != 0 && errno == EINPROGRESS) {
+            pollfd pfd{};
+            pfd.fd = socket_;
+            pfd.events = POLLOUT;
+            int ready;
+            do {
+                ready = ::poll(&pfd, 1, static_cast<int>(timeout.count()));
+            } while (ready < 0 && errno == EINTR);
+            int err = 0;
+            socklen_t len = sizeof(err);
+            if (ready == 0) {
+                err = ETIMEDOUT;
+            } else if (ready < 0) {
+                err = errno;
+            } else if (::getsockopt(socket_, SOL_SOCKET, SO_ERROR, &err, &len) != 0) {
+                err = errno;
+            }
+            rv = err == 0 ? 0 : -1;
+            errno = err;
+        }
+        if (rv == 0) {
+            ::fcntl(socket_, F_SETFL, flags);
+        }
+        return rv;
+    }
 };
 }  // namespace details
 }  // namespace spdlog
@@ -0,0 +1,92 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Per thread clones of sink formatters, so sinks can format messages without holding their mutex.
+// Each formatter installed in a sink gets a process wide unique id. A thread keeps the clones it
+// made in a cache keyed by that id, so a clone of a replaced formatter (or of a destroyed sink)
+// is never found again and eventually gets evicted.
+// The cache grows with the number of sinks the thread formats for, up to max_entries, and then
+// evicts the least recently used clone.
+
+#include <spdlog/common.h>
+#include <spdlog/formatter.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace spdlog {
+namespace details {
+
+class thread_formatters {
+public:
+    static constexpr size_t max_entries = 64;
+
+    // new id for a formatter that was just installed in a sink
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> last_id{0};
+        return last_id.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+#ifndef SPDLOG_NO_TLS
+    // the calling thread's clone of the formatter with the given id, or nullptr if it has none
+    static formatter *find(uint64_t id) {
+        auto &c = cache_();
+        for (auto &e : c.entries) {
+            if (e.id == id) {
+                e.last_use = ++c.clock;
+                return e.clone.get();
+            }
+        }
+        return nullptr;
+    }
+
+    // keep the given clone for the calling thread, replacing the least recently used one if the
+    // cache is full
+    static formatter *insert(uint64_t id, std::unique_ptr<formatter> clone) {
+        auto &c = cache_();
+        entry *e;
+        if (c.entries.size() < max_entries) {
+            c.entries.emplace_back();
+            e = &c.entries.back();
+        } else {
+            e = &c.entries.front();
+            for (auto &candidate : c.entries) {
+                if (candidate.last_use < e->last_use) {
+                    e = &candidate;
+                }
+            }
+        }
+        e->id = id;
+        e->last_use = ++c.clock;
+        e->clone = std::move(clone);
+        return e->clone.get();
+    }
+
+    // number of clones kept by the calling thread
+    static size_t size() { return cache_().entries.size(); }
+
+private:
+    struct entry {
+        uint64_t id = 0;
+        uint64_t last_use = 0;
+        std::unique_ptr<formatter> clone;
+    };
+
+    struct cache {
+        std::vector<entry> entries;
+        uint64_t clock = 0;
+    };
+
+    static cache &cache_() {
+        static thread_local cache c;
+        return c;
+    }
+#endif
+};
+
+}  // namespace details
+}  // namespace spdlog
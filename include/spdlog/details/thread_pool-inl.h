@@ -7,6 +7,7 @@
     #include <spdlog/details/thread_pool.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <spdlog/common.h>
 
@@ -15,23 +16,40 @@ namespace details {
 
 SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items,
                                        size_t threads_n,
+                                       const queue_memory_options &mem_options,
                                        std::function<void()> on_thread_start,
                                        std::function<void()> on_thread_stop)
-    : q_(q_max_items) {
+    : q_max_items_(q_max_items),
+      threads_n_(threads_n),
+      on_thread_start_(std::move(on_thread_start)),
+      on_thread_stop_(std::move(on_thread_stop)),
+      mem_options_(mem_options) {
     if (threads_n == 0 || threads_n > 1000) {
         throw_spdlog_ex(
             "spdlog::thread_pool(): invalid threads_n param (valid "
             "range is 1-1000)");
     }
-    for (size_t i = 0; i < threads_n; i++) {
-        threads_.emplace_back([this, on_thread_start, on_thread_stop] {
-            on_thread_start();
-            this->thread_pool::worker_loop_();
-            on_thread_stop();
-        });
+    if (mem_options_.prefault) {
+        start_();
     }
 }
 
+SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items,
+                                       size_t threads_n,
+                                       const queue_memory_options &mem_options)
+    : thread_pool(
+          q_max_items, threads_n, mem_options, [] {}, [] {}) {}
+
+SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items,
+                                       size_t threads_n,
+                                       std::function<void()> on_thread_start,
+                                       std::function<void()> on_thread_stop)
+    : thread_pool(q_max_items,
+                  threads_n,
+                  queue_memory_options{},
+                  std::move(on_thread_start),
+                  std::move(on_thread_stop)) {}
+
 SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items,
                                        size_t threads_n,
                                        std::function<void()> on_thread_start)
@@ -43,7 +61,12 @@ SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n)
 
 // message all threads to terminate gracefully join them
 SPDLOG_INLINE thread_pool::~thread_pool() {
+    batch_sweeper_.reset();
+    if (!started()) {
+        return;
+    }
     SPDLOG_TRY {
+        publish_batches_(false, true);
         for (size_t i = 0; i < threads_.size(); i++) {
             post_async_msg_(async_msg(async_msg_type::terminate), async_overflow_policy::block);
         }
@@ -55,41 +78,341 @@ SPDLOG_INLINE thread_pool::~thread_pool() {
     SPDLOG_CATCH_STD
 }
 
+SPDLOG_INLINE void sequence_stamp::operator()(async_msg &msg) const {
+    if (msg.msg_type == async_msg_type::log) {
+        msg.sequence = ++msg.worker_ptr->enqueued_sequence_;
+    }
+}
+
+SPDLOG_INLINE void sequence_stamp::operator()(ring_msg &msg) const {
+    if (msg.msg_type == async_msg_type::log) {
+        msg.sequence = ++msg.worker_ptr->enqueued_sequence_;
+    }
+}
+
 void SPDLOG_INLINE thread_pool::post_log(async_logger_ptr &&worker_ptr,
                                          const details::log_msg &msg,
                                          async_overflow_policy overflow_policy) {
+    if (mem_options_.ring_bytes != 0 && batch_size_.load(std::memory_order_relaxed) == 0) {
+        // straight to the ring, without making an async_msg copy first
+        if (!started()) {
+            start_();
+        }
+        enqueue_ring_(ring_msg(std::move(worker_ptr), async_msg_type::log, msg), msg.logger_name,
+                      msg.payload, overflow_policy);
+        return;
+    }
     async_msg async_m(std::move(worker_ptr), async_msg_type::log, msg);
     post_async_msg_(std::move(async_m), overflow_policy);
 }
 
+void SPDLOG_INLINE thread_pool::post_log(async_logger_ptr &&worker_ptr,
+                                         const details::log_msg &msg,
+                                         const external_payload &payload,
+                                         async_overflow_policy overflow_policy) {
+    if (mem_options_.ring_bytes != 0 && batch_size_.load(std::memory_order_relaxed) == 0) {
+        if (!started()) {
+            start_();
+        }
+        enqueue_ring_(ring_msg(std::move(worker_ptr), async_msg_type::log, msg, payload),
+                      msg.logger_name, string_view_t{}, overflow_policy);
+        return;
+    }
+    async_msg async_m(std::move(worker_ptr), async_msg_type::log, msg, payload);
+    post_async_msg_(std::move(async_m), overflow_policy);
+}
+
 std::future<void> SPDLOG_INLINE thread_pool::post_flush(async_logger_ptr &&worker_ptr,
                                                         async_overflow_policy overflow_policy) {
     std::promise<void> promise;
     std::future<void> future = promise.get_future();
+    publish_batches_(false);
+    if (!started()) {
+        std::lock_guard<std::mutex> lock(start_mutex_);
+        if (q_ == nullptr && ring_ == nullptr) {
+            // nothing was posted yet: flush the sinks here rather than starting the threads.
+            // holding start_mutex_ keeps worker threads from touching the sinks meanwhile.
+            worker_ptr->backend_flush_();
+            promise.set_value();
+            return future;
+        }
+    }
     post_async_msg_(async_msg(std::move(worker_ptr), async_msg_type::flush, std::move(promise)),
                     overflow_policy);
     return future;
 }
 
-size_t SPDLOG_INLINE thread_pool::overrun_counter() { return q_.overrun_counter(); }
+size_t SPDLOG_INLINE thread_pool::overrun_counter() {
+    if (!started()) {
+        return 0;
+    }
+    return ring_ ? ring_->overrun_counter() : q_->overrun_counter();
+}
+
+void SPDLOG_INLINE thread_pool::reset_overrun_counter() {
+    if (started()) {
+        ring_ ? ring_->reset_overrun_counter() : q_->reset_overrun_counter();
+    }
+}
+
+size_t SPDLOG_INLINE thread_pool::discard_counter() {
+    if (!started()) {
+        return 0;
+    }
+    return ring_ ? ring_->discard_counter() : q_->discard_counter();
+}
 
-void SPDLOG_INLINE thread_pool::reset_overrun_counter() { q_.reset_overrun_counter(); }
+void SPDLOG_INLINE thread_pool::reset_discard_counter() {
+    if (started()) {
+        ring_ ? ring_->reset_discard_counter() : q_->reset_discard_counter();
+    }
+}
 
-size_t SPDLOG_INLINE thread_pool::discard_counter() { return q_.discard_counter(); }
+size_t SPDLOG_INLINE thread_pool::queue_size() {
+    if (!started()) {
+        return 0;
+    }
+    return ring_ ? ring_->size() : q_->size();
+}
 
-void SPDLOG_INLINE thread_pool::reset_discard_counter() { q_.reset_discard_counter(); }
+void SPDLOG_INLINE thread_pool::start_() {
+    std::lock_guard<std::mutex> lock(start_mutex_);
+    if (q_ != nullptr || ring_ != nullptr) {
+        return;
+    }
+    if (mem_options_.ring_bytes != 0) {
+        ring_ = details::make_unique<ring_type>(mem_options_.ring_bytes, mem_options_);
+    } else {
+        q_ = details::make_unique<q_type>(q_max_items_, mem_options_);
+    }
+    // messages posted from now on wait in the queue until the threads are up
+    started_.store(true, std::memory_order_release);
+    for (size_t i = 0; i < threads_n_; i++) {
+        threads_.emplace_back([this] {
+            on_thread_start_();
+            this->thread_pool::worker_loop_();
+            on_thread_stop_();
+        });
+    }
+}
+
+void SPDLOG_INLINE thread_pool::set_producer_batching(size_t batch_size,
+                                                     std::chrono::milliseconds linger) {
+#ifdef SPDLOG_NO_TLS
+    if (batch_size > 1) {
+        throw_spdlog_ex("thread_pool: producer batching requires thread local storage");
+    }
+#else
+    batch_sweeper_.reset();
+    publish_batches_(false);
+    {
+        std::lock_guard<std::mutex> lock(batches_mutex_);
+        linger_ = linger;
+        batch_size_.store(batch_size > 1 ? batch_size : 0, std::memory_order_relaxed);
+    }
+    if (batch_size > 1) {
+        batch_sweeper_ = details::make_unique<periodic_worker>(
+            [this] { this->publish_batches_(true); }, linger);
+    }
+#endif
+}
 
-size_t SPDLOG_INLINE thread_pool::queue_size() { return q_.size(); }
+void SPDLOG_INLINE thread_pool::set_parallel_formatting(bool enabled) {
+    std::lock_guard<std::mutex> start_lock(start_mutex_);
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+    if (enabled == (ordered_from_.load(std::memory_order_relaxed) != UINT64_MAX)) {
+        return;
+    }
+    if (enabled) {
+        if (slots_.empty()) {
+            // enough to keep all threads formatting while the oldest message is written
+            slots_.resize(threads_n_ * 32);
+        }
+        // the messages of an earlier parallel period must be written before next_commit_ moves
+        commit_cv_.wait(lock, [this] { return next_commit_ == ordered_until_; });
+    }
+    auto update = [this, enabled](uint64_t dequeued) {
+        if (enabled) {
+            ordered_period_++;
+            next_commit_ = dequeued;
+            ordered_from_.store(dequeued, std::memory_order_relaxed);
+        } else {
+            ordered_until_ = dequeued;
+            ordered_from_.store(UINT64_MAX, std::memory_order_relaxed);
+        }
+    };
+    if (q_) {
+        q_->with_dequeued_count(update);
+    } else if (ring_) {
+        ring_->with_taken_count(update);
+    } else {
+        update(0);  // not started
+    }
+}
 
 void SPDLOG_INLINE thread_pool::post_async_msg_(async_msg &&new_msg,
                                                 async_overflow_policy overflow_policy) {
+    if (!started()) {
+        start_();
+    }
+#ifndef SPDLOG_NO_TLS
+    if (new_msg.msg_type == async_msg_type::log &&
+        batch_size_.load(std::memory_order_relaxed) != 0) {
+        batch_msg_(std::move(new_msg), overflow_policy);
+        return;
+    }
+#endif
+    enqueue_(std::move(new_msg), overflow_policy);
+}
+
+void SPDLOG_INLINE thread_pool::enqueue_(async_msg &&new_msg,
+                                         async_overflow_policy overflow_policy) {
+    if (ring_) {
+        // the payload is copied to the ring (and an external one released with new_msg)
+        ring_msg header(std::move(new_msg.worker_ptr), new_msg.msg_type, new_msg);
+        if (new_msg.msg_type == async_msg_type::flush) {
+            header.flush_promise =
+                details::make_unique<std::promise<void>>(std::move(new_msg.flush_promise));
+        }
+        enqueue_ring_(std::move(header), new_msg.logger_name, new_msg.payload, overflow_policy);
+        return;
+    }
+    if (overflow_policy == async_overflow_policy::block) {
+        q_->enqueue(std::move(new_msg));
+    } else if (overflow_policy == async_overflow_policy::overrun_oldest) {
+        q_->enqueue_nowait(std::move(new_msg));
+    } else {
+        assert(overflow_policy == async_overflow_policy::discard_new);
+        q_->enqueue_if_have_room(std::move(new_msg));
+    }
+}
+
+void SPDLOG_INLINE thread_pool::enqueue_ring_(ring_msg &&header,
+                                              string_view_t name,
+                                              string_view_t payload,
+                                              async_overflow_policy overflow_policy) {
     if (overflow_policy == async_overflow_policy::block) {
-        q_.enqueue(std::move(new_msg));
+        ring_->enqueue(std::move(header), {name, payload});
     } else if (overflow_policy == async_overflow_policy::overrun_oldest) {
-        q_.enqueue_nowait(std::move(new_msg));
+        ring_->enqueue_nowait(std::move(header), {name, payload});
     } else {
         assert(overflow_policy == async_overflow_policy::discard_new);
-        q_.enqueue_if_have_room(std::move(new_msg));
+        ring_->enqueue_if_have_room(std::move(header), {name, payload});
+    }
+}
+
+#ifndef SPDLOG_NO_TLS
+void SPDLOG_INLINE thread_pool::batch_msg_(async_msg &&new_msg,
+                                           async_overflow_policy overflow_policy) {
+    auto &batch = thread_batch_();
+    std::lock_guard<std::mutex> lock(batch.mutex);
+    if (batch.msgs.empty()) {
+        batch.oldest = std::chrono::steady_clock::now();
+    }
+    batch.msgs.push_back(std::move(new_msg));
+    batch.policies.push_back(overflow_policy);
+    if (batch.msgs.size() >= batch_size_.load(std::memory_order_relaxed)) {
+        publish_(batch);
+    }
+}
+
+SPDLOG_INLINE producer_batch &thread_pool::thread_batch_() {
+    // the batches of the calling thread (one per pool it logged to).
+    // published when the thread exits.
+    struct thread_batches {
+        std::vector<std::shared_ptr<producer_batch>> list;
+
+        ~thread_batches() {
+            for (auto &batch : list) {
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                auto *pool = batch->pool.load();
+                if (pool != nullptr) {
+                    SPDLOG_TRY { pool->publish_(*batch); }
+                    SPDLOG_CATCH_STD
+                }
+                batch->thread_exited = true;
+            }
+        }
+    };
+    static thread_local thread_batches batches;
+
+    for (auto &batch : batches.list) {
+        if (batch->pool.load(std::memory_order_relaxed) == this) {
+            return *batch;
+        }
+    }
+
+    // forget the batches of destroyed pools
+    batches.list.erase(std::remove_if(batches.list.begin(), batches.list.end(),
+                                      [](const std::shared_ptr<producer_batch> &batch) {
+                                          return batch->pool.load() == nullptr;
+                                      }),
+                       batches.list.end());
+
+    auto batch = std::make_shared<producer_batch>();
+    batch->pool.store(this);
+    batch->msgs.reserve(batch_size_.load(std::memory_order_relaxed));
+    batch->policies.reserve(batch->msgs.capacity());
+    {
+        std::lock_guard<std::mutex> lock(batches_mutex_);
+        batches_.push_back(batch);
+    }
+    batches.list.push_back(batch);
+    return *batch;
+}
+#endif
+
+void SPDLOG_INLINE thread_pool::publish_(producer_batch &batch) {
+    auto &msgs = batch.msgs;
+    auto &policies = batch.policies;
+    if (ring_) {
+        // no bulk enqueue into the ring
+        for (size_t i = 0; i < msgs.size(); i++) {
+            enqueue_(std::move(msgs[i]), policies[i]);
+        }
+        msgs.clear();
+        policies.clear();
+        return;
+    }
+    // enqueue each run of messages with the same overflow policy at once
+    size_t begin = 0;
+    while (begin < msgs.size()) {
+        size_t end = begin + 1;
+        while (end < msgs.size() && policies[end] == policies[begin]) {
+            end++;
+        }
+        auto first = msgs.begin() + static_cast<std::ptrdiff_t>(begin);
+        auto last = msgs.begin() + static_cast<std::ptrdiff_t>(end);
+        if (policies[begin] == async_overflow_policy::block) {
+            q_->enqueue_bulk(first, last);
+        } else if (policies[begin] == async_overflow_policy::overrun_oldest) {
+            q_->enqueue_bulk_nowait(first, last);
+        } else {
+            q_->enqueue_bulk_if_have_room(first, last);
+        }
+        begin = end;
+    }
+    msgs.clear();
+    policies.clear();
+}
+
+void SPDLOG_INLINE thread_pool::publish_batches_(bool only_lingering, bool detach) {
+    std::lock_guard<std::mutex> lock(batches_mutex_);
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = batches_.begin(); it != batches_.end();) {
+        bool forget;
+        {
+            auto &batch = **it;
+            std::lock_guard<std::mutex> batch_lock(batch.mutex);
+            if (!batch.msgs.empty() && (!only_lingering || now - batch.oldest >= linger_)) {
+                publish_(batch);
+            }
+            if (detach) {
+                batch.pool.store(nullptr);
+            }
+            forget = batch.thread_exited || detach;
+        }
+        it = forget ? batches_.erase(it) : it + 1;
     }
 }
 
@@ -102,11 +425,21 @@ void SPDLOG_INLINE thread_pool::worker_loop_() {
 // return true if this thread should still be active (while no terminate msg
 // was received)
 bool SPDLOG_INLINE thread_pool::process_next_msg_() {
+    if (ring_) {
+        return process_next_ring_msg_();
+    }
     async_msg incoming_async_msg;
-    q_.dequeue(incoming_async_msg);
+    uint64_t position;
+    q_->dequeue(incoming_async_msg, position);
+    if (position >= ordered_from_.load(std::memory_order_relaxed)) {
+        return process_ordered_msg_(std::move(incoming_async_msg), nullptr, position);
+    }
 
     switch (incoming_async_msg.msg_type) {
         case async_msg_type::log: {
+            if (threads_n_ == 1) {
+                incoming_async_msg.worker_ptr->backend_check_sequence_(incoming_async_msg);
+            }
             incoming_async_msg.worker_ptr->backend_sink_it_(incoming_async_msg);
             return true;
         }
@@ -128,5 +461,122 @@ bool SPDLOG_INLINE thread_pool::process_next_msg_() {
     return true;
 }
 
+// process the next record in the ring, in place
+bool SPDLOG_INLINE thread_pool::process_next_ring_msg_() {
+    uint64_t position;
+    auto *record = ring_->take(position);
+    if (position >= ordered_from_.load(std::memory_order_relaxed)) {
+        return process_ordered_msg_(async_msg{}, record, position);
+    }
+    auto &header = record->header;
+    bool active = true;
+    switch (header.msg_type) {
+        case async_msg_type::log: {
+            auto msg = header.to_log_msg(record->data());
+            if (threads_n_ == 1) {
+                header.worker_ptr->backend_check_sequence_(msg);
+            }
+            header.worker_ptr->backend_sink_it_(msg);
+            break;
+        }
+        case async_msg_type::flush: {
+            header.worker_ptr->backend_flush_();
+            header.flush_promise->set_value();
+            break;
+        }
+        case async_msg_type::terminate: {
+            active = false;
+            break;
+        }
+        default: {
+            assert(false);
+        }
+    }
+    ring_->release(record);
+    return active;
+}
+
+bool SPDLOG_INLINE thread_pool::process_ordered_msg_(async_msg &&msg,
+                                                    ring_type::record *record,
+                                                    uint64_t position) {
+    std::unique_lock<std::mutex> lock(commit_mutex_);
+    // wait for the slot to be free: the message slots_.size() positions before was written.
+    // the oldest message not written yet never waits, so neither do the following ones for long.
+    commit_cv_.wait(lock, [this, position] { return position - next_commit_ < slots_.size(); });
+    auto &slot = slots_[position % slots_.size()];
+    lock.unlock();
+
+    // the slot is this thread's until marked ready
+    slot.msg = std::move(msg);
+    slot.record = record;
+    auto msg_type = record != nullptr ? record->header.msg_type : slot.msg.msg_type;
+    if (msg_type == async_msg_type::log) {
+        if (record != nullptr) {
+            record->header.worker_ptr->backend_format_(
+                record->header.to_log_msg(record->data()), slot.outputs);
+        } else {
+            slot.msg.worker_ptr->backend_format_(slot.msg, slot.outputs);
+        }
+    }
+
+    lock.lock();
+    slot.ready = true;
+    if (committing_) {
+        return msg_type != async_msg_type::terminate;
+    }
+    committing_ = true;
+    for (;;) {
+        auto &next = slots_[next_commit_ % slots_.size()];
+        if (!next.ready) {
+            break;
+        }
+        lock.unlock();
+        commit_(next);
+        lock.lock();
+        next.ready = false;
+        next_commit_++;
+        commit_cv_.notify_all();
+    }
+    committing_ = false;
+    return msg_type != async_msg_type::terminate;
+}
+
+void SPDLOG_INLINE thread_pool::commit_(ordered_slot &slot) {
+    if (slot.record != nullptr) {
+        auto &header = slot.record->header;
+        if (header.msg_type == async_msg_type::log) {
+            auto msg = header.to_log_msg(slot.record->data());
+            commit_check_sequence_(*header.worker_ptr, msg);
+            header.worker_ptr->backend_sink_formatted_(msg, slot.outputs);
+        } else if (header.msg_type == async_msg_type::flush) {
+            header.worker_ptr->backend_flush_();
+            header.flush_promise->set_value();
+        }
+        ring_->release(slot.record);
+        slot.record = nullptr;
+        return;
+    }
+    if (slot.msg.msg_type == async_msg_type::log) {
+        commit_check_sequence_(*slot.msg.worker_ptr, slot.msg);
+        slot.msg.worker_ptr->backend_sink_formatted_(slot.msg, slot.outputs);
+    } else if (slot.msg.msg_type == async_msg_type::flush) {
+        slot.msg.worker_ptr->backend_flush_();
+        slot.msg.flush_promise.set_value();
+    }
+    // don't keep the logger alive until the slot is reused
+    slot.msg.worker_ptr.reset();
+}
+
+void SPDLOG_INLINE thread_pool::commit_check_sequence_(async_logger &logger,
+                                                       const log_msg &msg) {
+    if (threads_n_ > 1 && logger.backend_period_ != ordered_period_) {
+        // the logger's messages were not checked since the last parallel period (several threads
+        // process them in any order otherwise): start over from this one
+        logger.backend_period_ = ordered_period_;
+        logger.backend_sequence_ = msg.sequence - 1;
+    }
+    logger.backend_check_sequence_(msg);
+}
+
 }  // namespace details
 }  // namespace spdlog
@@ -5,12 +5,18 @@
 
 #include <spdlog/details/log_msg_buffer.h>
 #include <spdlog/details/mpmc_blocking_q.h>
+#include <spdlog/details/mpmc_byte_ring.h>
 #include <spdlog/details/os.h>
+#include <spdlog/details/periodic_worker.h>
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <future>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -61,6 +67,16 @@ struct async_msg : log_msg_buffer {
           worker_ptr{std::move(worker)},
           flush_promise{} {}
 
+    // construct from log_msg whose payload is external (not copied)
+    async_msg(async_logger_ptr &&worker,
+              async_msg_type the_type,
+              const details::log_msg &m,
+              const external_payload &payload)
+        : log_msg_buffer{m, payload},
+          msg_type{the_type},
+          worker_ptr{std::move(worker)},
+          flush_promise{} {}
+
     async_msg(async_logger_ptr &&worker, async_msg_type the_type)
         : log_msg_buffer{},
           msg_type{the_type},
@@ -77,10 +93,119 @@ struct async_msg : log_msg_buffer {
         : async_msg{nullptr, the_type} {}
 };
 
+// Async msg header in the byte ring (see queue_memory_options::ring_bytes).
+// The logger name and the payload are stored right after it in the ring, unless the payload is
+// external.
+struct ring_msg {
+    async_msg_type msg_type{async_msg_type::log};
+    level::level_enum level{level::off};
+    size_t name_size{0};
+    log_clock::time_point time;
+    mono_clock::time_point mono_time;
+    size_t thread_id{0};
+    uint64_t sequence{0};
+    source_loc source;
+    async_logger_ptr worker_ptr;
+    std::unique_ptr<std::promise<void>> flush_promise;  // flush messages only
+    external_payload external{string_view_t{}};
+
+    ring_msg(async_logger_ptr &&worker, async_msg_type the_type, const details::log_msg &m)
+        : msg_type{the_type},
+          level{m.level},
+          name_size{m.logger_name.size()},
+          time{m.time},
+          mono_time{m.mono_time},
+          thread_id{m.thread_id},
+          sequence{m.sequence},
+          source{m.source},
+          worker_ptr{std::move(worker)} {}
+
+    ring_msg(async_logger_ptr &&worker,
+             async_msg_type the_type,
+             const details::log_msg &m,
+             const external_payload &payload)
+        : ring_msg{std::move(worker), the_type, m} {
+        external = payload;
+    }
+
+    ring_msg(const ring_msg &) = delete;
+    ring_msg &operator=(const ring_msg &) = delete;
+
+    ring_msg(ring_msg &&other) SPDLOG_NOEXCEPT : msg_type{other.msg_type},
+                                                 level{other.level},
+                                                 name_size{other.name_size},
+                                                 time{other.time},
+                                                 mono_time{other.mono_time},
+                                                 thread_id{other.thread_id},
+                                                 sequence{other.sequence},
+                                                 source{other.source},
+                                                 worker_ptr{std::move(other.worker_ptr)},
+                                                 flush_promise{std::move(other.flush_promise)},
+                                                 external{other.external} {
+        other.external.release = nullptr;
+    }
+
+    // release the external payload (if any)
+    ~ring_msg() {
+        if (external.release != nullptr) {
+            external.release(external.context);
+        }
+    }
+
+    // the message stored in the ring with the given data
+    details::log_msg to_log_msg(string_view_t data) const {
+        details::log_msg m;
+        m.logger_name = string_view_t(data.data(), name_size);
+        m.level = level;
+        m.time = time;
+        m.mono_time = mono_time;
+        m.thread_id = thread_id;
+        m.sequence = sequence;
+        m.source = source;
+        m.payload = external.data.data() != nullptr
+                        ? external.data
+                        : string_view_t(data.data() + name_size, data.size() - name_size);
+        return m;
+    }
+};
+
+// Stamps the next sequence number of the message's logger into each log message entering the
+// queue. Called under the queue lock, so each logger's messages are queued in sequence order and
+// the worker can tell the dropped ones (overrun or discarded) by the gaps. see async_logger.
+struct SPDLOG_API sequence_stamp {
+    void operator()(async_msg &msg) const;
+    void operator()(ring_msg &msg) const;
+};
+
+// A log message formatted by one of the logger's sinks, ahead of writing it
+// (see thread_pool::set_parallel_formatting()).
+struct sink_output {
+    bool formatted = false;  // false if the sink formats only when writing
+    memory_buf_t buf;
+};
+
+class thread_pool;
+
+// Messages collected by one producer thread for one thread pool
+// (see thread_pool::set_producer_batching()).
+struct producer_batch {
+    std::mutex mutex;
+    std::atomic<thread_pool *> pool{nullptr};  // nullptr once the pool is destroyed
+    bool thread_exited = false;
+    std::vector<async_msg> msgs;
+    std::vector<async_overflow_policy> policies;
+    std::chrono::steady_clock::time_point oldest;  // when the first of msgs was added
+};
+
+// The queue is allocated and the threads are started when the first message is posted, so a
+// thread pool that is never used costs next to nothing.
+// Unless the queue memory is to be prefaulted (see queue_memory_options), in which case both
+// happen at construction, so the first messages are as fast as the following ones.
 class SPDLOG_API thread_pool {
 public:
     using item_type = async_msg;
-    using q_type = details::mpmc_blocking_queue<item_type>;
+    using q_type = details::mpmc_blocking_queue<item_type, sequence_stamp>;
+    using ring_type = details::mpmc_byte_ring<ring_msg, sequence_stamp>;
 
     thread_pool(size_t q_max_items,
                 size_t threads_n,
@@ -88,6 +213,12 @@ public:
                 std::function<void()> on_thread_stop);
     thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start);
     thread_pool(size_t q_max_items, size_t threads_n);
+    thread_pool(size_t q_max_items,
+                size_t threads_n,
+                const queue_memory_options &mem_options,
+                std::function<void()> on_thread_start,
+                std::function<void()> on_thread_stop);
+    thread_pool(size_t q_max_items, size_t threads_n, const queue_memory_options &mem_options);
 
     // message all threads to terminate gracefully and join them
     ~thread_pool();
@@ -98,6 +229,11 @@ public:
     void post_log(async_logger_ptr &&worker_ptr,
                   const details::log_msg &msg,
                   async_overflow_policy overflow_policy);
+    // post a message whose payload is released once processed (or dropped)
+    void post_log(async_logger_ptr &&worker_ptr,
+                  const details::log_msg &msg,
+                  const external_payload &payload,
+                  async_overflow_policy overflow_policy);
     std::future<void> post_flush(async_logger_ptr &&worker_ptr,
                                  async_overflow_policy overflow_policy);
     size_t overrun_counter();
@@ -106,18 +242,103 @@ public:
     void reset_discard_counter();
     size_t queue_size();
 
+    // true once the queue was allocated and the threads were started
+    bool started() const { return started_.load(std::memory_order_acquire); }
+
+    // Producer side batching (off by default).
+    // Each producer thread collects up to batch_size log messages in a thread local buffer and
+    // moves them to the queue in a single operation when the buffer is full, when its oldest
+    // message is older than linger, when the thread exits, or when any logger of the pool is
+    // flushed. Messages of each thread keep their order.
+    // Should be called before logging starts. batch_size <= 1 disables batching.
+    // Requires thread local storage support.
+    void set_producer_batching(size_t batch_size,
+                               std::chrono::milliseconds linger = std::chrono::milliseconds(1));
+
+    // Parallel formatting (off by default).
+    // The threads of the pool format the log messages concurrently - also the ones of a single
+    // logger - and write them to the sinks one at a time, in queue order. So with several threads
+    // even one busy logger keeps its message order, and writing is not slowed by formatting.
+    // Only sinks that support formatting outside of their mutex (see base_sink::format_unlocked_)
+    // are formatted in parallel, the others format when writing. Flags that depend on the
+    // previous message (%o, %i, %u, %O, %K) are then relative to the previous message formatted
+    // by the same thread of the pool.
+    // Applies to the messages taken from the queue after the call (the ones already taken are
+    // written first when enabling).
+    void set_parallel_formatting(bool enabled);
+
 private:
-    q_type q_;
+    size_t q_max_items_;
+    size_t threads_n_;
+    std::function<void()> on_thread_start_;
+    std::function<void()> on_thread_stop_;
+    queue_memory_options mem_options_;
+
+    std::mutex start_mutex_;
+    std::atomic<bool> started_{false};
+    std::unique_ptr<q_type> q_;
+    std::unique_ptr<ring_type> ring_;  // instead of q_ if mem_options_.ring_bytes != 0
 
     std::vector<std::thread> threads_;
 
+    std::atomic<size_t> batch_size_{0};
+    std::chrono::milliseconds linger_{0};
+    std::mutex batches_mutex_;
+    std::vector<std::shared_ptr<producer_batch>> batches_;
+    std::unique_ptr<periodic_worker> batch_sweeper_;
+
+    // parallel formatting: the messages taken from the queue and not written yet, by their
+    // position in the dequeue order (modulo the number of slots).
+    struct ordered_slot {
+        bool ready = false;  // formatted, can be written
+        async_msg msg;
+        ring_type::record *record = nullptr;  // instead of msg if ring_
+        std::vector<sink_output> outputs;
+    };
+    // the messages from this position on are formatted in parallel (UINT64_MAX if disabled).
+    // set with the queue locked, so each message's position tells how to process it.
+    std::atomic<uint64_t> ordered_from_{UINT64_MAX};
+    std::mutex commit_mutex_;
+    std::condition_variable commit_cv_;
+    std::vector<ordered_slot> slots_;
+    uint64_t next_commit_ = 0;     // position of the next message to write
+    uint64_t ordered_until_ = 0;   // end of the positions formatted in parallel, once disabled
+    uint64_t ordered_period_ = 0;  // number of times parallel formatting was enabled
+    bool committing_ = false;   // a thread is writing the ready messages
+
+    // allocate the queue and start the threads (if not done already)
+    void start_();
     void post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy);
+    void enqueue_(async_msg &&new_msg, async_overflow_policy overflow_policy);
+    void enqueue_ring_(ring_msg &&header,
+                       string_view_t name,
+                       string_view_t payload,
+                       async_overflow_policy overflow_policy);
+
+#ifndef SPDLOG_NO_TLS
+    // add the message to the calling thread's batch
+    void batch_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy);
+    // the calling thread's batch for this pool
+    producer_batch &thread_batch_();
+#endif
+    // move the batch messages to the queue (batch mutex must be held)
+    void publish_(producer_batch &batch);
+    // publish the batches of all threads (only the ones older than linger_ if only_lingering).
+    // if detach, forget about the batches - the pool is going away.
+    void publish_batches_(bool only_lingering, bool detach = false);
     void worker_loop_();
 
     // process next message in the queue
     // return true if this thread should still be active (while no terminate msg
     // was received)
     bool process_next_msg_();
+    bool process_next_ring_msg_();
+    // format the message taken from the queue at the given position, then write it and the
+    // following ready ones, unless another thread is already writing
+    bool process_ordered_msg_(async_msg &&msg, ring_type::record *record, uint64_t position);
+    // write the message of the slot (commit mutex not held)
+    void commit_(ordered_slot &slot);
+    void commit_check_sequence_(async_logger &logger, const log_msg &msg);
 };
 
 }  // namespace details
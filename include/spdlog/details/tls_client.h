@@ -0,0 +1,271 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// TLS client helper over tcp_client, using OpenSSL.
+// Requires SPDLOG_OPENSSL to be defined and linking with OpenSSL (ssl, crypto).
+//
+// - The session of the last handshake is kept and offered on reconnect, so
+//   reconnects use an abbreviated handshake when the server supports resumption.
+// - If the kernel and OpenSSL (>= 3.0) support it, record encryption is
+//   offloaded to the kernel (kTLS).
+// Will throw on failure.
+
+#include <spdlog/common.h>
+#ifdef _WIN32
+    #include <spdlog/details/tcp_client-windows.h>
+#else
+    #include <spdlog/details/tcp_client.h>
+    #include <csignal>
+    #include <pthread.h>
+#endif
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#include <string>
+
+namespace spdlog {
+namespace details {
+
+struct tls_config {
+    std::string ca_file;      // CA bundle (PEM) to verify the server with. empty - system default
+    std::string cert_file;    // client certificate chain (PEM) for mutual TLS. optional
+    std::string key_file;     // client private key (PEM) for mutual TLS. optional
+    std::string server_name;  // name to verify and send as SNI. empty - use the server host
+    bool verify_peer = true;  // verify the server certificate and its name/ip
+    bool enable_ktls = true;  // use kernel TLS offload if available
+    size_t record_size = 16 * 1024;  // coalesce messages into records of up to this size
+};
+
+class tls_client {
+    tls_config config_;
+    tcp_client tcp_;
+    SSL_CTX *ctx_ = nullptr;
+    SSL *ssl_ = nullptr;
+    SSL_SESSION *session_ = nullptr;
+    bool session_reused_ = false;
+
+#if defined(__linux__)
+    // OpenSSL writes to the socket without MSG_NOSIGNAL.
+    // Block SIGPIPE while writing and discard it if the write raised it.
+    class sigpipe_guard {
+        sigset_t pipe_set_;
+        sigset_t old_set_;
+        bool was_pending_ = false;
+
+    public:
+        sigpipe_guard() {
+            sigemptyset(&pipe_set_);
+            sigaddset(&pipe_set_, SIGPIPE);
+            sigset_t pending;
+            sigemptyset(&pending);
+            sigpending(&pending);
+            was_pending_ = sigismember(&pending, SIGPIPE) == 1;
+            pthread_sigmask(SIG_BLOCK, &pipe_set_, &old_set_);
+        }
+
+        ~sigpipe_guard() {
+            if (!was_pending_) {
+                sigset_t pending;
+                sigemptyset(&pending);
+                sigpending(&pending);
+                if (sigismember(&pending, SIGPIPE) == 1) {
+                    struct timespec no_wait {};
+                    sigtimedwait(&pipe_set_, nullptr, &no_wait);
+                }
+            }
+            pthread_sigmask(SIG_SETMASK, &old_set_, nullptr);
+        }
+    };
+#else
+    struct sigpipe_guard {};
+#endif
+
+    static std::string last_ssl_error_() {
+        char buf[256];
+        ERR_error_string_n(ERR_get_error(), buf, sizeof(buf));
+        ERR_clear_error();
+        return buf;
+    }
+
+    [[noreturn]] static void throw_ssl_error_(const std::string &msg) {
+        throw_spdlog_ex(fmt_lib::format("tls_client - {}: {}", msg, last_ssl_error_()));
+    }
+
+    // close the connection and throw with the error that caused it
+    [[noreturn]] void close_and_throw_(const std::string &msg) {
+        auto err = last_ssl_error_();
+        close();
+        throw_spdlog_ex(fmt_lib::format("tls_client - {}: {}", msg, err));
+    }
+
+    // called by OpenSSL when the server hands us a new session (or ticket)
+    static int on_new_session_(SSL *ssl, SSL_SESSION *session) {
+        auto *self = static_cast<tls_client *>(SSL_get_app_data(ssl));
+        if (self->session_ != nullptr) {
+            SSL_SESSION_free(self->session_);
+        }
+        self->session_ = session;
+        return 1;  // we keep the reference
+    }
+
+    // TLS 1.3 servers send session tickets after the handshake. Since a log client
+    // never reads, process any pending incoming records here so tickets get stored.
+    void read_pending_records_() {
+        bool has_data;
+#ifdef _WIN32
+        u_long available = 0;
+        has_data = ::ioctlsocket(tcp_.fd(), FIONREAD, &available) == 0 && available > 0;
+#else
+        char c;
+        has_data = ::recv(tcp_.fd(), &c, 1, MSG_PEEK | MSG_DONTWAIT) > 0;
+#endif
+        if (has_data) {
+            char buf[256];
+            // SSL_MODE_AUTO_RETRY is off, so this returns after processing the records
+            // instead of blocking for application data.
+            if (SSL_read(ssl_, buf, sizeof(buf)) <= 0) {
+                ERR_clear_error();
+            }
+        }
+    }
+
+    void init_ctx_() {
+        ctx_ = SSL_CTX_new(TLS_client_method());
+        if (ctx_ == nullptr) {
+            throw_ssl_error_("SSL_CTX_new failed");
+        }
+        SSL_CTX_set_min_proto_version(ctx_, TLS1_2_VERSION);
+        SSL_CTX_set_session_cache_mode(ctx_,
+                                       SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(ctx_, on_new_session_);
+        SSL_CTX_clear_mode(ctx_, SSL_MODE_AUTO_RETRY);
+#ifdef SSL_OP_ENABLE_KTLS
+        if (config_.enable_ktls) {
+            SSL_CTX_set_options(ctx_, SSL_OP_ENABLE_KTLS);
+        }
+#endif
+        if (config_.verify_peer) {
+            SSL_CTX_set_verify(ctx_, SSL_VERIFY_PEER, nullptr);
+            int rv = config_.ca_file.empty()
+                         ? SSL_CTX_set_default_verify_paths(ctx_)
+                         : SSL_CTX_load_verify_locations(ctx_, config_.ca_file.c_str(), nullptr);
+            if (rv != 1) {
+                throw_ssl_error_("failed loading CA certificates");
+            }
+        }
+        if (!config_.cert_file.empty()) {
+            if (SSL_CTX_use_certificate_chain_file(ctx_, config_.cert_file.c_str()) != 1 ||
+                SSL_CTX_use_PrivateKey_file(ctx_, config_.key_file.c_str(), SSL_FILETYPE_PEM) !=
+                    1) {
+                throw_ssl_error_("failed loading client certificate");
+            }
+        }
+    }
+
+public:
+    explicit tls_client(tls_config config)
+        : config_(std::move(config)) {
+        init_ctx_();
+    }
+
+    ~tls_client() {
+        close();
+        if (session_ != nullptr) {
+            SSL_SESSION_free(session_);
+        }
+        SSL_CTX_free(ctx_);
+    }
+
+    tls_client(const tls_client &) = delete;
+    tls_client &operator=(const tls_client &) = delete;
+
+    bool is_connected() const { return ssl_ != nullptr; }
+
+    // true if the last handshake resumed a previous session
+    bool session_reused() const { return session_reused_; }
+
+    // true if records are encrypted by the kernel on the current connection
+    bool ktls_send_enabled() const {
+#ifdef SSL_OP_ENABLE_KTLS
+        return ssl_ != nullptr && BIO_get_ktls_send(SSL_get_wbio(ssl_));
+#else
+        return false;
+#endif
+    }
+
+    // Close the connection with a close_notify alert.
+    // A connection closed without it can't be resumed later, and unread records left in the
+    // socket would make the kernel reset the connection, possibly losing the last messages.
+    void close() {
+        if (ssl_ != nullptr) {
+            sigpipe_guard guard;
+            if (SSL_is_init_finished(ssl_)) {
+                read_pending_records_();
+                SSL_shutdown(ssl_);
+            }
+            ERR_clear_error();
+            SSL_free(ssl_);
+            ssl_ = nullptr;
+        }
+        tcp_.close();
+    }
+
+    // try to connect and handshake or throw on failure
+    void connect(const std::string &host, int port) {
+        close();
+        tcp_.connect(host, port);
+
+        ssl_ = SSL_new(ctx_);
+        if (ssl_ == nullptr) {
+            tcp_.close();
+            throw_ssl_error_("SSL_new failed");
+        }
+        SSL_set_app_data(ssl_, this);
+        SSL_set_fd(ssl_, static_cast<int>(tcp_.fd()));
+
+        const std::string &name = config_.server_name.empty() ? host : config_.server_name;
+        SSL_set_tlsext_host_name(ssl_, name.c_str());
+        if (config_.verify_peer) {
+            // verify as ip address if the name is one, as dns name otherwise
+            if (X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(ssl_), name.c_str()) != 1) {
+                ERR_clear_error();
+                SSL_set1_host(ssl_, name.c_str());
+            }
+        }
+        if (session_ != nullptr) {
+            SSL_set_session(ssl_, session_);
+        }
+
+        sigpipe_guard guard;
+        if (SSL_connect(ssl_) != 1) {
+            auto verify_result = SSL_get_verify_result(ssl_);
+            if (verify_result != X509_V_OK) {
+                close_and_throw_(fmt_lib::format("handshake with {}:{} failed ({})", host, port,
+                                                 X509_verify_cert_error_string(verify_result)));
+            }
+            close_and_throw_(fmt_lib::format("handshake with {}:{} failed", host, port));
+        }
+        session_reused_ = SSL_session_reused(ssl_) == 1;
+    }
+
+    // Send exactly n_bytes of the given data.
+    // On error close the connection and throw.
+    void send(const char *data, size_t n_bytes) {
+        read_pending_records_();
+        sigpipe_guard guard;
+        size_t bytes_sent = 0;
+        while (bytes_sent < n_bytes) {
+            size_t written = 0;
+            if (SSL_write_ex(ssl_, data + bytes_sent, n_bytes - bytes_sent, &written) != 1) {
+                close_and_throw_("SSL_write failed");
+            }
+            bytes_sent += written;
+        }
+    }
+};
+}  // namespace details
+}  // namespace spdlog
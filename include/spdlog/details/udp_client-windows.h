@@ -5,10 +5,15 @@
 
 // Helper RAII over winsock udp client socket.
 // Will throw on construction if socket creation failed.
+//
+// The host is resolved with getaddrinfo, so IPv4 and IPv6 destinations are supported.
+// The socket is connected to the resolved address and is non blocking: datagrams that don't fit
+// in the socket buffer or that are refused by the destination are dropped and counted.
 
 #include <spdlog/common.h>
 #include <spdlog/details/os.h>
 #include <spdlog/details/windows_include.h>
+#include <atomic>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
@@ -26,7 +31,7 @@ namespace details {
 class udp_client {
     static constexpr int TX_BUFFER_SIZE = 1024 * 10;
     SOCKET socket_ = INVALID_SOCKET;
-    sockaddr_in addr_ = {};
+    std::atomic<size_t> dropped_{0};
 
     static void init_winsock_() {
         WSADATA wsaData;
@@ -45,52 +50,111 @@ class udp_client {
         throw_spdlog_ex(fmt_lib::format("udp_sink - {}: {}", msg, buf));
     }
 
-    void cleanup_() {
+    void close_() {
         if (socket_ != INVALID_SOCKET) {
             ::closesocket(socket_);
         }
         socket_ = INVALID_SOCKET;
+    }
+
+    void cleanup_() {
+        close_();
         ::WSACleanup();
     }
 
+    // errors that mean "this datagram was lost" rather than "the socket is broken".
+    // WSAECONNRESET is reported on connected sockets when nobody listens on the remote port.
+    static bool is_drop_error_(int err) {
+        return err == WSAEWOULDBLOCK || err == WSAENOBUFS || err == WSAECONNRESET ||
+               err == WSAECONNREFUSED;
+    }
+
 public:
     udp_client(const std::string &host, uint16_t port) {
         init_winsock_();
 
-        addr_.sin_family = PF_INET;
-        addr_.sin_port = htons(port);
-        addr_.sin_addr.s_addr = INADDR_ANY;
-        if (InetPtonA(PF_INET, host.c_str(), &addr_.sin_addr.s_addr) != 1) {
-            int last_error = ::WSAGetLastError();
+        struct addrinfo hints {};
+        ZeroMemory(&hints, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;      // To work with IPv4, IPv6, and so on
+        hints.ai_socktype = SOCK_DGRAM;   // UDP
+        hints.ai_flags = AI_NUMERICSERV;  // port passed as as numeric value
+        hints.ai_protocol = 0;
+
+        auto port_str = std::to_string(port);
+        struct addrinfo *addrinfo_result;
+        auto rv = ::getaddrinfo(host.c_str(), port_str.c_str(), &hints, &addrinfo_result);
+        if (rv != 0) {
             ::WSACleanup();
-            throw_winsock_error_("error: Invalid address!", last_error);
+            throw_winsock_error_("getaddrinfo failed", rv);
         }
 
-        socket_ = ::socket(PF_INET, SOCK_DGRAM, 0);
+        // Try each address until we successfully connect.
+        int last_error = 0;
+        for (auto *rp = addrinfo_result; rp != nullptr; rp = rp->ai_next) {
+            socket_ = ::socket(rp->ai_family, rp->ai_socktype, rp->ai_protocol);
+            if (socket_ == INVALID_SOCKET) {
+                last_error = ::WSAGetLastError();
+                continue;
+            }
+            if (::connect(socket_, rp->ai_addr, static_cast<int>(rp->ai_addrlen)) == 0) {
+                break;
+            }
+            last_error = ::WSAGetLastError();
+            close_();
+        }
+        ::freeaddrinfo(addrinfo_result);
         if (socket_ == INVALID_SOCKET) {
-            int last_error = ::WSAGetLastError();
             ::WSACleanup();
-            throw_winsock_error_("error: Create Socket failed", last_error);
+            throw_winsock_error_("connect failed", last_error);
         }
 
         int option_value = TX_BUFFER_SIZE;
         if (::setsockopt(socket_, SOL_SOCKET, SO_SNDBUF,
                          reinterpret_cast<const char *>(&option_value), sizeof(option_value)) < 0) {
-            int last_error = ::WSAGetLastError();
+            last_error = ::WSAGetLastError();
             cleanup_();
             throw_winsock_error_("error: setsockopt(SO_SNDBUF) Failed!", last_error);
         }
+
+        u_long non_blocking = 1;
+        if (::ioctlsocket(socket_, FIONBIO, &non_blocking) != 0) {
+            last_error = ::WSAGetLastError();
+            cleanup_();
+            throw_winsock_error_("error: ioctlsocket(FIONBIO) Failed!", last_error);
+        }
     }
 
     ~udp_client() { cleanup_(); }
 
+    udp_client(const udp_client &) = delete;
+    udp_client &operator=(const udp_client &) = delete;
+
     SOCKET fd() const { return socket_; }
 
+    // Number of datagrams dropped because the socket buffer was full or the
+    // destination refused them.
+    size_t dropped_count() const { return dropped_.load(std::memory_order_relaxed); }
+
+    void reset_dropped_count() { dropped_.store(0, std::memory_order_relaxed); }
+
+    // Send the given data as a single datagram.
+    // Drop it (and count) if it cannot be sent right away, throw on other errors.
     void send(const char *data, size_t n_bytes) {
-        socklen_t tolen = sizeof(struct sockaddr);
-        if (::sendto(socket_, data, static_cast<int>(n_bytes), 0, (struct sockaddr *)&addr_,
-                     tolen) == -1) {
-            throw_spdlog_ex("sendto(2) failed", errno);
+        if (::send(socket_, data, static_cast<int>(n_bytes), 0) == SOCKET_ERROR) {
+            int last_error = ::WSAGetLastError();
+            if (!is_drop_error_(last_error)) {
+                throw_winsock_error_("send failed", last_error);
+            }
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Send n_datagrams datagrams, stored back to back in data.
+    // lengths[i] is the size of the i-th datagram.
+    void send_batch(const char *data, const size_t *lengths, size_t n_datagrams) {
+        for (size_t i = 0; i < n_datagrams; i++) {
+            send(data, lengths[i]);
+            data += lengths[i];
         }
     }
 };
@@ -5,12 +5,20 @@
 
 // Helper RAII over unix udp client socket.
 // Will throw on construction if the socket creation failed.
+//
+// The host is resolved with getaddrinfo(3), so IPv4, IPv6 and multicast
+// destinations are supported (multicast uses the system default ttl/hops).
+// The socket is connect(2)-ed to the resolved address so sends don't need to
+// pass the destination address each time.
+// Sends never block: datagrams that don't fit in the socket buffer (EAGAIN)
+// or that are refused by the destination are dropped and counted.
 
 #ifdef _WIN32
     #error "include udp_client-windows.h instead"
 #endif
 
 #include <arpa/inet.h>
+#include <cerrno>
 #include <cstring>
 #include <netdb.h>
 #include <netinet/in.h>
@@ -18,17 +26,27 @@
 #include <spdlog/common.h>
 #include <spdlog/details/os.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <string>
+#include <vector>
 
 namespace spdlog {
 namespace details {
 
 class udp_client {
     static constexpr int TX_BUFFER_SIZE = 1024 * 10;
+    // max number of datagrams passed to a single sendmmsg(2) call
+    static constexpr size_t MAX_BATCH = 64;
     int socket_ = -1;
-    struct sockaddr_in sockAddr_;
+    std::atomic<size_t> dropped_{0};
+#if defined(__linux__)
+    std::vector<struct mmsghdr> msgs_;
+    std::vector<struct iovec> iovs_;
+#endif
 
     void cleanup_() {
         if (socket_ != -1) {
@@ -37,11 +55,50 @@ class udp_client {
         }
     }
 
+    // errors that mean "this datagram was lost" rather than "the socket is broken".
+    // ECONNREFUSED is reported on connected sockets when nobody listens on the remote port.
+    static bool is_drop_error_(int err) {
+        return err == EAGAIN || err == EWOULDBLOCK || err == ENOBUFS || err == ECONNREFUSED;
+    }
+
 public:
     udp_client(const std::string &host, uint16_t port) {
-        socket_ = ::socket(PF_INET, SOCK_DGRAM, 0);
-        if (socket_ < 0) {
-            throw_spdlog_ex("error: Create Socket Failed!");
+        struct addrinfo hints {};
+        memset(&hints, 0, sizeof(struct addrinfo));
+        hints.ai_family = AF_UNSPEC;     // To work with IPv4, IPv6, and so on
+        hints.ai_socktype = SOCK_DGRAM;  // UDP
+        hints.ai_flags = AI_NUMERICSERV;  // port passed as as numeric value
+        hints.ai_protocol = 0;
+
+        auto port_str = std::to_string(port);
+        struct addrinfo *addrinfo_result;
+        auto rv = ::getaddrinfo(host.c_str(), port_str.c_str(), &hints, &addrinfo_result);
+        if (rv != 0) {
+            throw_spdlog_ex(fmt_lib::format("::getaddrinfo failed: {}", gai_strerror(rv)));
+        }
+
+        // Try each address until we successfully connect(2).
+        int last_errno = 0;
+        for (auto *rp = addrinfo_result; rp != nullptr; rp = rp->ai_next) {
+#if defined(SOCK_CLOEXEC)
+            const int flags = SOCK_CLOEXEC;
+#else
+            const int flags = 0;
+#endif
+            socket_ = ::socket(rp->ai_family, rp->ai_socktype | flags, rp->ai_protocol);
+            if (socket_ == -1) {
+                last_errno = errno;
+                continue;
+            }
+            if (::connect(socket_, rp->ai_addr, rp->ai_addrlen) == 0) {
+                break;
+            }
+            last_errno = errno;
+            cleanup_();
+        }
+        ::freeaddrinfo(addrinfo_result);
+        if (socket_ == -1) {
+            throw_spdlog_ex("::connect failed", last_errno);
         }
 
         int option_value = TX_BUFFER_SIZE;
@@ -50,32 +107,89 @@ public:
             cleanup_();
             throw_spdlog_ex("error: setsockopt(SO_SNDBUF) Failed!");
         }
-
-        sockAddr_.sin_family = AF_INET;
-        sockAddr_.sin_port = htons(port);
-
-        if (::inet_aton(host.c_str(), &sockAddr_.sin_addr) == 0) {
-            cleanup_();
-            throw_spdlog_ex("error: Invalid address!");
-        }
-
-        ::memset(sockAddr_.sin_zero, 0x00, sizeof(sockAddr_.sin_zero));
     }
 
     ~udp_client() { cleanup_(); }
 
+    udp_client(const udp_client &) = delete;
+    udp_client &operator=(const udp_client &) = delete;
+
     int fd() const { return socket_; }
 
-    // Send exactly n_bytes of the given data.
-    // On error close the connection and throw.
+    // Number of datagrams dropped because the socket buffer was full or the
+    // destination refused them.
+    size_t dropped_count() const { return dropped_.load(std::memory_order_relaxed); }
+
+    void reset_dropped_count() { dropped_.store(0, std::memory_order_relaxed); }
+
+    // Send the given data as a single datagram.
+    // Drop it (and count) if it cannot be sent right away, throw on other errors.
     void send(const char *data, size_t n_bytes) {
-        ssize_t toslen = 0;
-        socklen_t tolen = sizeof(struct sockaddr);
-        if ((toslen = ::sendto(socket_, data, n_bytes, 0, (struct sockaddr *)&sockAddr_, tolen)) ==
-            -1) {
-            throw_spdlog_ex("sendto(2) failed", errno);
+#if defined(MSG_DONTWAIT)
+        const int send_flags = MSG_DONTWAIT;
+#else
+        const int send_flags = 0;
+#endif
+        if (::send(socket_, data, n_bytes, send_flags) == -1) {
+            if (!is_drop_error_(errno)) {
+                throw_spdlog_ex("send(2) failed", errno);
+            }
+            dropped_.fetch_add(1, std::memory_order_relaxed);
         }
     }
+
+    // Send n_datagrams datagrams, stored back to back in data.
+    // lengths[i] is the size of the i-th datagram.
+    // Uses sendmmsg(2) where available to send up to MAX_BATCH datagrams per syscall.
+    void send_batch(const char *data, const size_t *lengths, size_t n_datagrams) {
+#if defined(__linux__)
+        size_t i = 0;
+        while (i < n_datagrams) {
+            const size_t chunk = (std::min)(n_datagrams - i, MAX_BATCH);
+            msgs_.resize(chunk);
+            iovs_.resize(chunk);
+            const char *p = data;
+            for (size_t j = 0; j < chunk; j++) {
+                iovs_[j].iov_base = const_cast<char *>(p);
+                iovs_[j].iov_len = lengths[i + j];
+                std::memset(&msgs_[j], 0, sizeof(struct mmsghdr));
+                msgs_[j].msg_hdr.msg_iov = &iovs_[j];
+                msgs_[j].msg_hdr.msg_iovlen = 1;
+                p += lengths[i + j];
+            }
+
+            auto rv = ::sendmmsg(socket_, msgs_.data(), static_cast<unsigned int>(chunk),
+                                 MSG_DONTWAIT);
+            size_t sent;
+            if (rv < 0) {
+                if (!is_drop_error_(errno)) {
+                    throw_spdlog_ex("sendmmsg(2) failed", errno);
+                }
+                if (errno == ECONNREFUSED) {
+                    // lose only the first datagram and retry the rest
+                    sent = 1;
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    // socket buffer is full - drop the rest of this chunk
+                    sent = chunk;
+                    dropped_.fetch_add(chunk, std::memory_order_relaxed);
+                }
+            } else {
+                sent = static_cast<size_t>(rv);
+            }
+
+            for (size_t j = 0; j < sent; j++) {
+                data += lengths[i + j];
+            }
+            i += sent;
+        }
+#else
+        for (size_t i = 0; i < n_datagrams; i++) {
+            send(data, lengths[i]);
+            data += lengths[i];
+        }
+#endif
+    }
 };
 }  // namespace details
 }  // namespace spdlog
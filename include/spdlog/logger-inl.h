@@ -8,6 +8,7 @@
 #endif
 
 #include <spdlog/details/backtracer.h>
+#include <spdlog/details/err_helper.h>
 #include <spdlog/pattern_formatter.h>
 #include <spdlog/sinks/sink.h>
 
@@ -59,6 +60,29 @@ SPDLOG_INLINE void logger::swap(spdlog::logger &other) SPDLOG_NOEXCEPT {
 
 SPDLOG_INLINE void swap(logger &a, logger &b) { a.swap(b); }
 
+SPDLOG_INLINE void logger::log(source_loc loc,
+                               level::level_enum lvl,
+                               const external_payload &payload) {
+    bool log_enabled = should_log(lvl);
+    bool traceback_enabled = tracer_.enabled();
+    if (!log_enabled && !traceback_enabled) {
+        if (payload.release != nullptr) {
+            payload.release(payload.context);
+        }
+        return;
+    }
+    details::log_msg log_msg(loc, name_, lvl, payload.data);
+    // the backtracer keeps its own copy. save it before the payload might get released.
+    if (traceback_enabled) {
+        tracer_.push_back(log_msg);
+    }
+    if (log_enabled) {
+        sink_external_(log_msg, payload);
+    } else if (payload.release != nullptr) {
+        payload.release(payload.context);
+    }
+}
+
 SPDLOG_INLINE void logger::set_level(level::level_enum log_level) { level_.store(log_level); }
 
 SPDLOG_INLINE level::level_enum logger::level() const {
@@ -145,6 +169,14 @@ SPDLOG_INLINE void logger::sink_it_(const details::log_msg &msg) {
     }
 }
 
+SPDLOG_INLINE void logger::sink_external_(const details::log_msg &msg,
+                                          const external_payload &payload) {
+    sink_it_(msg);
+    if (payload.release != nullptr) {
+        payload.release(payload.context);
+    }
+}
+
 SPDLOG_INLINE void logger::flush_() {
     for (auto &sink : sinks_) {
         SPDLOG_TRY { sink->flush(); }
@@ -172,27 +204,7 @@ SPDLOG_INLINE void logger::err_handler_(const std::string &msg) {
     if (custom_err_handler_) {
         custom_err_handler_(msg);
     } else {
-        using std::chrono::system_clock;
-        static std::mutex mutex;
-        static std::chrono::system_clock::time_point last_report_time;
-        static size_t err_counter = 0;
-        std::lock_guard<std::mutex> lk{mutex};
-        auto now = system_clock::now();
-        err_counter++;
-        if (now - last_report_time < std::chrono::seconds(1)) {
-            return;
-        }
-        last_report_time = now;
-        auto tm_time = details::os::localtime(system_clock::to_time_t(now));
-        char date_buf[64];
-        std::strftime(date_buf, sizeof(date_buf), "%Y-%m-%d %H:%M:%S", &tm_time);
-#if defined(USING_R) && defined(R_R_H)  // if in R environment
-        REprintf("[*** LOG ERROR #%04zu ***] [%s] [%s] %s\n", err_counter, date_buf, name().c_str(),
-                 msg.c_str());
-#else
-        std::fprintf(stderr, "[*** LOG ERROR #%04zu ***] [%s] [%s] %s\n", err_counter, date_buf,
-                     name().c_str(), msg.c_str());
-#endif
+        details::default_err_handler(name(), msg);
     }
 }
 }  // namespace spdlog
@@ -17,6 +17,7 @@
 #include <spdlog/common.h>
 #include <spdlog/details/backtracer.h>
 #include <spdlog/details/log_msg.h>
+#include <spdlog/details/profiler.h>
 
 #ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
     #ifndef _WIN32
@@ -133,6 +134,14 @@ public:
 
     void log(level::level_enum lvl, string_view_t msg) { log(source_loc{}, lvl, msg); }
 
+    // log a payload whose lifetime is managed by the caller, without copying it.
+    // see external_payload.
+    void log(source_loc loc, level::level_enum lvl, const external_payload &payload);
+
+    void log(level::level_enum lvl, const external_payload &payload) {
+        log(source_loc{}, lvl, payload);
+    }
+
     template <typename... Args>
     void trace(format_string_t<Args...> fmt, Args &&...args) {
         log(level::trace, fmt, std::forward<Args>(args)...);
@@ -326,11 +335,13 @@ protected:
         }
         SPDLOG_TRY {
             memory_buf_t buf;
+            SPDLOG_PROFILE_SCOPE(vformat_scope, this, vformat);
 #ifdef SPDLOG_USE_STD_FORMAT
             fmt_lib::vformat_to(std::back_inserter(buf), fmt, fmt_lib::make_format_args(args...));
 #else
             fmt::vformat_to(fmt::appender(buf), fmt, fmt::make_format_args(args...));
 #endif
+            SPDLOG_PROFILE_STOP(vformat_scope);
 
             details::log_msg log_msg(loc, name_, lvl, string_view_t(buf.data(), buf.size()));
             log_it_(log_msg, log_enabled, traceback_enabled);
@@ -349,11 +360,13 @@ protected:
         SPDLOG_TRY {
             // format to wmemory_buffer and convert to utf8
             wmemory_buf_t wbuf;
+            SPDLOG_PROFILE_SCOPE(vformat_scope, this, vformat);
             fmt_lib::vformat_to(std::back_inserter(wbuf), fmt,
                                 fmt_lib::make_format_args<fmt_lib::wformat_context>(args...));
 
             memory_buf_t buf;
             details::os::wstr_to_utf8buf(wstring_view_t(wbuf.data(), wbuf.size()), buf);
+            SPDLOG_PROFILE_STOP(vformat_scope);
             details::log_msg log_msg(loc, name_, lvl, string_view_t(buf.data(), buf.size()));
             log_it_(log_msg, log_enabled, traceback_enabled);
         }
@@ -365,6 +378,8 @@ protected:
     // and save backtrace (if backtrace is enabled).
     void log_it_(const details::log_msg &log_msg, bool log_enabled, bool traceback_enabled);
     virtual void sink_it_(const details::log_msg &msg);
+    // sink a message with an external payload and release it when done with it.
+    virtual void sink_external_(const details::log_msg &msg, const external_payload &payload);
     virtual void flush_();
   
     void dump_backtrace_();
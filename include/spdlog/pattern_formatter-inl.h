@@ -10,6 +10,7 @@
 #include <spdlog/details/fmt_helper.h>
 #include <spdlog/details/log_msg.h>
 #include <spdlog/details/os.h>
+#include <spdlog/details/profiler.h>
 
 #ifndef SPDLOG_NO_TLS
     #include <spdlog/mdc.h>
@@ -578,16 +579,73 @@ public:
     }
 };
 
+// append the payload, handling its newlines according to the multiline options.
+// newlines are found with memchr (vectorized by the c library), in a single pass.
+inline void append_payload(string_view_t payload,
+                           const multiline_options *options,
+                           memory_buf_t &dest) {
+    const char *p = payload.data();
+    const char *end = p + payload.size();
+    const char *nl = nullptr;
+    if (options == nullptr || options->policy == multiline_policy::keep || payload.size() == 0 ||
+        (nl = static_cast<const char *>(std::memchr(p, '\n', payload.size()))) == nullptr) {
+        dest.append(p, end);
+        return;
+    }
+
+    // the header might move when dest grows, so keep a copy of it
+    memory_buf_t header;
+    if (options->policy == multiline_policy::repeat_header) {
+        header.append(dest.data() + options->msg_start, dest.data() + dest.size());
+    }
+    while (nl != nullptr) {
+        if (options->policy == multiline_policy::escape) {
+            bool crlf = nl > p && nl[-1] == '\r';
+            dest.append(p, crlf ? nl - 1 : nl);
+            fmt_helper::append_string_view(crlf ? "\\r\\n" : "\\n", dest);
+        } else {
+            dest.append(p, nl + 1);
+            if (nl + 1 != end) {
+                if (options->policy == multiline_policy::repeat_header) {
+                    dest.append(header.data(), header.data() + header.size());
+                } else {
+                    fmt_helper::append_string_view(options->prefix, dest);
+                }
+            }
+        }
+        p = nl + 1;
+        nl = static_cast<const char *>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    }
+    dest.append(p, end);
+}
+
 template <typename ScopedPadder>
 class v_formatter final : public flag_formatter {
 public:
-    explicit v_formatter(padding_info padinfo)
-        : flag_formatter(padinfo) {}
+    explicit v_formatter(padding_info padinfo, const multiline_options *multiline = nullptr)
+        : flag_formatter(padinfo),
+          multiline_(multiline) {}
 
     void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override {
+        if (padinfo_.enabled() && multiline_ != nullptr &&
+            multiline_->policy != multiline_policy::keep &&
+            std::memchr(msg.payload.data(), '\n', msg.payload.size()) != nullptr) {
+            // the newlines change the payload's size: pad (or truncate) by what is appended
+            const size_t start = dest.size();
+            append_payload(msg.payload, multiline_, dest);
+            memory_buf_t appended;
+            appended.append(dest.data() + start, dest.data() + dest.size());
+            dest.resize(start);
+            ScopedPadder p(appended.size(), padinfo_, dest);
+            dest.append(appended.data(), appended.data() + appended.size());
+            return;
+        }
         ScopedPadder p(msg.payload.size(), padinfo_, dest);
-        fmt_helper::append_string_view(msg.payload, dest);
+        append_payload(msg.payload, multiline_, dest);
     }
+
+private:
+    const multiline_options *multiline_;
 };
 
 class ch_formatter final : public flag_formatter {
@@ -745,6 +803,24 @@ public:
     }
 };
 
+// print the message sequence number (stamped by async loggers, nothing if none)
+template <typename ScopedPadder>
+class sequence_formatter final : public flag_formatter {
+public:
+    explicit sequence_formatter(padding_info padinfo)
+        : flag_formatter(padinfo) {}
+
+    void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override {
+        if (msg.sequence == 0) {
+            ScopedPadder p(0, padinfo_, dest);
+            return;
+        }
+        auto field_size = ScopedPadder::count_digits(msg.sequence);
+        ScopedPadder p(field_size, padinfo_, dest);
+        fmt_helper::append_int(msg.sequence, dest);
+    }
+};
+
 // print source funcname
 template <typename ScopedPadder>
 class source_funcname_formatter final : public flag_formatter {
@@ -772,12 +848,12 @@ public:
 
     explicit elapsed_formatter(padding_info padinfo)
         : flag_formatter(padinfo),
-          last_message_time_(log_clock::now()) {}
+          last_message_time_(os::mono_now()) {}
 
     void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override {
-        auto delta = (std::max)(msg.time - last_message_time_, log_clock::duration::zero());
+        auto delta = (std::max)(msg.mono_time - last_message_time_, mono_clock::duration::zero());
         auto delta_units = std::chrono::duration_cast<DurationUnits>(delta);
-        last_message_time_ = msg.time;
+        last_message_time_ = msg.mono_time;
         auto delta_count = static_cast<size_t>(delta_units.count());
         auto n_digits = static_cast<size_t>(ScopedPadder::count_digits(delta_count));
         ScopedPadder p(n_digits, padinfo_, dest);
@@ -785,7 +861,54 @@ public:
     }
 
 private:
-    log_clock::time_point last_message_time_;
+    mono_clock::time_point last_message_time_;
+};
+
+// print the given duration as seconds with nanosecond precision (e.g. 12.000345678)
+template <typename ScopedPadder>
+inline void append_seconds_nanos(std::chrono::nanoseconds duration,
+                                 const padding_info &padinfo,
+                                 memory_buf_t &dest) {
+    auto ns = static_cast<uint64_t>((std::max)(duration, std::chrono::nanoseconds::zero()).count());
+    auto secs = ns / 1000000000;
+    auto n_digits = static_cast<size_t>(ScopedPadder::count_digits(secs)) + 10;
+    ScopedPadder p(n_digits, padinfo, dest);
+    fmt_helper::append_int(secs, dest);
+    dest.push_back('.');
+    fmt_helper::pad9(ns % 1000000000, dest);
+}
+
+// print the monotonic time since spdlog started
+template <typename ScopedPadder>
+class mono_uptime_formatter final : public flag_formatter {
+public:
+    explicit mono_uptime_formatter(padding_info padinfo)
+        : flag_formatter(padinfo) {}
+
+    void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override {
+        append_seconds_nanos<ScopedPadder>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(msg.mono_time - os::mono_start()),
+            padinfo_, dest);
+    }
+};
+
+// print the monotonic time since the last message, in seconds with nanosecond precision
+template <typename ScopedPadder>
+class mono_elapsed_formatter final : public flag_formatter {
+public:
+    explicit mono_elapsed_formatter(padding_info padinfo)
+        : flag_formatter(padinfo),
+          last_message_time_(os::mono_now()) {}
+
+    void format(const details::log_msg &msg, const std::tm &, memory_buf_t &dest) override {
+        auto delta = msg.mono_time - last_message_time_;
+        last_message_time_ = msg.mono_time;
+        append_seconds_nanos<ScopedPadder>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(delta), padinfo_, dest);
+    }
+
+private:
+    mono_clock::time_point last_message_time_;
 };
 
 // Class for formatting Mapped Diagnostic Context (MDC) in log messages.
@@ -835,8 +958,9 @@ public:
 // pattern: [%Y-%m-%d %H:%M:%S.%e] [%n] [%l] [%s:%#] %v
 class full_formatter final : public flag_formatter {
 public:
-    explicit full_formatter(padding_info padinfo)
-        : flag_formatter(padinfo) {}
+    explicit full_formatter(padding_info padinfo, const multiline_options *multiline = nullptr)
+        : flag_formatter(padinfo),
+          multiline_(multiline) {}
 
     void format(const details::log_msg &msg, const std::tm &tm_time, memory_buf_t &dest) override {
         using std::chrono::duration_cast;
@@ -918,10 +1042,11 @@ public:
         }
 #endif
         // fmt_helper::append_string_view(msg.msg(), dest);
-        fmt_helper::append_string_view(msg.payload, dest);
+        append_payload(msg.payload, multiline_, dest);
     }
 
 private:
+    const multiline_options *multiline_;
     std::chrono::seconds cache_timestamp_{0};
     memory_buf_t cached_datetime_;
 
@@ -955,7 +1080,8 @@ SPDLOG_INLINE pattern_formatter::pattern_formatter(pattern_time_type time_type,
       need_localtime_(true),
       last_log_secs_(0) {
     std::memset(&cached_tm_, 0, sizeof(cached_tm_));
-    formatters_.push_back(details::make_unique<details::full_formatter>(details::padding_info{}));
+    formatters_.push_back(
+        details::make_unique<details::full_formatter>(details::padding_info{}, &multiline_));
 }
 
 SPDLOG_INLINE std::unique_ptr<formatter> pattern_formatter::clone() const {
@@ -966,6 +1092,7 @@ SPDLOG_INLINE std::unique_ptr<formatter> pattern_formatter::clone() const {
     auto cloned = details::make_unique<pattern_formatter>(pattern_, pattern_time_type_, eol_,
                                                           std::move(cloned_custom_formatters));
     cloned->need_localtime(need_localtime_);
+    cloned->set_multiline(multiline_.policy, multiline_.prefix);
 #if defined(__GNUC__) && __GNUC__ < 5
     return std::move(cloned);
 #else
@@ -974,6 +1101,7 @@ SPDLOG_INLINE std::unique_ptr<formatter> pattern_formatter::clone() const {
 }
 
 SPDLOG_INLINE void pattern_formatter::format(const details::log_msg &msg, memory_buf_t &dest) {
+    SPDLOG_PROFILE_SCOPE(format_scope, details::profiler::current_owner(), pattern_format);
     if (need_localtime_) {
         const auto secs =
             std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch());
@@ -983,6 +1111,7 @@ SPDLOG_INLINE void pattern_formatter::format(const details::log_msg &msg, memory
         }
     }
 
+    multiline_.msg_start = dest.size();
     for (auto &f : formatters_) {
         f->format(msg, cached_tm_, dest);
     }
@@ -998,6 +1127,11 @@ SPDLOG_INLINE void pattern_formatter::set_pattern(std::string pattern) {
 
 SPDLOG_INLINE void pattern_formatter::need_localtime(bool need) { need_localtime_ = need; }
 
+SPDLOG_INLINE void pattern_formatter::set_multiline(multiline_policy policy, std::string prefix) {
+    multiline_.policy = policy;
+    multiline_.prefix = std::move(prefix);
+}
+
 SPDLOG_INLINE std::tm pattern_formatter::get_time_(const details::log_msg &msg) {
     if (pattern_time_type_ == pattern_time_type::local) {
         return details::os::localtime(log_clock::to_time_t(msg.time));
@@ -1019,7 +1153,8 @@ SPDLOG_INLINE void pattern_formatter::handle_flag_(char flag, details::padding_i
     // process built-in flags
     switch (flag) {
         case ('+'):  // default formatter
-            formatters_.push_back(details::make_unique<details::full_formatter>(padding));
+            formatters_.push_back(
+                details::make_unique<details::full_formatter>(padding, &multiline_));
             need_localtime_ = true;
             break;
 
@@ -1041,7 +1176,8 @@ SPDLOG_INLINE void pattern_formatter::handle_flag_(char flag, details::padding_i
             break;
 
         case ('v'):  // the message text
-            formatters_.push_back(details::make_unique<details::v_formatter<Padder>>(padding));
+            formatters_.push_back(
+                details::make_unique<details::v_formatter<Padder>>(padding, &multiline_));
             break;
 
         case ('a'):  // weekday
@@ -1195,6 +1331,11 @@ SPDLOG_INLINE void pattern_formatter::handle_flag_(char flag, details::padding_i
                 details::make_unique<details::source_funcname_formatter<Padder>>(padding));
             break;
 
+        case ('q'):  // message sequence number (async loggers)
+            formatters_.push_back(
+                details::make_unique<details::sequence_formatter<Padder>>(padding));
+            break;
+
         case ('%'):  // % char
             formatters_.push_back(details::make_unique<details::ch_formatter>('%'));
             break;
@@ -1223,6 +1364,16 @@ SPDLOG_INLINE void pattern_formatter::handle_flag_(char flag, details::padding_i
                     padding));
             break;
 
+        case ('k'):  // monotonic time since start in seconds.nanos
+            formatters_.push_back(
+                details::make_unique<details::mono_uptime_formatter<Padder>>(padding));
+            break;
+
+        case ('K'):  // monotonic time since last log message in seconds.nanos
+            formatters_.push_back(
+                details::make_unique<details::mono_elapsed_formatter<Padder>>(padding));
+            break;
+
 #ifndef SPDLOG_NO_TLS  // mdc formatter requires TLS support
         case ('&'):
             formatters_.push_back(details::make_unique<details::mdc_formatter<Padder>>(padding));
@@ -37,6 +37,13 @@ struct padding_info {
     bool enabled_ = false;
 };
 
+// multi-line payload settings of a pattern_formatter, shared with its payload flag formatters
+struct multiline_options {
+    multiline_policy policy = multiline_policy::keep;
+    std::string prefix;
+    size_t msg_start = 0;  // where the message being formatted starts in dest
+};
+
 class SPDLOG_API flag_formatter {
 public:
     explicit flag_formatter(padding_info padinfo)
@@ -89,6 +96,10 @@ public:
     void set_pattern(std::string pattern);
     void need_localtime(bool need = true);
 
+    // set how payloads with newlines are written (see multiline_policy).
+    // prefix is used by multiline_policy::prefix.
+    void set_multiline(multiline_policy policy, std::string prefix = {});
+
 private:
     std::string pattern_;
     std::string eol_;
@@ -98,6 +109,7 @@ private:
     std::chrono::seconds last_log_secs_;
     std::vector<std::unique_ptr<details::flag_formatter>> formatters_;
     custom_flags custom_handlers_;
+    details::multiline_options multiline_;
 
     std::tm get_time_(const details::log_msg &msg);
     template <typename Padder>
@@ -8,29 +8,81 @@
 #endif
 
 #include <spdlog/common.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/profiler.h>
+#include <spdlog/details/thread_formatters.h>
 #include <spdlog/pattern_formatter.h>
 
 #include <memory>
 #include <mutex>
+#include <type_traits>
 
 template <typename Mutex>
 SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::base_sink()
-    : formatter_{details::make_unique<spdlog::pattern_formatter>()} {}
+    : formatter_{details::make_unique<spdlog::pattern_formatter>()},
+      formatter_id_{details::thread_formatters::next_id()} {}
 
 template <typename Mutex>
 SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::base_sink(
     std::unique_ptr<spdlog::formatter> formatter)
-    : formatter_{std::move(formatter)} {}
+    : formatter_{std::move(formatter)},
+      formatter_id_{details::thread_formatters::next_id()} {}
 
 template <typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log(const details::log_msg &msg) {
+    SPDLOG_PROFILE_OWNER(this);
+#ifndef SPDLOG_NO_TLS
+    // single threaded sinks have nothing to gain from formatting outside of the (null) mutex
+    if (format_unlocked_ && !std::is_same<Mutex, details::null_mutex>::value &&
+        format_unlocked_enabled_.load(std::memory_order_relaxed)) {
+        memory_buf_t formatted;
+        thread_formatter_()->format(msg, formatted);
+        SPDLOG_PROFILE_SCOPE(lock_scope, this, lock_wait);
+        std::lock_guard<Mutex> lock(mutex_);
+        SPDLOG_PROFILE_STOP(lock_scope);
+        SPDLOG_PROFILE_SCOPE(write_scope, this, write);
+        sink_formatted_(msg, formatted);
+        return;
+    }
+#endif
+    SPDLOG_PROFILE_SCOPE(lock_scope, this, lock_wait);
     std::lock_guard<Mutex> lock(mutex_);
+    SPDLOG_PROFILE_STOP(lock_scope);
+    SPDLOG_PROFILE_SCOPE_EXCLUSIVE(write_scope, this, write);
     sink_it_(msg);
 }
 
+template <typename Mutex>
+bool SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::format_unlocked(const details::log_msg &msg,
+                                                                    memory_buf_t &dest) {
+#ifndef SPDLOG_NO_TLS
+    if (format_unlocked_) {
+        SPDLOG_PROFILE_OWNER(this);
+        thread_formatter_()->format(msg, dest);
+        return true;
+    }
+#endif
+    (void)msg;
+    (void)dest;
+    return false;
+}
+
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_formatted(const details::log_msg &msg,
+                                                                  const memory_buf_t &formatted) {
+    SPDLOG_PROFILE_SCOPE(lock_scope, this, lock_wait);
+    std::lock_guard<Mutex> lock(mutex_);
+    SPDLOG_PROFILE_STOP(lock_scope);
+    SPDLOG_PROFILE_SCOPE(write_scope, this, write);
+    sink_formatted_(msg, formatted);
+}
+
 template <typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::flush() {
+    SPDLOG_PROFILE_SCOPE(lock_scope, this, lock_wait);
     std::lock_guard<Mutex> lock(mutex_);
+    SPDLOG_PROFILE_STOP(lock_scope);
+    SPDLOG_PROFILE_SCOPE(flush_scope, this, flush);
     flush_();
 }
 
@@ -47,6 +99,11 @@ spdlog::sinks::base_sink<Mutex>::set_formatter(std::unique_ptr<spdlog::formatter
     set_formatter_(std::move(sink_formatter));
 }
 
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_format_unlocked(bool enabled) {
+    format_unlocked_enabled_.store(enabled, std::memory_order_relaxed);
+}
+
 template <typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_pattern_(const std::string &pattern) {
     set_formatter_(details::make_unique<spdlog::pattern_formatter>(pattern));
@@ -56,4 +113,32 @@ template <typename Mutex>
 void SPDLOG_INLINE
 spdlog::sinks::base_sink<Mutex>::set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter) {
     formatter_ = std::move(sink_formatter);
+    // clones of the previous formatter are never looked up again
+    formatter_id_.store(details::thread_formatters::next_id(), std::memory_order_relaxed);
+}
+
+template <typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_formatted_(const details::log_msg &msg,
+                                                                   const memory_buf_t &) {
+    sink_it_(msg);
 }
+
+#ifndef SPDLOG_NO_TLS
+// Return the calling thread's clone of the current formatter, cloning it on first use.
+template <typename Mutex>
+SPDLOG_INLINE spdlog::formatter *spdlog::sinks::base_sink<Mutex>::thread_formatter_() {
+    auto id = formatter_id_.load(std::memory_order_relaxed);
+    auto *f = details::thread_formatters::find(id);
+    if (f != nullptr) {
+        return f;
+    }
+    std::unique_ptr<spdlog::formatter> clone;
+    {
+        std::lock_guard<Mutex> lock(mutex_);
+        // the formatter might have been replaced since the id was read
+        id = formatter_id_.load(std::memory_order_relaxed);
+        clone = formatter_->clone();
+    }
+    return details::thread_formatters::insert(id, std::move(clone));
+}
+#endif
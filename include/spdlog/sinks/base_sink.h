@@ -13,6 +13,9 @@
 #include <spdlog/details/log_msg.h>
 #include <spdlog/sinks/sink.h>
 
+#include <atomic>
+#include <cstdint>
+
 namespace spdlog {
 namespace sinks {
 template <typename Mutex>
@@ -29,19 +32,44 @@ public:
     base_sink &operator=(base_sink &&) = delete;
 
     virtual void log(const details::log_msg &msg) override;
+    bool format_unlocked(const details::log_msg &msg, memory_buf_t &dest) override;
+    void log_formatted(const details::log_msg &msg, const memory_buf_t &formatted) override;
     virtual void flush() override;
     virtual void set_pattern(const std::string &pattern) override;
     virtual void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
 
-protected:
+    // Format the messages outside of the sink mutex (off by default).
+    // log() then formats each message before taking the mutex, using a clone of the formatter
+    // owned by the calling thread, and only the write itself is serialized.
+    // Note that flags that depend on the previous message (%o, %i, %u, %O, %K) are then relative
+    // to the previous message logged by the same thread.
+    // Has no effect on sinks that don't support it (see format_unlocked_) and on single threaded
+    // sinks.
+    void set_format_unlocked(bool enabled);
+
     // sink formatter
     std::unique_ptr<spdlog::formatter> formatter_;
+    std::atomic<uint64_t> formatter_id_;
     Mutex mutex_;
 
+    // Final sinks that implement sink_formatted_() set this in their constructor (in a class that
+    // can be derived from, a derived sink_it_() would be silently bypassed).
+    // It allows set_format_unlocked(), and lets the thread pool format the messages of async
+    // loggers in parallel (see format_unlocked() and thread_pool::set_parallel_formatting()).
+    bool format_unlocked_ = false;
+
     virtual void sink_it_(const details::log_msg &msg) = 0;
+    // write an already formatted message (called with the mutex held)
+    virtual void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted);
     virtual void flush_() = 0;
     virtual void set_pattern_(const std::string &pattern);
     virtual void set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter);
+
+private:
+    std::atomic<bool> format_unlocked_enabled_{false};
+#ifndef SPDLOG_NO_TLS
+    spdlog::formatter *thread_formatter_();
+#endif
 };
 }  // namespace sinks
 }  // namespace spdlog
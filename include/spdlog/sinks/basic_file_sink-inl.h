@@ -18,6 +18,7 @@ SPDLOG_INLINE basic_file_sink<Mutex>::basic_file_sink(const filename_t &filename
                                                       bool truncate,
                                                       const file_event_handlers &event_handlers)
     : file_helper_{event_handlers} {
+    base_sink<Mutex>::format_unlocked_ = true;
     file_helper_.open(filename, truncate);
 }
 
@@ -30,6 +31,12 @@ template <typename Mutex>
 SPDLOG_INLINE void basic_file_sink<Mutex>::sink_it_(const details::log_msg &msg) {
     memory_buf_t formatted;
     base_sink<Mutex>::formatter_->format(msg, formatted);
+    sink_formatted_(msg, formatted);
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_formatted_(const details::log_msg &,
+                                                          const memory_buf_t &formatted) {
     file_helper_.write(formatted);
 }
 
@@ -87,11 +87,12 @@ public:
             rotation_minute > 59) {
             throw_spdlog_ex("daily_file_sink: Invalid rotation time in ctor");
         }
+        base_sink<Mutex>::format_unlocked_ = true;
 
         auto now = log_clock::now();
         auto filename = FileNameCalc::calc_filename(base_filename_, now_tm(now));
         file_helper_.open(filename, truncate_);
-        rotation_tp_ = next_rotation_tp_();
+        rotation_tp_ = next_rotation_tp_(now);
 
         if (max_files_ > 0) {
             init_filenames_q_();
@@ -105,15 +106,19 @@ public:
 
 protected:
     void sink_it_(const details::log_msg &msg) override {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, formatted);
+    }
+
+    void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) override {
         auto time = msg.time;
         bool should_rotate = time >= rotation_tp_;
         if (should_rotate) {
             auto filename = FileNameCalc::calc_filename(base_filename_, now_tm(time));
             file_helper_.open(filename, truncate_);
-            rotation_tp_ = next_rotation_tp_();
+            rotation_tp_ = next_rotation_tp_(time);
         }
-        memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
         file_helper_.write(formatted);
 
         // Do the cleaning only at the end because it might throw on failure.
@@ -149,8 +154,10 @@ private:
         return spdlog::details::os::localtime(tnow);
     }
 
-    log_clock::time_point next_rotation_tp_() {
-        auto now = log_clock::now();
+    // the first rotation time after now. the time of the message that caused the rotation is
+    // used rather than the clock, so messages with given timestamps (e.g. replayed logs, or the
+    // accelerated time of bench/rotation_bench) rotate at the right times too.
+    log_clock::time_point next_rotation_tp_(log_clock::time_point now) {
         tm date = now_tm(now);
         date.tm_hour = rotation_h_;
         date.tm_min = rotation_m_;
@@ -55,11 +55,12 @@ public:
           truncate_(truncate),
           max_files_(max_files),
           filenames_q_() {
+        base_sink<Mutex>::format_unlocked_ = true;
         auto now = log_clock::now();
         auto filename = FileNameCalc::calc_filename(base_filename_, now_tm(now));
         file_helper_.open(filename, truncate_);
         remove_init_file_ = file_helper_.size() == 0;
-        rotation_tp_ = next_rotation_tp_();
+        rotation_tp_ = next_rotation_tp_(now);
 
         if (max_files_ > 0) {
             init_filenames_q_();
@@ -73,6 +74,12 @@ public:
 
 protected:
     void sink_it_(const details::log_msg &msg) override {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, formatted);
+    }
+
+    void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) override {
         auto time = msg.time;
         bool should_rotate = time >= rotation_tp_;
         if (should_rotate) {
@@ -82,11 +89,9 @@ protected:
             }
             auto filename = FileNameCalc::calc_filename(base_filename_, now_tm(time));
             file_helper_.open(filename, truncate_);
-            rotation_tp_ = next_rotation_tp_();
+            rotation_tp_ = next_rotation_tp_(time);
         }
         remove_init_file_ = false;
-        memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
         file_helper_.write(formatted);
 
         // Do the cleaning only at the end because it might throw on failure.
@@ -122,8 +127,10 @@ private:
         return spdlog::details::os::localtime(tnow);
     }
 
-    log_clock::time_point next_rotation_tp_() {
-        auto now = log_clock::now();
+    // the first rotation time after now. the time of the message that caused the rotation is
+    // used rather than the clock, so messages with given timestamps (e.g. replayed logs, or the
+    // accelerated time of bench/rotation_bench) rotate at the right times too.
+    log_clock::time_point next_rotation_tp_(log_clock::time_point now) {
         tm date = now_tm(now);
         date.tm_min = 0;
         date.tm_sec = 0;
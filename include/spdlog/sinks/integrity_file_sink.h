@@ -0,0 +1,531 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/crc32c.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/sha256.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// File sink for audit logs, with corruption detection and tamper evidence.
+//
+// Each record gets the crc32c of its text appended (" 1a2b3c4d" before the eol).
+// Every checkpoint_interval records a checkpoint record is written:
+//
+//   #chain <n> <sha256 of (checkpoint n-1 digest + all bytes since checkpoint n-1)>
+//
+// so changing any record invalidates all the following checkpoints. Checkpoint 0 (all zeros)
+// starts the chain at the start of the file, and a last checkpoint is written on close. When an
+// existing file is opened again the chain goes on from its last checkpoint, so removing or
+// inserting records anywhere breaks it.
+// The chain is not keyed: to detect a rewrite of the whole file, keep the last_checkpoint()
+// digests somewhere else.
+//
+// Use verify_integrity_file(s) (or the spdlog_verify tool) to check files.
+
+namespace spdlog {
+namespace details {
+
+namespace integrity {
+static constexpr const char *checkpoint_prefix = "#chain ";
+static constexpr size_t checkpoint_prefix_size = 7;
+static constexpr size_t crc_trailer_size = 9;  // " " + 8 hex digits
+
+inline void append_hex(const unsigned char *data, size_t n, memory_buf_t &dest) {
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < n; i++) {
+        dest.push_back(digits[data[i] >> 4]);
+        dest.push_back(digits[data[i] & 0xF]);
+    }
+}
+
+inline void append_crc_trailer(uint32_t crc, memory_buf_t &dest) {
+    static const char digits[] = "0123456789abcdef";
+    char trailer[crc_trailer_size];
+    trailer[0] = ' ';
+    for (size_t i = crc_trailer_size - 1; i > 0; i--) {
+        trailer[i] = digits[crc & 0xF];
+        crc >>= 4;
+    }
+    dest.append(trailer, trailer + crc_trailer_size);
+}
+
+inline int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+// parse n_bytes bytes from 2 * n_bytes hex digits. return false if not valid hex.
+inline bool parse_hex(const char *hex, size_t n_bytes, unsigned char *dest) {
+    for (size_t i = 0; i < n_bytes; i++) {
+        int hi = hex_value(hex[2 * i]);
+        int lo = hex_value(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        dest[i] = static_cast<unsigned char>(hi << 4 | lo);
+    }
+    return true;
+}
+
+// parse the crc trailer at the end of the line's content
+inline bool parse_crc_trailer(const char *line, size_t content_size, uint32_t &crc) {
+    if (content_size < crc_trailer_size || line[content_size - crc_trailer_size] != ' ') {
+        return false;
+    }
+    unsigned char bytes[4];
+    if (!parse_hex(line + content_size - crc_trailer_size + 1, 4, bytes)) {
+        return false;
+    }
+    crc = uint32_t(bytes[0]) << 24 | uint32_t(bytes[1]) << 16 | uint32_t(bytes[2]) << 8 |
+          uint32_t(bytes[3]);
+    return true;
+}
+
+// parse the "<n> <digest hex>" following the checkpoint prefix. return false if malformed.
+inline bool parse_checkpoint(const char *p, size_t size, size_t &index, sha256::digest &digest) {
+    index = 0;
+    size_t i = 0;
+    for (; i < size && p[i] >= '0' && p[i] <= '9'; i++) {
+        index = index * 10 + static_cast<size_t>(p[i] - '0');
+    }
+    return i > 0 && size == i + 1 + 2 * sha256::digest_size && p[i] == ' ' &&
+           parse_hex(p + i + 1, sha256::digest_size, digest.bytes);
+}
+
+// Verifies the records of an integrity file, fed to it line by line.
+class verifier {
+public:
+    bool failed() const { return failed_; }
+    size_t bad_offset() const { return bad_offset_; }
+    const std::string &error() const { return error_; }
+    size_t records() const { return records_; }
+    size_t checkpoints() const { return checkpoints_; }
+
+    // feed the next line of the file, including its '\n'
+    void feed_line(const char *line, size_t size, size_t offset) {
+        if (failed_) {
+            return;
+        }
+        size_t content_size = size;
+        if (content_size > 0 && line[content_size - 1] == '\n') content_size--;
+        if (content_size > 0 && line[content_size - 1] == '\r') content_size--;
+
+        uint32_t stored_crc = 0;
+        if (!parse_crc_trailer(line, content_size, stored_crc) ||
+            crc32c(line, content_size - crc_trailer_size, pending_crc_) != stored_crc) {
+            // either corrupted or a multi line record - try again with the next line appended
+            if (pending_.empty()) {
+                pending_offset_ = offset;
+            }
+            pending_.append(line, size);
+            pending_crc_ = crc32c(line, size, pending_crc_);
+            return;
+        }
+
+        if (pending_.empty() && content_size >= checkpoint_prefix_size &&
+            std::char_traits<char>::compare(line, checkpoint_prefix, checkpoint_prefix_size) == 0) {
+            on_checkpoint_(line + checkpoint_prefix_size,
+                           content_size - checkpoint_prefix_size - crc_trailer_size, offset,
+                           offset + size);
+        } else if (!started_) {
+            fail_(pending_.empty() ? offset : pending_offset_, "record before chain start");
+        } else {
+            hasher_.update(pending_.data(), pending_.size());
+            hasher_.update(line, size);
+            records_++;
+        }
+        pending_.clear();
+        pending_crc_ = 0;
+    }
+
+    // call at the end of the file with the size of the last line if it has no '\n'
+    void finish(size_t trailing_size, size_t offset) {
+        if (failed_) {
+            return;
+        }
+        if (!pending_.empty()) {
+            fail_(pending_offset_, "checksum mismatch");
+        } else if (trailing_size > 0) {
+            fail_(offset, "truncated record");
+        }
+    }
+
+private:
+    // "<n> <digest hex>". next_offset is where the segment following it starts.
+    void on_checkpoint_(const char *p, size_t size, size_t offset, size_t next_offset) {
+        size_t index;
+        sha256::digest digest;
+        if (!parse_checkpoint(p, size, index, digest)) {
+            fail_(offset, "malformed checkpoint");
+            return;
+        }
+
+        if (index == 0) {
+            // the chain starts at the start of the file. anywhere else it would hide the removal
+            // or insertion of records.
+            if (offset != 0) {
+                fail_(offset, "unexpected chain start");
+                return;
+            }
+            started_ = true;
+        } else if (!started_) {
+            fail_(offset, "checkpoint before chain start");
+            return;
+        } else if (index != next_index_) {
+            fail_(offset, "unexpected checkpoint index");
+            return;
+        } else {
+            auto expected = hasher_.final();
+            if (std::memcmp(expected.bytes, digest.bytes, sha256::digest_size) != 0) {
+                fail_(segment_offset_, "hash chain mismatch in segment");
+                return;
+            }
+        }
+        checkpoints_++;
+        next_index_ = index + 1;
+        segment_offset_ = next_offset;
+        hasher_.reset();
+        hasher_.update(digest.bytes, sha256::digest_size);
+    }
+
+    void fail_(size_t offset, const char *error) {
+        failed_ = true;
+        bad_offset_ = offset;
+        error_ = error;
+    }
+
+    bool started_ = false;
+    sha256 hasher_;
+    size_t next_index_ = 0;
+    size_t segment_offset_ = 0;
+    std::string pending_;
+    size_t pending_offset_ = 0;
+    uint32_t pending_crc_ = 0;
+
+    bool failed_ = false;
+    size_t bad_offset_ = 0;
+    std::string error_;
+    size_t records_ = 0;
+    size_t checkpoints_ = 0;
+};
+}  // namespace integrity
+}  // namespace details
+
+namespace sinks {
+
+template <typename Mutex>
+class integrity_file_sink final : public base_sink<Mutex> {
+public:
+    explicit integrity_file_sink(const filename_t &filename,
+                                 size_t checkpoint_interval = 1024,
+                                 bool truncate = false,
+                                 const file_event_handlers &event_handlers = {})
+        : checkpoint_interval_{checkpoint_interval},
+          file_helper_{event_handlers} {
+        bool resumed = !truncate && resume_chain_(filename);
+        file_helper_.open(filename, truncate);
+        if (!resumed) {
+            write_checkpoint_(true);
+        }
+    }
+
+    ~integrity_file_sink() override {
+        SPDLOG_TRY {
+            std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+            if (records_in_segment_ > 0) {
+                write_checkpoint_(false);
+            }
+            file_helper_.flush();
+        }
+        SPDLOG_CATCH_STD
+    }
+
+    const filename_t &filename() const { return file_helper_.filename(); }
+
+    // hex sha256 digest of the last checkpoint written
+    std::string last_checkpoint() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        memory_buf_t hex;
+        details::integrity::append_hex(last_digest_.bytes, details::sha256::digest_size, hex);
+        return std::string(hex.data(), hex.size());
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override {
+        formatted_.clear();
+        base_sink<Mutex>::formatter_->format(msg, formatted_);
+        write_record_();
+        if (++records_in_segment_ >= checkpoint_interval_) {
+            write_checkpoint_(false);
+        }
+    }
+
+    void flush_() override { file_helper_.flush(); }
+
+private:
+    // continue the chain of an existing file from its last checkpoint. the records after it (if
+    // the file was not closed properly) are part of the current segment.
+    // return false if the file is empty or doesn't exist.
+    bool resume_chain_(const filename_t &filename) {
+        std::FILE *fd;
+        if (details::os::fopen_s(&fd, filename, SPDLOG_FILENAME_T("rb"))) {
+            return false;
+        }
+        // read backwards until the last checkpoint line is found
+        auto pos = static_cast<size_t>(details::os::filesize(fd));
+        const bool empty = pos == 0;
+        std::string tail;
+        size_t line_end = std::string::npos;
+        size_t index = 0;
+        details::sha256::digest digest;
+        while (line_end == std::string::npos && pos > 0) {
+            size_t chunk = (std::min)(pos, size_t(64 * 1024));
+            pos -= chunk;
+            std::string buf(chunk, '\0');
+            if (std::fseek(fd, static_cast<long>(pos), SEEK_SET) != 0 ||
+                std::fread(&buf[0], 1, chunk, fd) != chunk) {
+                std::fclose(fd);
+                throw_spdlog_ex("integrity_file_sink: failed reading " +
+                                    details::os::filename_to_str(filename),
+                                errno);
+            }
+            tail.insert(0, buf);
+            line_end = find_last_checkpoint_(tail, pos == 0, index, digest);
+        }
+        std::fclose(fd);
+        if (empty) {
+            return false;
+        }
+        if (line_end == std::string::npos) {
+            throw_spdlog_ex("integrity_file_sink: no checkpoint to continue from in " +
+                            details::os::filename_to_str(filename));
+        }
+
+        last_digest_ = digest;
+        checkpoint_index_ = index + 1;
+        hasher_.reset();
+        hasher_.update(last_digest_.bytes, details::sha256::digest_size);
+        hasher_.update(tail.data() + line_end, tail.size() - line_end);
+        records_in_segment_ = static_cast<size_t>(
+            std::count(tail.begin() + static_cast<std::ptrdiff_t>(line_end), tail.end(), '\n'));
+        return true;
+    }
+
+    // the end of the last valid checkpoint line of text (npos if none). at_start - text is at
+    // the start of the file.
+    static size_t find_last_checkpoint_(const std::string &text,
+                                        bool at_start,
+                                        size_t &index,
+                                        details::sha256::digest &digest) {
+        using details::integrity::checkpoint_prefix;
+        using details::integrity::checkpoint_prefix_size;
+        using details::integrity::crc_trailer_size;
+        size_t from = std::string::npos;
+        for (;;) {
+            auto begin = text.rfind(checkpoint_prefix, from);
+            if (begin == std::string::npos) {
+                return std::string::npos;
+            }
+            auto end = text.find('\n', begin);
+            if (end != std::string::npos && (begin == 0 ? at_start : text[begin - 1] == '\n')) {
+                size_t content_end = end > begin && text[end - 1] == '\r' ? end - 1 : end;
+                size_t content_size = content_end - begin;
+                const char *line = text.data() + begin;
+                uint32_t crc;
+                if (content_size >= checkpoint_prefix_size + crc_trailer_size &&
+                    details::integrity::parse_crc_trailer(line, content_size, crc) &&
+                    details::crc32c(line, content_size - crc_trailer_size) == crc &&
+                    details::integrity::parse_checkpoint(
+                        line + checkpoint_prefix_size,
+                        content_size - checkpoint_prefix_size - crc_trailer_size, index, digest)) {
+                    return end + 1;
+                }
+            }
+            if (begin == 0) {
+                return std::string::npos;
+            }
+            from = begin - 1;
+        }
+    }
+
+    // insert the crc trailer before the eol of formatted_, chain and write it
+    void write_record_() {
+        size_t eol_size = 0;
+        auto *data = formatted_.data();
+        auto size = formatted_.size();
+        if (eol_size < size && data[size - 1 - eol_size] == '\n') eol_size++;
+        if (eol_size < size && eol_size > 0 && data[size - 1 - eol_size] == '\r') eol_size++;
+        char eol[2];
+        std::copy(data + size - eol_size, data + size, eol);
+        formatted_.resize(size - eol_size);
+
+        auto crc = details::crc32c(formatted_.data(), formatted_.size());
+        details::integrity::append_crc_trailer(crc, formatted_);
+        formatted_.append(eol, eol + eol_size);
+        hasher_.update(formatted_.data(), formatted_.size());
+        file_helper_.write(formatted_);
+    }
+
+    void write_checkpoint_(bool start) {
+        if (start) {
+            std::fill(last_digest_.bytes, last_digest_.bytes + details::sha256::digest_size, 0);
+        } else {
+            last_digest_ = hasher_.final();
+        }
+        formatted_.clear();
+        details::fmt_helper::append_string_view(details::integrity::checkpoint_prefix,
+                                                formatted_);
+        details::fmt_helper::append_int(checkpoint_index_, formatted_);
+        formatted_.push_back(' ');
+        details::integrity::append_hex(last_digest_.bytes, details::sha256::digest_size,
+                                       formatted_);
+        details::integrity::append_crc_trailer(
+            details::crc32c(formatted_.data(), formatted_.size()), formatted_);
+        details::fmt_helper::append_string_view(details::os::default_eol, formatted_);
+        file_helper_.write(formatted_);
+
+        checkpoint_index_++;
+        records_in_segment_ = 0;
+        hasher_.reset();
+        hasher_.update(last_digest_.bytes, details::sha256::digest_size);
+    }
+
+    size_t checkpoint_interval_;
+    details::file_helper file_helper_;
+    memory_buf_t formatted_;
+    details::sha256 hasher_;
+    details::sha256::digest last_digest_{};
+    size_t checkpoint_index_ = 0;
+    size_t records_in_segment_ = 0;
+};
+
+using integrity_file_sink_mt = integrity_file_sink<std::mutex>;
+using integrity_file_sink_st = integrity_file_sink<details::null_mutex>;
+
+//
+// verification
+//
+struct integrity_report {
+    bool ok = false;
+    size_t bad_offset = 0;  // offset of the first record (or segment) that failed verification
+    std::string error;
+    size_t records = 0;
+    size_t checkpoints = 0;
+};
+
+// verify the checksums and hash chain of the given file
+inline integrity_report verify_integrity_file(const filename_t &filename) {
+    integrity_report report;
+    std::FILE *fd;
+    if (details::os::fopen_s(&fd, filename, SPDLOG_FILENAME_T("rb"))) {
+        report.error = "failed opening " + details::os::filename_to_str(filename);
+        return report;
+    }
+
+    details::integrity::verifier verifier;
+    std::vector<char> buf(64 * 1024);
+    std::string partial;  // a line spanning two reads
+    size_t offset = 0;    // file offset of the next line
+    size_t n;
+    while (!verifier.failed() && (n = std::fread(buf.data(), 1, buf.size(), fd)) > 0) {
+        const char *p = buf.data();
+        const char *end = p + n;
+        while (p < end) {
+            auto *nl =
+                static_cast<const char *>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+            if (nl == nullptr) {
+                partial.append(p, end);
+                break;
+            }
+            auto line_size = static_cast<size_t>(nl + 1 - p);
+            if (partial.empty()) {
+                verifier.feed_line(p, line_size, offset);
+                offset += line_size;
+            } else {
+                partial.append(p, line_size);
+                verifier.feed_line(partial.data(), partial.size(), offset);
+                offset += partial.size();
+                partial.clear();
+            }
+            p = nl + 1;
+        }
+    }
+    std::fclose(fd);
+    verifier.finish(partial.size(), offset);
+
+    report.ok = !verifier.failed();
+    report.bad_offset = verifier.bad_offset();
+    report.error = verifier.error();
+    report.records = verifier.records();
+    report.checkpoints = verifier.checkpoints();
+    return report;
+}
+
+// verify the given files in parallel, using up to n_threads threads (0 - one per cpu)
+inline std::vector<integrity_report> verify_integrity_files(
+    const std::vector<filename_t> &filenames, size_t n_threads = 0) {
+    std::vector<integrity_report> reports(filenames.size());
+    if (n_threads == 0) {
+        n_threads = (std::max)(1u, std::thread::hardware_concurrency());
+    }
+    n_threads = (std::min)(n_threads, filenames.size());
+
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+        for (size_t i = next++; i < filenames.size(); i = next++) {
+            reports[i] = verify_integrity_file(filenames[i]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < n_threads; i++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto &t : threads) {
+        t.join();
+    }
+    return reports;
+}
+
+}  // namespace sinks
+
+//
+// factory functions
+//
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> integrity_logger_mt(const std::string &logger_name,
+                                                   const filename_t &filename,
+                                                   size_t checkpoint_interval = 1024,
+                                                   bool truncate = false,
+                                                   const file_event_handlers &event_handlers = {}) {
+    return Factory::template create<sinks::integrity_file_sink_mt>(
+        logger_name, filename, checkpoint_interval, truncate, event_handlers);
+}
+
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> integrity_logger_st(const std::string &logger_name,
+                                                   const filename_t &filename,
+                                                   size_t checkpoint_interval = 1024,
+                                                   bool truncate = false,
+                                                   const file_event_handlers &event_handlers = {}) {
+    return Factory::template create<sinks::integrity_file_sink_st>(
+        logger_name, filename, checkpoint_interval, truncate, event_handlers);
+}
+
+}  // namespace spdlog
@@ -16,7 +16,9 @@ class ostream_sink final : public base_sink<Mutex> {
 public:
     explicit ostream_sink(std::ostream &os, bool force_flush = false)
         : ostream_(os),
-          force_flush_(force_flush) {}
+          force_flush_(force_flush) {
+        base_sink<Mutex>::format_unlocked_ = true;
+    }
     ostream_sink(const ostream_sink &) = delete;
     ostream_sink &operator=(const ostream_sink &) = delete;
 
@@ -24,6 +26,10 @@ protected:
     void sink_it_(const details::log_msg &msg) override {
         memory_buf_t formatted;
         base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, formatted);
+    }
+
+    void sink_formatted_(const details::log_msg &, const memory_buf_t &formatted) override {
         ostream_.write(formatted.data(), static_cast<std::streamsize>(formatted.size()));
         if (force_flush_) {
             ostream_.flush();
@@ -37,7 +37,6 @@ SPDLOG_INLINE rotating_file_sink<Mutex>::rotating_file_sink(
     if (max_size == 0) {
         throw_spdlog_ex("rotating sink constructor: max_size arg cannot be zero");
     }
-
     if (max_files > 200000) {
         throw_spdlog_ex("rotating sink constructor: max_files arg cannot exceed 200000");
     }
@@ -73,6 +72,12 @@ template <typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_it_(const details::log_msg &msg) {
     memory_buf_t formatted;
     base_sink<Mutex>::formatter_->format(msg, formatted);
+    sink_formatted_(msg, formatted);
+}
+
+template <typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_formatted_(const details::log_msg &,
+                                                             const memory_buf_t &formatted) {
     auto new_size = current_size_ + formatted.size();
 
     // rotate if the new estimated file size exceeds max size.
@@ -16,7 +16,10 @@ namespace spdlog {
 namespace sinks {
 
 //
-// Rotating file sink based on size
+// Rotating file sink based on size.
+// Doesn't support base_sink::set_format_unlocked(): the class can be derived from, and a derived
+// sink_it_() would be bypassed. Derived classes that don't override sink_it_() may set
+// base_sink::format_unlocked_ in their constructor.
 //
 template <typename Mutex>
 class rotating_file_sink : public base_sink<Mutex> {
@@ -31,6 +34,7 @@ public:
 
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_formatted_(const details::log_msg &msg, const memory_buf_t &formatted) override;
     void flush_() override;
 
 private:
@@ -0,0 +1,86 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/shm_ring.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <mutex>
+#include <string>
+
+// Shared memory sink
+// Puts the formatted messages (without the eol) in a ring in POSIX shared memory, shared by all
+// the processes logging to the same ring name, from which a single collector process
+// (tools/spdlog_collect) writes them with its own sinks, e.g. one rotating file per ring.
+// This replaces many small writes and rotations by many processes with large sequential writes by
+// one.
+// If the ring is full (the collector is behind or not running), logging waits for room, or drops
+// the message if block_when_full is false. A process that crashes while logging costs at most
+// the message it was writing (see details/shm_ring.h).
+// POSIX only.
+
+namespace spdlog {
+namespace sinks {
+
+struct shm_sink_config {
+    std::string ring_name;  // the ring is "/spdlog.<ring_name>" in shared memory
+    size_t slots = 4096;  // geometry, if this process creates the ring
+    size_t slot_size = 512;  // bytes, longer messages are truncated
+    bool block_when_full = true;
+
+    explicit shm_sink_config(std::string name)
+        : ring_name{std::move(name)} {}
+};
+
+template <typename Mutex>
+class shm_sink : public spdlog::sinks::base_sink<Mutex> {
+public:
+    explicit shm_sink(const shm_sink_config &sink_config)
+        : ring_{sink_config.ring_name, sink_config.slots, sink_config.slot_size},
+          block_{sink_config.block_when_full} {}
+
+    // messages dropped because the ring was full (by all the processes using the ring)
+    size_t dropped_messages() const { return ring_.dropped(); }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        size_t size = formatted.size();
+        while (size > 0 && (formatted[size - 1] == '\n' || formatted[size - 1] == '\r')) {
+            size--;
+        }
+        ring_.push(msg.level, msg.time, string_view_t(formatted.data(), size), block_);
+    }
+
+    void flush_() override {}
+
+    details::shm_ring ring_;
+    bool block_;
+};
+
+using shm_sink_mt = shm_sink<std::mutex>;
+using shm_sink_st = shm_sink<spdlog::details::null_mutex>;
+
+}  // namespace sinks
+
+//
+// factory functions
+//
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> shm_logger_mt(const std::string &logger_name,
+                                             const sinks::shm_sink_config &sink_config) {
+    return Factory::template create<sinks::shm_sink_mt>(logger_name, sink_config);
+}
+
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> shm_logger_st(const std::string &logger_name,
+                                             const sinks::shm_sink_config &sink_config) {
+    return Factory::template create<sinks::shm_sink_st>(logger_name, sink_config);
+}
+
+}  // namespace spdlog
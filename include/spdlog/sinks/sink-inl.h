@@ -15,6 +15,15 @@ SPDLOG_INLINE bool spdlog::sinks::sink::should_log(spdlog::level::level_enum msg
     return msg_level >= level;
 }
 
+SPDLOG_INLINE bool spdlog::sinks::sink::format_unlocked(const details::log_msg &, memory_buf_t &) {
+    return false;
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::log_formatted(const details::log_msg &msg,
+                                                     const memory_buf_t &) {
+    log(msg);
+}
+
 SPDLOG_INLINE void spdlog::sinks::sink::set_level(level::level_enum log_level) {
     level_.store(log_level, std::memory_order_relaxed);
 }
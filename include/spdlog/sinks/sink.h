@@ -17,6 +17,13 @@ public:
     virtual void set_pattern(const std::string &pattern) = 0;
     virtual void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) = 0;
 
+    // Two phase logging (used by the thread pool's parallel formatting):
+    // format_unlocked() formats the message without taking the sink's lock, and may be called by
+    // several threads at once. It returns false if the sink formats only when writing.
+    // log_formatted() then writes the message formatted by format_unlocked().
+    virtual bool format_unlocked(const details::log_msg &msg, memory_buf_t &dest);
+    virtual void log_formatted(const details::log_msg &msg, const memory_buf_t &formatted);
+
     void set_level(level::level_enum log_level);
     level::level_enum level() const;
     virtual bool should_log(level::level_enum msg_level) const;
@@ -0,0 +1,123 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Sinks for static_logger (see static_logger.h).
+// A static sink is any type with the following (non virtual) members:
+//     void log(const details::log_msg &msg, const memory_buf_t &formatted);
+//     void flush();
+// It is held by value in the logger and called with the logger mutex held, so it needs no locking
+// of its own. Static sinks are moved into the logger, so they must be move constructible.
+// A sink that doesn't use the formatted buffer can declare
+//     static constexpr bool needs_formatting = false;
+// and the logger skips formatting when none of its sinks need it.
+
+#include <spdlog/common.h>
+#include <spdlog/details/file_helper.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/sinks/sink.h>
+
+#include <memory>
+#include <ostream>
+#include <type_traits>
+
+namespace spdlog {
+namespace details {
+// true unless the sink declares needs_formatting = false
+template <typename Sink, typename = void>
+struct static_sink_needs_formatting : std::true_type {};
+
+template <typename Sink>
+struct static_sink_needs_formatting<Sink, typename std::enable_if<!Sink::needs_formatting>::type>
+    : std::false_type {};
+
+template <typename... Sinks>
+struct any_static_sink_needs_formatting : std::false_type {};
+
+template <typename Sink, typename... Rest>
+struct any_static_sink_needs_formatting<Sink, Rest...>
+    : std::integral_constant<bool,
+                             static_sink_needs_formatting<Sink>::value ||
+                                 any_static_sink_needs_formatting<Rest...>::value> {};
+}  // namespace details
+
+namespace sinks {
+
+// discard all messages
+struct static_null_sink {
+    static constexpr bool needs_formatting = false;
+
+    void log(const details::log_msg &, const memory_buf_t &) {}
+    void flush() {}
+};
+
+// write to the given std::ostream
+class static_ostream_sink {
+public:
+    explicit static_ostream_sink(std::ostream &os, bool force_flush = false)
+        : ostream_(&os),
+          force_flush_(force_flush) {}
+
+    void log(const details::log_msg &, const memory_buf_t &formatted) {
+        ostream_->write(formatted.data(), static_cast<std::streamsize>(formatted.size()));
+        if (force_flush_) {
+            ostream_->flush();
+        }
+    }
+
+    void flush() { ostream_->flush(); }
+
+private:
+    std::ostream *ostream_;
+    bool force_flush_;
+};
+
+// write to a single file
+class static_file_sink {
+public:
+    explicit static_file_sink(const filename_t &filename,
+                              bool truncate = false,
+                              const file_event_handlers &event_handlers = {})
+        : file_helper_{details::make_unique<details::file_helper>(event_handlers)} {
+        file_helper_->open(filename, truncate);
+    }
+
+    void log(const details::log_msg &, const memory_buf_t &formatted) {
+        file_helper_->write(formatted);
+    }
+
+    void flush() { file_helper_->flush(); }
+
+    const filename_t &filename() const { return file_helper_->filename(); }
+
+private:
+    // file_helper is not movable
+    std::unique_ptr<details::file_helper> file_helper_;
+};
+
+// forward to a regular (dynamic) sink, which formats the message with its own formatter.
+// allows mixing any of the existing sinks into a static_logger.
+class static_sink_ref {
+public:
+    static constexpr bool needs_formatting = false;
+
+    explicit static_sink_ref(sink_ptr sink)
+        : sink_(std::move(sink)) {}
+
+    void log(const details::log_msg &msg, const memory_buf_t &) {
+        if (sink_->should_log(msg.level)) {
+            sink_->log(msg);
+        }
+    }
+
+    void flush() { sink_->flush(); }
+
+    const sink_ptr &sink() const { return sink_; }
+
+private:
+    sink_ptr sink_;
+};
+
+}  // namespace sinks
+}  // namespace spdlog
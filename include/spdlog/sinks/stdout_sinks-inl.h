@@ -24,6 +24,18 @@
     #include <stdio.h>  // _fileno(..)
 #endif                  // WIN32
 
+#ifdef __linux__
+    #include <algorithm>
+    #include <cerrno>
+    #include <cstring>
+
+    #include <fcntl.h>  // vmsplice(..), F_SETPIPE_SZ
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
 namespace spdlog {
 
 namespace sinks {
@@ -47,6 +59,17 @@ SPDLOG_INLINE stdout_sink_base<ConsoleMutex>::stdout_sink_base(FILE *file)
 #endif  // WIN32
 }
 
+template <typename ConsoleMutex>
+SPDLOG_INLINE stdout_sink_base<ConsoleMutex>::~stdout_sink_base() {
+#ifdef __linux__
+    if (pipe_buf_ != nullptr) {
+        SPDLOG_TRY { pipe_flush_(); }
+        SPDLOG_CATCH_STD
+        ::munmap(pipe_buf_, pipe_buf_size_);
+    }
+#endif
+}
+
 template <typename ConsoleMutex>
 SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log(const details::log_msg &msg) {
 #ifdef _WIN32
@@ -67,6 +90,12 @@ SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log(const details::log_msg &m
     std::lock_guard<mutex_t> lock(mutex_);
     memory_buf_t formatted;
     formatter_->format(msg, formatted);
+    #ifdef __linux__
+    if (pipe_buf_ != nullptr) {
+        pipe_append_(formatted);
+        return;
+    }
+    #endif
     ::fwrite(formatted.data(), sizeof(char), formatted.size(), file_);
 #endif                // WIN32
     ::fflush(file_);  // flush every line to terminal
@@ -75,6 +104,11 @@ SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log(const details::log_msg &m
 template <typename ConsoleMutex>
 SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::flush() {
     std::lock_guard<mutex_t> lock(mutex_);
+#ifdef __linux__
+    if (pipe_buf_ != nullptr) {
+        pipe_flush_();
+    }
+#endif
     fflush(file_);
 }
 
@@ -91,6 +125,131 @@ SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::set_formatter(
     formatter_ = std::move(sink_formatter);
 }
 
+template <typename ConsoleMutex>
+SPDLOG_INLINE bool stdout_sink_base<ConsoleMutex>::enable_pipe_splice(size_t buffer_size,
+                                                                      size_t pipe_size) {
+#ifdef __linux__
+    std::lock_guard<mutex_t> lock(mutex_);
+    if (pipe_buf_ != nullptr) {
+        return true;
+    }
+    int fd = ::fileno(file_);
+    struct stat st{};
+    if (fd == -1 || ::fstat(fd, &st) != 0 || !S_ISFIFO(st.st_mode)) {
+        return false;
+    }
+    auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    buffer_size = (std::max(buffer_size, page) + page - 1) / page * page;
+    auto *buf = pipe_alloc_(buffer_size);
+    if (buf == nullptr) {
+        return false;
+    }
+    #ifdef F_SETPIPE_SZ
+    if (pipe_size != 0) {
+        ::fcntl(fd, F_SETPIPE_SZ, static_cast<int>(pipe_size));
+    }
+    #endif
+    // what was written through stdio so far goes first
+    ::fflush(file_);
+    pipe_fd_ = fd;
+    pipe_buf_ = buf;
+    pipe_buf_size_ = buffer_size;
+    pipe_buf_used_ = 0;
+    return true;
+#else
+    (void)buffer_size;
+    (void)pipe_size;
+    return false;
+#endif
+}
+
+#ifdef __linux__
+template <typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::pipe_append_(const memory_buf_t &formatted) {
+    if (pipe_buf_used_ + formatted.size() > pipe_buf_size_) {
+        pipe_flush_();
+    }
+    if (formatted.size() > pipe_buf_size_) {
+        pipe_write_(formatted.data(), formatted.size());
+        return;
+    }
+    std::memcpy(pipe_buf_ + pipe_buf_used_, formatted.data(), formatted.size());
+    pipe_buf_used_ += formatted.size();
+    if (pipe_buf_used_ == pipe_buf_size_) {
+        pipe_flush_();
+    }
+}
+
+template <typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::pipe_flush_() {
+    auto page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t used = pipe_buf_used_;
+    pipe_buf_used_ = 0;
+    if (used < page || vmsplice_failed_) {
+        // the buffer can be reused, write() copies it
+        pipe_write_(pipe_buf_, used);
+        return;
+    }
+    // the pipe refers to the spliced pages until they are read, so they are never written again:
+    // the buffer is unmapped (the pages live on in the pipe) and replaced by a new one.
+    // the whole pages are gifted, so a reader splicing them out may move them instead of copying.
+    size_t whole_pages = used / page * page;
+    auto flags = [whole_pages](size_t offset) {
+        return offset < whole_pages ? static_cast<unsigned int>(SPLICE_F_GIFT) : 0u;
+    };
+    size_t spliced = 0;
+    while (spliced < used) {
+        iovec iov{pipe_buf_ + spliced, (spliced < whole_pages ? whole_pages : used) - spliced};
+        auto n = ::vmsplice(pipe_fd_, &iov, 1, flags(spliced));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // not permitted (e.g. seccomp) or not supported - write() from now on
+            vmsplice_failed_ = true;
+            break;
+        }
+        spliced += static_cast<size_t>(n);
+    }
+    if (spliced == 0) {
+        pipe_write_(pipe_buf_, used);
+        return;
+    }
+    auto *buf = pipe_alloc_(pipe_buf_size_);
+    if (spliced < used) {
+        pipe_write_(pipe_buf_ + spliced, used - spliced);
+    }
+    ::munmap(pipe_buf_, pipe_buf_size_);
+    pipe_buf_ = buf;
+    if (pipe_buf_ == nullptr) {
+        // out of memory - back to stdio
+        pipe_buf_size_ = 0;
+        throw_spdlog_ex("stdout_sink_base: mmap failed", errno);
+    }
+}
+
+template <typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::pipe_write_(const char *data, size_t size) {
+    while (size > 0) {
+        auto n = ::write(pipe_fd_, data, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_spdlog_ex("stdout_sink_base: write() failed", errno);
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+template <typename ConsoleMutex>
+SPDLOG_INLINE char *stdout_sink_base<ConsoleMutex>::pipe_alloc_(size_t size) {
+    void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? nullptr : static_cast<char *>(p);
+}
+#endif
+
 // stdout sink
 template <typename ConsoleMutex>
 SPDLOG_INLINE stdout_sink<ConsoleMutex>::stdout_sink()
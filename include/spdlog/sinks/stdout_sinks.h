@@ -21,7 +21,7 @@ class stdout_sink_base : public sink {
 public:
     using mutex_t = typename ConsoleMutex::mutex_t;
     explicit stdout_sink_base(FILE *file);
-    ~stdout_sink_base() override = default;
+    ~stdout_sink_base() override;
 
     stdout_sink_base(const stdout_sink_base &other) = delete;
     stdout_sink_base(stdout_sink_base &&other) = delete;
@@ -35,6 +35,17 @@ public:
 
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
 
+    // Linux only: if the file is a pipe (e.g. stdout read by a container runtime), keep the
+    // formatted messages in a page aligned buffer of buffer_size bytes, and hand the buffer to the
+    // pipe with vmsplice() instead of copying it through stdio and write() (write() is still used
+    // for less than a page, or if vmsplice() is not permitted).
+    // The messages are then written when the buffer is full, on flush() (see logger::flush_on()
+    // and spdlog::flush_every()) and when the sink is destroyed, instead of after each message.
+    // If pipe_size is not 0 the pipe is resized to it (F_SETPIPE_SZ, best effort), so a whole
+    // buffer fits in it.
+    // Returns false (and changes nothing) if not supported.
+    bool enable_pipe_splice(size_t buffer_size = 64 * 1024, size_t pipe_size = 0);
+
 protected:
     mutex_t &mutex_;
     FILE *file_;
@@ -42,6 +53,20 @@ protected:
 #ifdef _WIN32
     HANDLE handle_;
 #endif  // WIN32
+#ifdef __linux__
+    // see enable_pipe_splice()
+    int pipe_fd_ = -1;
+    char *pipe_buf_ = nullptr;  // mmap'ed, replaced once spliced (the pipe refers to its pages)
+    size_t pipe_buf_size_ = 0;
+    size_t pipe_buf_used_ = 0;
+    bool vmsplice_failed_ = false;
+
+    void pipe_append_(const memory_buf_t &formatted);
+    // write the buffered messages to the pipe
+    void pipe_flush_();
+    void pipe_write_(const char *data, size_t size);
+    static char *pipe_alloc_(size_t size);
+#endif
 };
 
 template <typename ConsoleMutex>
@@ -0,0 +1,232 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+#include <spdlog/common.h>
+#include <spdlog/details/frame_codec.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+#ifdef _WIN32
+    #include <spdlog/details/tcp_client-windows.h>
+#else
+    #include <spdlog/details/tcp_client.h>
+#endif
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Tcp sink over a pool of collector endpoints.
+// Formatted messages are accumulated into batches (of up to batch_size bytes) and each batch is
+// sent as a whole to one of the endpoints, chosen by round robin or by the least bytes still
+// waiting to be acknowledged by the endpoint (linux only, round robin elsewhere).
+// An endpoint that fails to connect within send_timeout, fails a send or blocks a send longer
+// than send_timeout is ejected for eject_duration and the batch is retried on the next endpoint.
+// Messages in the same batch are delivered in order to the same endpoint. There is no ordering
+// across endpoints.
+//
+// Delivery on failover: the whole batch is resent to the next endpoint, so the messages of the
+// batch sent before the failure may be received twice (by both endpoints), and the failed
+// endpoint may receive the last of them truncated. With framed set, each batch is sent as a
+// frame (see details/frame_codec.h) that a collector decoding the stream with frame_decoder only
+// gets once complete, so a batch cut short is dropped there instead.
+// Either way a batch fully handed to an endpoint's connection is not resent if the endpoint
+// fails afterwards (there are no acknowledgements), so it may be lost.
+
+namespace spdlog {
+namespace sinks {
+
+enum class tcp_balance_policy {
+    round_robin,             // rotate between the healthy endpoints
+    least_outstanding_bytes  // pick the endpoint with the fewest unacknowledged bytes
+};
+
+struct tcp_endpoint {
+    std::string host;
+    int port;
+};
+
+struct tcp_pool_sink_config {
+    std::vector<tcp_endpoint> endpoints;
+    tcp_balance_policy policy = tcp_balance_policy::round_robin;
+    size_t batch_size = 64 * 1024;  // send when this many bytes are pending (0 - every message)
+    std::chrono::milliseconds send_timeout{1000};    // a send blocked for longer is a stall
+    std::chrono::milliseconds eject_duration{5000};  // how long a bad endpoint is skipped
+    bool framed = false;  // send each batch as an uncompressed frame (see above)
+
+    explicit tcp_pool_sink_config(std::vector<tcp_endpoint> eps)
+        : endpoints{std::move(eps)} {}
+};
+
+template <typename Mutex>
+class tcp_pool_sink : public spdlog::sinks::base_sink<Mutex> {
+public:
+    explicit tcp_pool_sink(tcp_pool_sink_config sink_config)
+        : config_{std::move(sink_config)} {
+        if (config_.endpoints.empty()) {
+            throw_spdlog_ex("tcp_pool_sink: no endpoints given");
+        }
+        for (auto &ep : config_.endpoints) {
+            endpoints_.emplace_back(details::make_unique<endpoint_state>(ep));
+        }
+    }
+
+    ~tcp_pool_sink() override {
+        SPDLOG_TRY { send_pending_(); }
+        SPDLOG_CATCH_STD
+    }
+
+    // number of endpoints that are not ejected right now
+    size_t healthy_endpoints() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        auto now = clock::now();
+        size_t count = 0;
+        for (auto &ep : endpoints_) {
+            count += ep->available(now) ? 1 : 0;
+        }
+        return count;
+    }
+
+    // number of batches sent to each endpoint (in the order of config.endpoints)
+    std::vector<size_t> batches_sent() {
+        std::lock_guard<Mutex> lock(base_sink<Mutex>::mutex_);
+        std::vector<size_t> rv;
+        for (auto &ep : endpoints_) {
+            rv.push_back(ep->batches_sent);
+        }
+        return rv;
+    }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override {
+        base_sink<Mutex>::formatter_->format(msg, pending_);
+        pending_records_++;
+        if (pending_.size() >= config_.batch_size) {
+            send_pending_();
+        }
+    }
+
+    void flush_() override { send_pending_(); }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct endpoint_state {
+        explicit endpoint_state(tcp_endpoint ep)
+            : endpoint(std::move(ep)) {}
+
+        bool available(clock::time_point now) const { return now >= ejected_until; }
+
+        tcp_endpoint endpoint;
+        details::tcp_client client;
+        clock::time_point ejected_until{};
+        size_t batches_sent = 0;
+    };
+
+    endpoint_state *pick_endpoint_(clock::time_point now) {
+        const size_t n = endpoints_.size();
+        if (config_.policy == tcp_balance_policy::least_outstanding_bytes) {
+            endpoint_state *best = nullptr;
+            size_t best_outstanding = 0;
+            for (size_t i = 0; i < n; i++) {
+                // start from the round robin position so ties are spread evenly
+                auto *ep = endpoints_[(next_ + i) % n].get();
+                if (!ep->available(now)) {
+                    continue;
+                }
+                auto outstanding = ep->client.outstanding_bytes();
+                if (best == nullptr || outstanding < best_outstanding) {
+                    best = ep;
+                    best_outstanding = outstanding;
+                }
+            }
+            next_ = (next_ + 1) % n;
+            return best;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            auto idx = (next_ + i) % n;
+            if (endpoints_[idx]->available(now)) {
+                next_ = (idx + 1) % n;
+                return endpoints_[idx].get();
+            }
+        }
+        return nullptr;
+    }
+
+    void send_to_(endpoint_state &ep, const char *data, size_t size) {
+        if (!ep.client.is_connected()) {
+            ep.client.connect(ep.endpoint.host, ep.endpoint.port, config_.send_timeout);
+            ep.client.set_send_timeout(config_.send_timeout);
+        }
+        ep.client.send(data, size);
+        ep.batches_sent++;
+    }
+
+    // send the pending batch to the first endpoint that accepts it.
+    // endpoints that fail are ejected. throw if no endpoint accepted the batch.
+    void send_pending_() {
+        if (pending_.size() == 0) {
+            return;
+        }
+        // stored frames don't depend on the stream before them, so the same frame can go to any
+        // endpoint
+        string_view_t batch(pending_.data(), pending_.size());
+        if (config_.framed) {
+            framed_.clear();
+            details::frame_encoder(details::frame_codec::stored)
+                .encode(batch, static_cast<uint32_t>(pending_records_), framed_);
+            batch = string_view_t(framed_.data(), framed_.size());
+        }
+        pending_records_ = 0;
+        for (size_t attempt = 0; attempt < endpoints_.size(); attempt++) {
+            auto now = clock::now();
+            auto *ep = pick_endpoint_(now);
+            if (ep == nullptr) {
+                break;
+            }
+            bool sent = false;
+            SPDLOG_TRY {
+                send_to_(*ep, batch.data(), batch.size());
+                sent = true;
+            }
+            SPDLOG_CATCH_STD
+            if (sent) {
+                pending_.clear();
+                return;
+            }
+            ep->client.close();
+            ep->ejected_until = clock::now() + config_.eject_duration;
+        }
+        pending_.clear();
+        throw_spdlog_ex("tcp_pool_sink: no healthy endpoint available, batch dropped");
+    }
+
+    tcp_pool_sink_config config_;
+    std::vector<std::unique_ptr<endpoint_state>> endpoints_;
+    size_t next_ = 0;
+    spdlog::memory_buf_t pending_;
+    size_t pending_records_ = 0;
+    spdlog::memory_buf_t framed_;
+};
+
+using tcp_pool_sink_mt = tcp_pool_sink<std::mutex>;
+using tcp_pool_sink_st = tcp_pool_sink<spdlog::details::null_mutex>;
+
+}  // namespace sinks
+
+//
+// factory functions
+//
+template <typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> tcp_pool_logger_mt(const std::string &logger_name,
+                                                  sinks::tcp_pool_sink_config sink_config) {
+    return Factory::template create<sinks::tcp_pool_sink_mt>(logger_name, std::move(sink_config));
+}
+
+}  // namespace spdlog
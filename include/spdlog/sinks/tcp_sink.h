@@ -4,6 +4,7 @@
 #pragma once
 
 #include <spdlog/common.h>
+#include <spdlog/details/frame_codec.h>
 #include <spdlog/details/null_mutex.h>
 #include <spdlog/sinks/base_sink.h>
 #ifdef _WIN32
@@ -11,6 +12,9 @@
 #else
     #include <spdlog/details/tcp_client.h>
 #endif
+#ifdef SPDLOG_OPENSSL
+    #include <spdlog/details/tls_client.h>
+#endif
 
 #include <chrono>
 #include <functional>
@@ -24,14 +28,38 @@
 // Will attempt to reconnect if connection drops.
 // If more complicated behaviour is needed (i.e get responses), you can inherit it and override the
 // sink_it_ method.
+//
+// If compiled with SPDLOG_OPENSSL and use_tls is set, the connection is encrypted with TLS.
+// In TLS mode messages are coalesced into records of up to tls.record_size bytes instead of
+// one record per message; pending messages are sent when the record is full or on flush().
+//
+// With framing set (see tcp_framing) messages are coalesced into batches of up to frame_size
+// bytes, and each batch is sent as a length framed (and possibly compressed) frame, see
+// details/frame_codec.h for the format and for frame_decoder, which decodes it on the collector
+// side. Pending messages are sent when the batch is full or on flush(). Each connection is a new
+// compression stream.
 
 namespace spdlog {
 namespace sinks {
 
+enum class tcp_framing {
+    none,    // send the formatted messages as is
+    stored,  // send frames of uncompressed batches
+    zstd,    // send frames of zstd compressed batches (requires SPDLOG_ZSTD)
+    lz4      // send frames of lz4 compressed batches (requires SPDLOG_LZ4)
+};
+
 struct tcp_sink_config {
     std::string server_host;
     int server_port;
     bool lazy_connect = false;  // if true connect on first log call instead of on construction
+    tcp_framing framing = tcp_framing::none;
+    size_t frame_size = 64 * 1024;  // framed modes: send a frame when this many bytes are pending
+    int compression_level = 0;      // framed modes: zstd level or lz4 acceleration (0 - default)
+#ifdef SPDLOG_OPENSSL
+    bool use_tls = false;  // if true encrypt the connection using the tls options below
+    details::tls_config tls;
+#endif
 
     tcp_sink_config(std::string host, int port)
         : server_host{std::move(host)},
@@ -46,15 +74,53 @@ public:
 
     explicit tcp_sink(tcp_sink_config sink_config)
         : config_{std::move(sink_config)} {
+        if (config_.framing != tcp_framing::none) {
+            encoder_ = details::make_unique<details::frame_encoder>(frame_codec_(config_.framing),
+                                                                    config_.compression_level);
+        }
+#ifdef SPDLOG_OPENSSL
+        if (config_.use_tls) {
+            tls_client_ = details::make_unique<details::tls_client>(config_.tls);
+            if (!config_.lazy_connect) {
+                tls_client_->connect(config_.server_host, config_.server_port);
+            }
+            return;
+        }
+#endif
         if (!config_.lazy_connect) {
             this->client_.connect(config_.server_host, config_.server_port);
         }
     }
 
-    ~tcp_sink() override = default;
+    ~tcp_sink() override {
+        SPDLOG_TRY {
+            send_frame_();
+#ifdef SPDLOG_OPENSSL
+            tls_send_pending_();
+#endif
+        }
+        SPDLOG_CATCH_STD
+    }
 
 protected:
     void sink_it_(const spdlog::details::log_msg &msg) override {
+        if (encoder_) {
+            spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, frame_pending_);
+            frame_records_++;
+            if (frame_pending_.size() >= config_.frame_size) {
+                send_frame_();
+            }
+            return;
+        }
+#ifdef SPDLOG_OPENSSL
+        if (tls_client_) {
+            spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, tls_pending_);
+            if (tls_pending_.size() >= config_.tls.record_size) {
+                tls_send_pending_();
+            }
+            return;
+        }
+#endif
         spdlog::memory_buf_t formatted;
         spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
         if (!client_.is_connected()) {
@@ -63,9 +129,86 @@ protected:
         client_.send(formatted.data(), formatted.size());
     }
 
-    void flush_() override {}
+    static details::frame_codec frame_codec_(tcp_framing framing) {
+        switch (framing) {
+            case tcp_framing::zstd:
+                return details::frame_codec::zstd;
+            case tcp_framing::lz4:
+                return details::frame_codec::lz4;
+            default:
+                return details::frame_codec::stored;
+        }
+    }
+
+    // encode the pending messages into a frame and send it
+    void send_frame_() {
+        if (!encoder_ || frame_records_ == 0) {
+            return;
+        }
+        // on failure the pending messages are lost, as in unframed mode
+        frame_out_.clear();
+        bool connected;
+#ifdef SPDLOG_OPENSSL
+        connected = tls_client_ ? tls_client_->is_connected() : client_.is_connected();
+#else
+        connected = client_.is_connected();
+#endif
+        if (!connected) {
+            // new connection, new compression stream
+            encoder_->reset();
+        }
+        auto records = static_cast<uint32_t>(frame_records_);
+        frame_records_ = 0;
+        encoder_->encode(string_view_t(frame_pending_.data(), frame_pending_.size()), records,
+                         frame_out_);
+        frame_pending_.clear();
+#ifdef SPDLOG_OPENSSL
+        if (tls_client_) {
+            if (!connected) {
+                tls_client_->connect(config_.server_host, config_.server_port);
+            }
+            tls_client_->send(frame_out_.data(), frame_out_.size());
+            return;
+        }
+#endif
+        if (!connected) {
+            client_.connect(config_.server_host, config_.server_port);
+        }
+        client_.send(frame_out_.data(), frame_out_.size());
+    }
+
+#ifdef SPDLOG_OPENSSL
+    void flush_() override {
+        send_frame_();
+        tls_send_pending_();
+    }
+
+    void tls_send_pending_() {
+        if (!tls_client_ || tls_pending_.size() == 0) {
+            return;
+        }
+        // on failure the pending messages are lost, as in non tls mode.
+        // clear() keeps the underlying storage, so data stays valid for the send below.
+        auto *data = tls_pending_.data();
+        auto size = tls_pending_.size();
+        tls_pending_.clear();
+        if (!tls_client_->is_connected()) {
+            tls_client_->connect(config_.server_host, config_.server_port);
+        }
+        tls_client_->send(data, size);
+    }
+
+    std::unique_ptr<details::tls_client> tls_client_;
+    spdlog::memory_buf_t tls_pending_;
+#else
+    void flush_() override { send_frame_(); }
+#endif
     tcp_sink_config config_;
     details::tcp_client client_;
+    std::unique_ptr<details::frame_encoder> encoder_;  // framed modes only
+    spdlog::memory_buf_t frame_pending_;
+    size_t frame_records_ = 0;
+    spdlog::memory_buf_t frame_out_;
 };
 
 using tcp_sink_mt = tcp_sink<std::mutex>;
@@ -16,9 +16,13 @@
 #include <functional>
 #include <mutex>
 #include <string>
+#include <vector>
 
 // Simple udp client sink
-// Sends formatted log via udp
+// Sends formatted log via udp.
+// If batch_size > 1, formatted messages are accumulated and sent as separate
+// datagrams in a single sendmmsg(2) call (linux) once batch_size messages are
+// pending or on flush().
 
 namespace spdlog {
 namespace sinks {
@@ -26,6 +30,7 @@ namespace sinks {
 struct udp_sink_config {
     std::string server_host;
     uint16_t server_port;
+    size_t batch_size = 1;  // number of datagrams to accumulate before sending them
 
     udp_sink_config(std::string host, uint16_t port)
         : server_host{std::move(host)},
@@ -37,19 +42,60 @@ class udp_sink : public spdlog::sinks::base_sink<Mutex> {
 public:
     // host can be hostname or ip address
     explicit udp_sink(udp_sink_config sink_config)
-        : client_{sink_config.server_host, sink_config.server_port} {}
+        : client_{sink_config.server_host, sink_config.server_port},
+          batch_size_{sink_config.batch_size} {
+        if (batch_size_ > 1) {
+            lengths_.reserve(batch_size_);
+        }
+    }
+
+    ~udp_sink() override {
+        SPDLOG_TRY { send_pending_(); }
+        SPDLOG_CATCH_STD
+    }
 
-    ~udp_sink() override = default;
+    // number of datagrams dropped because the socket buffer was full or the
+    // destination refused them.
+    size_t dropped_messages() const { return client_.dropped_count(); }
 
 protected:
     void sink_it_(const spdlog::details::log_msg &msg) override {
-        spdlog::memory_buf_t formatted;
-        spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
-        client_.send(formatted.data(), formatted.size());
+        if (batch_size_ <= 1) {
+            spdlog::memory_buf_t formatted;
+            spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, formatted);
+            client_.send(formatted.data(), formatted.size());
+            return;
+        }
+
+        auto old_size = pending_.size();
+        spdlog::sinks::base_sink<Mutex>::formatter_->format(msg, pending_);
+        lengths_.push_back(pending_.size() - old_size);
+        if (lengths_.size() >= batch_size_) {
+            send_pending_();
+        }
+    }
+
+    void flush_() override { send_pending_(); }
+
+    void send_pending_() {
+        if (lengths_.empty()) {
+            return;
+        }
+        // clear the batch even if sending throws, so a bad batch is not resent forever
+        struct batch_clear {
+            udp_sink &sink;
+            ~batch_clear() {
+                sink.pending_.clear();
+                sink.lengths_.clear();
+            }
+        } clear_on_exit{*this};
+        client_.send_batch(pending_.data(), lengths_.data(), lengths_.size());
     }
 
-    void flush_() override {}
     details::udp_client client_;
+    size_t batch_size_;
+    spdlog::memory_buf_t pending_;
+    std::vector<size_t> lengths_;
 };
 
 using udp_sink_mt = udp_sink<std::mutex>;
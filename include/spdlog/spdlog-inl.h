@@ -63,6 +63,32 @@ SPDLOG_INLINE void apply_all(const std::function<void(std::shared_ptr<logger>)>
     details::registry::instance().apply_all(fun);
 }
 
+#ifdef SPDLOG_PROFILE
+SPDLOG_INLINE std::vector<profile_entry> profile_report() {
+    return details::registry::instance().profile_report();
+}
+
+SPDLOG_INLINE std::string format_profile_report(const std::vector<profile_entry> &report) {
+    static const char *stages[] = {"vformat", "pattern_format", "lock_wait", "write", "flush"};
+    std::string table = fmt_lib::format("{:<20} {:<10} {:<15} {:>12} {:>16} {:>10}\n", "logger",
+                                        "sink", "stage", "calls", "ticks", "ticks/call");
+    for (auto &e : report) {
+        for (size_t i = 0; i < profile_counters::n_stages; i++) {
+            auto calls = e.counters.calls[i];
+            if (calls == 0) {
+                continue;
+            }
+            auto ticks = e.counters.ticks[i];
+            table += fmt_lib::format("{:<20} {:<10} {:<15} {:>12} {:>16} {:>10}\n", e.logger,
+                                     e.sink, stages[i], calls, ticks, ticks / calls);
+        }
+    }
+    return table;
+}
+
+SPDLOG_INLINE void reset_profile() { details::profiler::reset(); }
+#endif
+
 SPDLOG_INLINE void drop(const std::string &name) { details::registry::instance().drop(name); }
 
 SPDLOG_INLINE void drop_all() { details::registry::instance().drop_all(); }
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <spdlog/common.h>
+#include <spdlog/details/log_limiter.h>
 #include <spdlog/details/registry.h>
 #include <spdlog/details/synchronous_factory.h>
 #include <spdlog/logger.h>
@@ -98,6 +99,19 @@ SPDLOG_API void register_logger(std::shared_ptr<logger> logger);
 // spdlog::apply_all([&](std::shared_ptr<spdlog::logger> l) {l->flush();});
 SPDLOG_API void apply_all(const std::function<void(std::shared_ptr<logger>)> &fun);
 
+#ifdef SPDLOG_PROFILE
+// Self profiling report: the cpu ticks spent in each stage of logging, by registered logger
+// (vformat) and by sink of each logger (pattern_format, lock_wait, write, flush).
+// A sink shared by several loggers shows its totals under each of them.
+SPDLOG_API std::vector<profile_entry> profile_report();
+
+// The report as a table, with the ticks per call of each stage
+SPDLOG_API std::string format_profile_report(const std::vector<profile_entry> &report);
+
+// Zero the profile counters
+SPDLOG_API void reset_profile();
+#endif
+
 // Drop the reference to the given logger
 SPDLOG_API void drop(const std::string &name);
 
@@ -286,63 +300,229 @@ inline void critical(const T &msg) {
 #ifndef SPDLOG_NO_SOURCE_LOC
     #define SPDLOG_LOGGER_CALL(logger, level, ...) \
         (logger)->log(spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, level, __VA_ARGS__)
+    #define SPDLOG_CALL_SITE_LOC spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}
 #else
     #define SPDLOG_LOGGER_CALL(logger, level, ...) \
         (logger)->log(spdlog::source_loc{}, level, __VA_ARGS__)
+    #define SPDLOG_CALL_SITE_LOC spdlog::source_loc{}
 #endif
 
+//
+// rate controlled logging, the state is kept per call site (see details/log_limiter.h):
+// SPDLOG_LOGGER_INFO_EVERY_N(logger, n, ...)   - log the 1st, n+1th, 2n+1th.. calls
+// SPDLOG_LOGGER_INFO_FIRST_N(logger, n, ...)   - log the first n calls
+// SPDLOG_LOGGER_INFO_ONCE(logger, ...)         - log the first call
+// SPDLOG_LOGGER_INFO_EVERY_MS(logger, ms, ...) - log at most once every ms milliseconds
+// and the same for the other levels, and SPDLOG_INFO_EVERY_N(n, ...).. for the default logger.
+// the arguments of suppressed calls are not evaluated. a message logged after suppressed calls
+// (EVERY_N, EVERY_MS) ends with " (<count> skipped)". calls below the logger's level are not
+// counted, so they don't use up the limit.
+//
+#define SPDLOG_LOGGER_CALL_LIMITED(logger, level, limiter, limit, ...)                        \
+    do {                                                                                      \
+        static spdlog::details::limiter spdlog_limiter_;                                      \
+        auto &&spdlog_logger_ = (logger);                                                     \
+        size_t spdlog_skipped_ = 0;                                                           \
+        if ((spdlog_logger_->should_log(level) || spdlog_logger_->should_backtrace()) &&      \
+            spdlog_limiter_.allow(limit, spdlog_skipped_)) {                                  \
+            spdlog::details::log_limited(spdlog_logger_, SPDLOG_CALL_SITE_LOC, level,         \
+                                         spdlog_skipped_, __VA_ARGS__);                       \
+        }                                                                                     \
+    } while (0)
+
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
     #define SPDLOG_LOGGER_TRACE(logger, ...) \
         SPDLOG_LOGGER_CALL(logger, spdlog::level::trace, __VA_ARGS__)
     #define SPDLOG_TRACE(...) SPDLOG_LOGGER_TRACE(spdlog::default_logger_raw(), __VA_ARGS__)
+    #define SPDLOG_LOGGER_TRACE_EVERY_N(logger, n, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::trace, every_n_limiter, n, __VA_ARGS__)
+    #define SPDLOG_LOGGER_TRACE_FIRST_N(logger, n, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::trace, first_n_limiter, n, __VA_ARGS__)
+    #define SPDLOG_LOGGER_TRACE_ONCE(logger, ...) \
+        SPDLOG_LOGGER_TRACE_FIRST_N(logger, 1, __VA_ARGS__)
+    #define SPDLOG_LOGGER_TRACE_EVERY_MS(logger, ms, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::trace, every_ms_limiter, ms, __VA_ARGS__)
+    #define SPDLOG_TRACE_EVERY_N(n, ...) \
+        SPDLOG_LOGGER_TRACE_EVERY_N(spdlog::default_logger_raw(), n, __VA_ARGS__)
+    #define SPDLOG_TRACE_FIRST_N(n, ...) \
+        SPDLOG_LOGGER_TRACE_FIRST_N(spdlog::default_logger_raw(), n, __VA_ARGS__)
+    #define SPDLOG_TRACE_ONCE(...) \
+        SPDLOG_LOGGER_TRACE_ONCE(spdlog::default_logger_raw(), __VA_ARGS__)
+    #define SPDLOG_TRACE_EVERY_MS(ms, ...) \
+        SPDLOG_LOGGER_TRACE_EVERY_MS(spdlog::default_logger_raw(), ms, __VA_ARGS__)
 #else
     #define SPDLOG_LOGGER_TRACE(logger, ...) (void)0
     #define SPDLOG_TRACE(...) (void)0
+    #define SPDLOG_LOGGER_TRACE_EVERY_N(logger, n, ...) (void)0
+    #define SPDLOG_LOGGER_TRACE_FIRST_N(logger, n, ...) (void)0
+    #define SPDLOG_LOGGER_TRACE_ONCE(logger, ...) (void)0
+    #define SPDLOG_LOGGER_TRACE_EVERY_MS(logger, ms, ...) (void)0
+    #define SPDLOG_TRACE_EVERY_N(n, ...) (void)0
+    #define SPDLOG_TRACE_FIRST_N(n, ...) (void)0
+    #define SPDLOG_TRACE_ONCE(...) (void)0
+    #define SPDLOG_TRACE_EVERY_MS(ms, ...) (void)0
 #endif
 
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
     #define SPDLOG_LOGGER_DEBUG(logger, ...) \
         SPDLOG_LOGGER_CALL(logger, spdlog::level::debug, __VA_ARGS__)
     #define SPDLOG_DEBUG(...) SPDLOG_LOGGER_DEBUG(spdlog::default_logger_raw(), __VA_ARGS__)
+    #define SPDLOG_LOGGER_DEBUG_EVERY_N(logger, n, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::debug, every_n_limiter, n, __VA_ARGS__)
+    #define SPDLOG_LOGGER_DEBUG_FIRST_N(logger, n, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::debug, first_n_limiter, n, __VA_ARGS__)
+    #define SPDLOG_LOGGER_DEBUG_ONCE(logger, ...) \
+        SPDLOG_LOGGER_DEBUG_FIRST_N(logger, 1, __VA_ARGS__)
+    #define SPDLOG_LOGGER_DEBUG_EVERY_MS(logger, ms, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::debug, every_ms_limiter, ms, __VA_ARGS__)
+    #define SPDLOG_DEBUG_EVERY_N(n, ...) \
+        SPDLOG_LOGGER_DEBUG_EVERY_N(spdlog::default_logger_raw(), n, __VA_ARGS__)
+    #define SPDLOG_DEBUG_FIRST_N(n, ...) \
+        SPDLOG_LOGGER_DEBUG_FIRST_N(spdlog::default_logger_raw(), n, __VA_ARGS__)
+    #define SPDLOG_DEBUG_ONCE(...) \
+        SPDLOG_LOGGER_DEBUG_ONCE(spdlog::default_logger_raw(), __VA_ARGS__)
+    #define SPDLOG_DEBUG_EVERY_MS(ms, ...) \
+        SPDLOG_LOGGER_DEBUG_EVERY_MS(spdlog::default_logger_raw(), ms, __VA_ARGS__)
 #else
     #define SPDLOG_LOGGER_DEBUG(logger, ...) (void)0
     #define SPDLOG_DEBUG(...) (void)0
+    #define SPDLOG_LOGGER_DEBUG_EVERY_N(logger, n, ...) (void)0
+    #define SPDLOG_LOGGER_DEBUG_FIRST_N(logger, n, ...) (void)0
+    #define SPDLOG_LOGGER_DEBUG_ONCE(logger, ...) (void)0
+    #define SPDLOG_LOGGER_DEBUG_EVERY_MS(logger, ms, ...) (void)0
+    #define SPDLOG_DEBUG_EVERY_N(n, ...) (void)0
+    #define SPDLOG_DEBUG_FIRST_N(n, ...) (void)0
+    #define SPDLOG_DEBUG_ONCE(...) (void)0
+    #define SPDLOG_DEBUG_EVERY_MS(ms, ...) (void)0
 #endif
 
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
     #define SPDLOG_LOGGER_INFO(logger, ...) \
         SPDLOG_LOGGER_CALL(logger, spdlog::level::info, __VA_ARGS__)
     #define SPDLOG_INFO(...) SPDLOG_LOGGER_INFO(spdlog::default_logger_raw(), __VA_ARGS__)
+    #define SPDLOG_LOGGER_INFO_EVERY_N(logger, n, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::info, every_n_limiter, n, __VA_ARGS__)
+    #define SPDLOG_LOGGER_INFO_FIRST_N(logger, n, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::info, first_n_limiter, n, __VA_ARGS__)
+    #define SPDLOG_LOGGER_INFO_ONCE(logger, ...) SPDLOG_LOGGER_INFO_FIRST_N(logger, 1, __VA_ARGS__)
+    #define SPDLOG_LOGGER_INFO_EVERY_MS(logger, ms, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::info, every_ms_limiter, ms, __VA_ARGS__)
+    #define SPDLOG_INFO_EVERY_N(n, ...) \
+        SPDLOG_LOGGER_INFO_EVERY_N(spdlog::default_logger_raw(), n, __VA_ARGS__)
+    #define SPDLOG_INFO_FIRST_N(n, ...) \
+        SPDLOG_LOGGER_INFO_FIRST_N(spdlog::default_logger_raw(), n, __VA_ARGS__)
+    #define SPDLOG_INFO_ONCE(...) SPDLOG_LOGGER_INFO_ONCE(spdlog::default_logger_raw(), __VA_ARGS__)
+    #define SPDLOG_INFO_EVERY_MS(ms, ...) \
+        SPDLOG_LOGGER_INFO_EVERY_MS(spdlog::default_logger_raw(), ms, __VA_ARGS__)
 #else
     #define SPDLOG_LOGGER_INFO(logger, ...) (void)0
     #define SPDLOG_INFO(...) (void)0
+    #define SPDLOG_LOGGER_INFO_EVERY_N(logger, n, ...) (void)0
+    #define SPDLOG_LOGGER_INFO_FIRST_N(logger, n, ...) (void)0
+    #define SPDLOG_LOGGER_INFO_ONCE(logger, ...) (void)0
+    #define SPDLOG_LOGGER_INFO_EVERY_MS(logger, ms, ...) (void)0
+    #define SPDLOG_INFO_EVERY_N(n, ...) (void)0
+    #define SPDLOG_INFO_FIRST_N(n, ...) (void)0
+    #define SPDLOG_INFO_ONCE(...) (void)0
+    #define SPDLOG_INFO_EVERY_MS(ms, ...) (void)0
 #endif
 
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
     #define SPDLOG_LOGGER_WARN(logger, ...) \
         SPDLOG_LOGGER_CALL(logger, spdlog::level::warn, __VA_ARGS__)
     #define SPDLOG_WARN(...) SPDLOG_LOGGER_WARN(spdlog::default_logger_raw(), __VA_ARGS__)
+    #define SPDLOG_LOGGER_WARN_EVERY_N(logger, n, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::warn, every_n_limiter, n, __VA_ARGS__)
+    #define SPDLOG_LOGGER_WARN_FIRST_N(logger, n, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::warn, first_n_limiter, n, __VA_ARGS__)
+    #define SPDLOG_LOGGER_WARN_ONCE(logger, ...) SPDLOG_LOGGER_WARN_FIRST_N(logger, 1, __VA_ARGS__)
+    #define SPDLOG_LOGGER_WARN_EVERY_MS(logger, ms, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::warn, every_ms_limiter, ms, __VA_ARGS__)
+    #define SPDLOG_WARN_EVERY_N(n, ...) \
+        SPDLOG_LOGGER_WARN_EVERY_N(spdlog::default_logger_raw(), n, __VA_ARGS__)
+    #define SPDLOG_WARN_FIRST_N(n, ...) \
+        SPDLOG_LOGGER_WARN_FIRST_N(spdlog::default_logger_raw(), n, __VA_ARGS__)
+    #define SPDLOG_WARN_ONCE(...) SPDLOG_LOGGER_WARN_ONCE(spdlog::default_logger_raw(), __VA_ARGS__)
+    #define SPDLOG_WARN_EVERY_MS(ms, ...) \
+        SPDLOG_LOGGER_WARN_EVERY_MS(spdlog::default_logger_raw(), ms, __VA_ARGS__)
 #else
     #define SPDLOG_LOGGER_WARN(logger, ...) (void)0
     #define SPDLOG_WARN(...) (void)0
+    #define SPDLOG_LOGGER_WARN_EVERY_N(logger, n, ...) (void)0
+    #define SPDLOG_LOGGER_WARN_FIRST_N(logger, n, ...) (void)0
+    #define SPDLOG_LOGGER_WARN_ONCE(logger, ...) (void)0
+    #define SPDLOG_LOGGER_WARN_EVERY_MS(logger, ms, ...) (void)0
+    #define SPDLOG_WARN_EVERY_N(n, ...) (void)0
+    #define SPDLOG_WARN_FIRST_N(n, ...) (void)0
+    #define SPDLOG_WARN_ONCE(...) (void)0
+    #define SPDLOG_WARN_EVERY_MS(ms, ...) (void)0
 #endif
 
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_ERROR
     #define SPDLOG_LOGGER_ERROR(logger, ...) \
         SPDLOG_LOGGER_CALL(logger, spdlog::level::err, __VA_ARGS__)
     #define SPDLOG_ERROR(...) SPDLOG_LOGGER_ERROR(spdlog::default_logger_raw(), __VA_ARGS__)
+    #define SPDLOG_LOGGER_ERROR_EVERY_N(logger, n, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::err, every_n_limiter, n, __VA_ARGS__)
+    #define SPDLOG_LOGGER_ERROR_FIRST_N(logger, n, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::err, first_n_limiter, n, __VA_ARGS__)
+    #define SPDLOG_LOGGER_ERROR_ONCE(logger, ...) \
+        SPDLOG_LOGGER_ERROR_FIRST_N(logger, 1, __VA_ARGS__)
+    #define SPDLOG_LOGGER_ERROR_EVERY_MS(logger, ms, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::err, every_ms_limiter, ms, __VA_ARGS__)
+    #define SPDLOG_ERROR_EVERY_N(n, ...) \
+        SPDLOG_LOGGER_ERROR_EVERY_N(spdlog::default_logger_raw(), n, __VA_ARGS__)
+    #define SPDLOG_ERROR_FIRST_N(n, ...) \
+        SPDLOG_LOGGER_ERROR_FIRST_N(spdlog::default_logger_raw(), n, __VA_ARGS__)
+    #define SPDLOG_ERROR_ONCE(...) \
+        SPDLOG_LOGGER_ERROR_ONCE(spdlog::default_logger_raw(), __VA_ARGS__)
+    #define SPDLOG_ERROR_EVERY_MS(ms, ...) \
+        SPDLOG_LOGGER_ERROR_EVERY_MS(spdlog::default_logger_raw(), ms, __VA_ARGS__)
 #else
     #define SPDLOG_LOGGER_ERROR(logger, ...) (void)0
     #define SPDLOG_ERROR(...) (void)0
+    #define SPDLOG_LOGGER_ERROR_EVERY_N(logger, n, ...) (void)0
+    #define SPDLOG_LOGGER_ERROR_FIRST_N(logger, n, ...) (void)0
+    #define SPDLOG_LOGGER_ERROR_ONCE(logger, ...) (void)0
+    #define SPDLOG_LOGGER_ERROR_EVERY_MS(logger, ms, ...) (void)0
+    #define SPDLOG_ERROR_EVERY_N(n, ...) (void)0
+    #define SPDLOG_ERROR_FIRST_N(n, ...) (void)0
+    #define SPDLOG_ERROR_ONCE(...) (void)0
+    #define SPDLOG_ERROR_EVERY_MS(ms, ...) (void)0
 #endif
 
 #if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_CRITICAL
     #define SPDLOG_LOGGER_CRITICAL(logger, ...) \
         SPDLOG_LOGGER_CALL(logger, spdlog::level::critical, __VA_ARGS__)
     #define SPDLOG_CRITICAL(...) SPDLOG_LOGGER_CRITICAL(spdlog::default_logger_raw(), __VA_ARGS__)
+    #define SPDLOG_LOGGER_CRITICAL_EVERY_N(logger, n, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::critical, every_n_limiter, n, __VA_ARGS__)
+    #define SPDLOG_LOGGER_CRITICAL_FIRST_N(logger, n, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::critical, first_n_limiter, n, __VA_ARGS__)
+    #define SPDLOG_LOGGER_CRITICAL_ONCE(logger, ...) \
+        SPDLOG_LOGGER_CRITICAL_FIRST_N(logger, 1, __VA_ARGS__)
+    #define SPDLOG_LOGGER_CRITICAL_EVERY_MS(logger, ms, ...) \
+        SPDLOG_LOGGER_CALL_LIMITED(logger, spdlog::level::critical, every_ms_limiter, ms, \
+                                   __VA_ARGS__)
+    #define SPDLOG_CRITICAL_EVERY_N(n, ...) \
+        SPDLOG_LOGGER_CRITICAL_EVERY_N(spdlog::default_logger_raw(), n, __VA_ARGS__)
+    #define SPDLOG_CRITICAL_FIRST_N(n, ...) \
+        SPDLOG_LOGGER_CRITICAL_FIRST_N(spdlog::default_logger_raw(), n, __VA_ARGS__)
+    #define SPDLOG_CRITICAL_ONCE(...) \
+        SPDLOG_LOGGER_CRITICAL_ONCE(spdlog::default_logger_raw(), __VA_ARGS__)
+    #define SPDLOG_CRITICAL_EVERY_MS(ms, ...) \
+        SPDLOG_LOGGER_CRITICAL_EVERY_MS(spdlog::default_logger_raw(), ms, __VA_ARGS__)
 #else
     #define SPDLOG_LOGGER_CRITICAL(logger, ...) (void)0
     #define SPDLOG_CRITICAL(...) (void)0
+    #define SPDLOG_LOGGER_CRITICAL_EVERY_N(logger, n, ...) (void)0
+    #define SPDLOG_LOGGER_CRITICAL_FIRST_N(logger, n, ...) (void)0
+    #define SPDLOG_LOGGER_CRITICAL_ONCE(logger, ...) (void)0
+    #define SPDLOG_LOGGER_CRITICAL_EVERY_MS(logger, ms, ...) (void)0
+    #define SPDLOG_CRITICAL_EVERY_N(n, ...) (void)0
+    #define SPDLOG_CRITICAL_FIRST_N(n, ...) (void)0
+    #define SPDLOG_CRITICAL_ONCE(...) (void)0
+    #define SPDLOG_CRITICAL_EVERY_MS(ms, ...) (void)0
 #endif
 
 #ifdef SPDLOG_HEADER_ONLY
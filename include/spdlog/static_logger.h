@@ -0,0 +1,268 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Logger with its formatter and sinks fixed at compile time.
+// The formatter (e.g. pattern_formatter, default constructed) and the sinks (see
+// sinks/static_sinks.h) are held by value, so logging makes no virtual calls and needs no
+// shared_ptr: each message is formatted once by the logger's formatter and the formatted buffer is
+// handed to every sink in turn, with calls the compiler can inline.
+//
+// Usage:
+//     using my_logger_t = spdlog::static_logger_mt<spdlog::pattern_formatter,
+//                                                  spdlog::sinks::static_file_sink>;
+//     my_logger_t my_logger("app", spdlog::sinks::static_file_sink("logs/app.txt"));
+//     my_logger.set_pattern("%H:%M:%S %v");
+//     my_logger.info("Hello {}", 1);
+//     SPDLOG_LOGGER_INFO(&my_logger, "Hello {}", 2);
+//
+// Unlike spdlog::logger it is not registered in the registry, has no backtrace support and its
+// sinks are fixed at construction.
+
+#include <spdlog/common.h>
+#include <spdlog/details/err_helper.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/os.h>
+#include <spdlog/logger.h>
+#include <spdlog/pattern_formatter.h>
+#include <spdlog/sinks/static_sinks.h>
+
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace spdlog {
+
+template <typename Mutex, typename Formatter, typename... Sinks>
+class basic_static_logger {
+public:
+    explicit basic_static_logger(std::string name, Sinks... sinks)
+        : name_(std::move(name)),
+          formatter_(),
+          sinks_(std::move(sinks)...) {}
+
+    basic_static_logger(const basic_static_logger &) = delete;
+    basic_static_logger &operator=(const basic_static_logger &) = delete;
+
+    bool should_log(level::level_enum msg_level) const {
+        return msg_level >= level_.load(std::memory_order_relaxed);
+    }
+
+    // no backtrace support (for the SPDLOG_LOGGER_* macros, which check it as they do on logger)
+    bool should_backtrace() const { return false; }
+
+    template <typename... Args>
+    void log(source_loc loc, level::level_enum lvl, format_string_t<Args...> fmt, Args &&...args) {
+        if (!should_log(lvl)) {
+            return;
+        }
+        SPDLOG_TRY {
+            memory_buf_t buf;
+#ifdef SPDLOG_USE_STD_FORMAT
+            fmt_lib::vformat_to(std::back_inserter(buf), details::to_string_view(fmt),
+                                fmt_lib::make_format_args(args...));
+#else
+            fmt::vformat_to(fmt::appender(buf), details::to_string_view(fmt),
+                            fmt::make_format_args(args...));
+#endif
+            details::log_msg log_msg(loc, name_, lvl, string_view_t(buf.data(), buf.size()));
+            sink_it_(log_msg);
+        }
+        SPDLOG_LOGGER_CATCH(loc)
+    }
+
+    template <typename... Args>
+    void log(level::level_enum lvl, format_string_t<Args...> fmt, Args &&...args) {
+        log(source_loc{}, lvl, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void log(level::level_enum lvl, const T &msg) {
+        log(source_loc{}, lvl, msg);
+    }
+
+    // T cannot be statically converted to format string (including string_view)
+    template <class T,
+              typename std::enable_if<!is_convertible_to_any_format_string<const T &>::value,
+                                      int>::type = 0>
+    void log(source_loc loc, level::level_enum lvl, const T &msg) {
+        log(loc, lvl, "{}", msg);
+    }
+
+    void log(source_loc loc, level::level_enum lvl, string_view_t msg) {
+        if (!should_log(lvl)) {
+            return;
+        }
+        SPDLOG_TRY {
+            details::log_msg log_msg(loc, name_, lvl, msg);
+            sink_it_(log_msg);
+        }
+        SPDLOG_LOGGER_CATCH(loc)
+    }
+
+    void log(level::level_enum lvl, string_view_t msg) { log(source_loc{}, lvl, msg); }
+
+    template <typename... Args>
+    void trace(format_string_t<Args...> fmt, Args &&...args) {
+        log(level::trace, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void debug(format_string_t<Args...> fmt, Args &&...args) {
+        log(level::debug, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void info(format_string_t<Args...> fmt, Args &&...args) {
+        log(level::info, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void warn(format_string_t<Args...> fmt, Args &&...args) {
+        log(level::warn, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void error(format_string_t<Args...> fmt, Args &&...args) {
+        log(level::err, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void critical(format_string_t<Args...> fmt, Args &&...args) {
+        log(level::critical, fmt, std::forward<Args>(args)...);
+    }
+
+    template <typename T>
+    void trace(const T &msg) {
+        log(level::trace, msg);
+    }
+
+    template <typename T>
+    void debug(const T &msg) {
+        log(level::debug, msg);
+    }
+
+    template <typename T>
+    void info(const T &msg) {
+        log(level::info, msg);
+    }
+
+    template <typename T>
+    void warn(const T &msg) {
+        log(level::warn, msg);
+    }
+
+    template <typename T>
+    void error(const T &msg) {
+        log(level::err, msg);
+    }
+
+    template <typename T>
+    void critical(const T &msg) {
+        log(level::critical, msg);
+    }
+
+    void set_level(level::level_enum log_level) { level_.store(log_level); }
+
+    level::level_enum level() const {
+        return static_cast<level::level_enum>(level_.load(std::memory_order_relaxed));
+    }
+
+    const std::string &name() const { return name_; }
+
+    // set the pattern of the formatter (Formatter must have a set_pattern() member).
+    void set_pattern(std::string pattern) {
+        std::lock_guard<Mutex> lock(mutex_);
+        formatter_.set_pattern(std::move(pattern));
+    }
+
+    // access the formatter, e.g. to add custom flags.
+    // not thread safe - the formatter must not be modified while other threads are logging.
+    Formatter &formatter() { return formatter_; }
+
+    void flush() {
+        SPDLOG_TRY {
+            std::lock_guard<Mutex> lock(mutex_);
+            flush_sinks_<0>();
+        }
+        SPDLOG_LOGGER_CATCH(source_loc())
+    }
+
+    void flush_on(level::level_enum log_level) { flush_level_.store(log_level); }
+
+    level::level_enum flush_level() const {
+        return static_cast<level::level_enum>(flush_level_.load(std::memory_order_relaxed));
+    }
+
+    // access the sink at the given index.
+    // not thread safe - the sink must not be modified while other threads are logging.
+    template <size_t I>
+    typename std::tuple_element<I, std::tuple<Sinks...>>::type &sink() {
+        return std::get<I>(sinks_);
+    }
+
+    // error handler
+    void set_error_handler(err_handler handler) { custom_err_handler_ = std::move(handler); }
+
+private:
+    std::string name_;
+    Formatter formatter_;
+    std::tuple<Sinks...> sinks_;
+    Mutex mutex_;
+    spdlog::level_t level_{level::info};
+    spdlog::level_t flush_level_{level::off};
+    err_handler custom_err_handler_{nullptr};
+
+    void sink_it_(const details::log_msg &msg) {
+        memory_buf_t formatted;
+        std::lock_guard<Mutex> lock(mutex_);
+        if (details::any_static_sink_needs_formatting<Sinks...>::value) {
+            formatter_.format(msg, formatted);
+        }
+        log_sinks_<0>(msg, formatted);
+        if (msg.level != level::off && msg.level >= flush_level_.load(std::memory_order_relaxed)) {
+            flush_sinks_<0>();
+        }
+    }
+
+    template <size_t I>
+    typename std::enable_if<(I < sizeof...(Sinks))>::type log_sinks_(
+        const details::log_msg &msg, const memory_buf_t &formatted) {
+        std::get<I>(sinks_).log(msg, formatted);
+        log_sinks_<I + 1>(msg, formatted);
+    }
+
+    template <size_t I>
+    typename std::enable_if<(I == sizeof...(Sinks))>::type log_sinks_(const details::log_msg &,
+                                                                      const memory_buf_t &) {}
+
+    template <size_t I>
+    typename std::enable_if<(I < sizeof...(Sinks))>::type flush_sinks_() {
+        std::get<I>(sinks_).flush();
+        flush_sinks_<I + 1>();
+    }
+
+    template <size_t I>
+    typename std::enable_if<(I == sizeof...(Sinks))>::type flush_sinks_() {}
+
+    // handle errors during logging.
+    // default handler prints the error to stderr at max rate of 1 message/sec.
+    void err_handler_(const std::string &msg) {
+        if (custom_err_handler_) {
+            custom_err_handler_(msg);
+        } else {
+            details::default_err_handler(name_, msg);
+        }
+    }
+};
+
+template <typename Formatter, typename... Sinks>
+using static_logger_mt = basic_static_logger<std::mutex, Formatter, Sinks...>;
+
+template <typename Formatter, typename... Sinks>
+using static_logger_st = basic_static_logger<details::null_mutex, Formatter, Sinks...>;
+
+}  // namespace spdlog
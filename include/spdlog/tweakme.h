@@ -19,6 +19,20 @@
 // #define SPDLOG_CLOCK_COARSE
 ///////////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////////
+// Elapsed time flags (%u %i %o %O %k %K) use a monotonic time point of the
+// message, by default derived from its wall clock time, so they follow NTP steps.
+// Uncomment to capture a monotonic timestamp with each message as well (one
+// more clock read per message):
+//
+// #define SPDLOG_MONOTONIC_TIMESTAMPS
+//
+// Or uncomment to capture only the monotonic timestamp and derive the wall clock
+// time from it (one clock read, but the wall time won't follow later NTP steps):
+//
+// #define SPDLOG_MONOTONIC_CLOCK_ONLY
+///////////////////////////////////////////////////////////////////////////////
+
 ///////////////////////////////////////////////////////////////////////////////
 // Uncomment if source location logging is not needed.
 // This will prevent spdlog from using __FILE__, __LINE__ and SPDLOG_FUNCTION
@@ -93,6 +107,28 @@
 #define SPDLOG_WCHAR_TO_UTF8_SUPPORT
 ///////////////////////////////////////////////////////////////////////////////
 
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to enable TLS support in tcp_sink (requires linking with OpenSSL)
+//
+// #define SPDLOG_OPENSSL
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to enable zstd / lz4 compressed framing in tcp_sink
+// (requires linking with libzstd / liblz4)
+//
+// #define SPDLOG_ZSTD
+// #define SPDLOG_LZ4
+///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to count the cpu ticks spent in each stage of logging (argument
+// formatting, pattern formatting, sink lock wait, write and flush), per logger
+// and sink. See spdlog::profile_report().
+//
+// #define SPDLOG_PROFILE
+///////////////////////////////////////////////////////////////////////////////
+
 ///////////////////////////////////////////////////////////////////////////////
 // Uncomment to prevent child processes from inheriting log file descriptors
 //
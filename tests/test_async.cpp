@@ -1,6 +1,7 @@
 #include "includes.h"
 #include "spdlog/async.h"
 #include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/callback_sink.h"
 #include "test_sink.h"
 
 #define TEST_FILENAME "test_logs/async_test.log"
@@ -242,3 +243,427 @@ TEST_CASE("bad_tp", "[async]") {
     logger->info("Please throw an exception");
     REQUIRE(test_sink->msg_counter() == 0);
 }
+
+static void count_release(void *context) { static_cast<std::atomic<size_t> *>(context)->fetch_add(1); }
+
+TEST_CASE("external payload", "[async]") {
+    static const char payload[] = "a payload that is not copied";
+    std::atomic<size_t> released{0};
+    std::vector<const char *> seen;
+    auto sink = std::make_shared<spdlog::sinks::callback_sink_mt>(
+        [&seen](const spdlog::details::log_msg &msg) { seen.push_back(msg.payload.data()); });
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(16, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("as", sink, tp);
+        logger->info(spdlog::external_payload(payload, count_release, &released));
+        logger->log(spdlog::level::info, spdlog::external_payload(payload));
+        // not logged - released right away
+        logger->debug(spdlog::external_payload(payload, count_release, &released));
+        logger->flush();
+        REQUIRE(released == 2);
+    }
+    REQUIRE(seen.size() == 2);
+    REQUIRE(seen[0] == payload);
+    REQUIRE(seen[1] == payload);
+}
+
+TEST_CASE("external payload overrun", "[async]") {
+    std::atomic<size_t> released{0};
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_delay(std::chrono::milliseconds(1));
+    size_t messages = 256;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(4, 1);
+        auto logger = std::make_shared<spdlog::async_logger>(
+            "as", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+        for (size_t i = 0; i < messages; i++) {
+            logger->info(spdlog::external_payload("Hello message", count_release, &released));
+        }
+    }
+    // dropped messages are released too
+    REQUIRE(test_sink->msg_counter() < messages);
+    REQUIRE(released == messages);
+}
+
+namespace {
+struct release_probe {
+    std::shared_ptr<spdlog::details::thread_pool> tp;
+    std::thread::id logging_thread;
+    std::atomic<size_t> released{0};
+    std::atomic<size_t> released_by_logging_thread{0};
+};
+}  // namespace
+
+// overrun payloads are released by the logging thread, outside of the queue lock
+static void probe_release(void *context) {
+    auto *probe = static_cast<release_probe *>(context);
+    if (std::this_thread::get_id() == probe->logging_thread) {
+        probe->released_by_logging_thread++;
+    }
+    (void)probe->tp->queue_size();  // takes the queue lock
+    probe->released++;
+}
+
+TEST_CASE("external payload overrun release", "[async]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_delay(std::chrono::milliseconds(1));
+    size_t messages = 256;
+    release_probe probe;
+    probe.logging_thread = std::this_thread::get_id();
+    {
+        probe.tp = std::make_shared<spdlog::details::thread_pool>(4, 1);
+        auto logger = std::make_shared<spdlog::async_logger>(
+            "as", test_sink, probe.tp, spdlog::async_overflow_policy::overrun_oldest);
+        for (size_t i = 0; i < messages; i++) {
+            logger->info(spdlog::external_payload("Hello message", probe_release, &probe));
+        }
+        logger->flush();
+        REQUIRE(probe.tp->overrun_counter() > 0);
+        REQUIRE(probe.released_by_logging_thread == probe.tp->overrun_counter());
+    }
+    probe.tp.reset();
+    REQUIRE(probe.released == messages);
+}
+
+TEST_CASE("external payload sync logger", "[async]") {
+    std::atomic<size_t> released{0};
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    test_sink->set_pattern("%v");
+    spdlog::logger logger("sync", test_sink);
+    logger.enable_backtrace(4);
+    logger.info(spdlog::external_payload("Hello", count_release, &released));
+    logger.debug(spdlog::external_payload("Hello backtrace", count_release, &released));
+    REQUIRE(released == 2);
+    logger.dump_backtrace();
+    REQUIRE(test_sink->lines()[0] == "Hello");
+    REQUIRE(test_sink->lines()[3] == "Hello backtrace");
+    REQUIRE(test_sink->msg_counter() == 5);
+}
+
+TEST_CASE("thread pool starts on first message", "[async]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    std::atomic<int> started_threads{0};
+    auto tp = std::make_shared<spdlog::details::thread_pool>(
+        16, 2, [&started_threads] { started_threads++; });
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp,
+                                                         spdlog::async_overflow_policy::block);
+    REQUIRE_FALSE(tp->started());
+    REQUIRE(tp->queue_size() == 0);
+    REQUIRE(tp->overrun_counter() == 0);
+
+    // flushing before any message flushes the sinks without starting the pool
+    logger->flush();
+    REQUIRE_FALSE(tp->started());
+    REQUIRE(started_threads == 0);
+    REQUIRE(test_sink->flush_counter() == 1);
+
+    logger->info("Hello message");
+    REQUIRE(tp->started());
+    logger->flush();
+    REQUIRE(test_sink->msg_counter() == 1);
+    // a thread might not have run its start callback yet. they all have once joined.
+    logger.reset();
+    tp.reset();
+    REQUIRE(started_threads == 2);
+}
+
+TEST_CASE("thread pool with prefaulted queue memory", "[async]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    spdlog::queue_memory_options mem_options;
+    mem_options.huge_pages = true;
+    mem_options.prefault = true;
+    mem_options.lock = true;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(1024, 1, mem_options);
+    // prefaulting allocates the queue right away
+    REQUIRE(tp->started());
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp,
+                                                         spdlog::async_overflow_policy::block);
+    for (int i = 0; i < 2000; i++) {
+        logger->info("Hello message #{}", i);
+    }
+    logger->flush();
+    REQUIRE(test_sink->msg_counter() == 2000);
+}
+
+TEST_CASE("byte ring queue", "[async]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("[%n] %v");
+    size_t messages = 1000;
+    {
+        spdlog::queue_memory_options mem_options;
+        mem_options.ring_bytes = 4096;
+        auto tp = std::make_shared<spdlog::details::thread_pool>(0, 1, mem_options);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp,
+                                                             spdlog::async_overflow_policy::block);
+        for (size_t i = 0; i < messages; i++) {
+            logger->info("Hello message #{}", i);
+        }
+        logger->flush();
+        REQUIRE(test_sink->msg_counter() == messages);
+        REQUIRE(tp->overrun_counter() == 0);
+        REQUIRE(tp->discard_counter() == 0);
+    }
+    REQUIRE(test_sink->msg_counter() == messages);
+    REQUIRE(test_sink->lines()[99] == "[as] Hello message #99");
+}
+
+TEST_CASE("byte ring queue external payload", "[async]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    std::atomic<size_t> released{0};
+    {
+        spdlog::queue_memory_options mem_options;
+        mem_options.ring_bytes = 1024;
+        auto tp = std::make_shared<spdlog::details::thread_pool>(0, 1, mem_options);
+        auto logger = std::make_shared<spdlog::async_logger>(
+            "as", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+        for (int i = 0; i < 100; i++) {
+            logger->info(spdlog::external_payload("static text", count_release, &released));
+        }
+    }
+    REQUIRE(test_sink->msg_counter() > 0);
+    REQUIRE(released == 100);
+    REQUIRE(test_sink->lines().back() == "static text");
+}
+
+TEST_CASE("byte ring queue overrun never blocks", "[async]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    {
+        spdlog::queue_memory_options mem_options;
+        mem_options.ring_bytes = 1024;
+        auto tp = std::make_shared<spdlog::details::thread_pool>(0, 1, mem_options);
+        auto logger = std::make_shared<spdlog::async_logger>(
+            "as", test_sink, tp, spdlog::async_overflow_policy::overrun_oldest);
+        test_sink->set_delay(std::chrono::milliseconds(300));
+        logger->info("slow message");
+        // wait for the worker to take it
+        while (tp->queue_size() > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        // the worker holds the oldest record, so the ring can't make room while it sleeps
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 200; i++) {
+            logger->info("Hello message #{}", i);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        REQUIRE(elapsed < std::chrono::milliseconds(150));
+        REQUIRE(tp->overrun_counter() > 0);
+        test_sink->set_delay(std::chrono::milliseconds(0));
+    }
+    REQUIRE(test_sink->msg_counter() > 1);
+}
+
+TEST_CASE("producer batching", "[async]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%v");
+    size_t n_threads = 4;
+    size_t messages = 100;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(64, 1);
+        tp->set_producer_batching(8, std::chrono::milliseconds(1000));
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp,
+                                                             spdlog::async_overflow_policy::block);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < n_threads; t++) {
+            threads.emplace_back([logger, messages, t] {
+                for (size_t i = 0; i < messages; i++) {
+                    logger->info("{} {}", t, i);
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        // the last partial batch of each thread was published when the thread exited
+        logger->flush();
+        REQUIRE(test_sink->msg_counter() == n_threads * messages);
+    }
+
+    // the messages of each thread keep their order
+    std::vector<size_t> next(n_threads, 0);
+    for (auto &line : test_sink->lines()) {
+        size_t t = 0, i = 0;
+        std::istringstream(line) >> t >> i;
+        REQUIRE(i == next[t]);
+        next[t]++;
+    }
+}
+
+TEST_CASE("producer batching flush and linger", "[async]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    auto tp = std::make_shared<spdlog::details::thread_pool>(64, 1);
+    tp->set_producer_batching(32, std::chrono::milliseconds(10));
+    auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp,
+                                                         spdlog::async_overflow_policy::block);
+
+    // a flush publishes the pending batch first
+    logger->info("message 1");
+    logger->flush();
+    REQUIRE(test_sink->msg_counter() == 1);
+
+    // a batch that doesn't fill up is published after the linger time
+    logger->info("message 2");
+    for (int i = 0; i < 500 && test_sink->msg_counter() < 2; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    REQUIRE(test_sink->msg_counter() == 2);
+}
+
+// check the sequence numbers of the lines ("<seq> <text>") are consecutive, counting the ones in
+// the "N messages dropped (seq a..b)" records. returns the number of dropped messages.
+static size_t check_sequence(const std::vector<std::string> &lines) {
+    uint64_t expected = 1;
+    size_t dropped = 0;
+    for (auto &line : lines) {
+        unsigned long long n = 0, a = 0, b = 0;
+        if (std::sscanf(line.c_str(), " %llu messages dropped (seq %llu..%llu)", &n, &a, &b) == 3) {
+            REQUIRE(a == expected);
+            REQUIRE(b - a + 1 == n);
+            expected = b + 1;
+            dropped += n;
+        } else {
+            REQUIRE(std::stoull(line) == expected);
+            expected++;
+        }
+    }
+    return dropped;
+}
+
+TEST_CASE("sequence numbers and gap records", "[async]") {
+    for (size_t ring_bytes : {size_t(0), size_t(512)}) {
+        for (auto policy : {spdlog::async_overflow_policy::overrun_oldest,
+                            spdlog::async_overflow_policy::discard_new}) {
+            auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+            test_sink->set_pattern("%q %v");
+            test_sink->set_delay(std::chrono::milliseconds(2));
+            size_t messages = 60;
+            size_t lost = 0;
+            {
+                spdlog::queue_memory_options mem_options;
+                mem_options.ring_bytes = ring_bytes;
+                auto tp = std::make_shared<spdlog::details::thread_pool>(4, 1, mem_options);
+                auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp, policy);
+                for (size_t i = 0; i < messages; i++) {
+                    logger->info("message #{}", i);
+                }
+                // the last message makes the worker report the drops before it
+                while (tp->queue_size() > 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                logger->info("last message");
+                logger->flush();
+                lost = tp->overrun_counter() + tp->discard_counter();
+            }
+            auto lines = test_sink->lines();
+            REQUIRE(lost > 0);
+            REQUIRE(check_sequence(lines) == lost);
+            REQUIRE(lines.back() == spdlog::fmt_lib::format("{} last message", messages + 1));
+        }
+    }
+}
+
+TEST_CASE("sequence numbers with concurrent producers", "[async]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    test_sink->set_pattern("%q %v");
+    size_t n_threads = 4;
+    size_t messages = 200;
+    {
+        auto tp = std::make_shared<spdlog::details::thread_pool>(16, 1);
+        auto logger = std::make_shared<spdlog::async_logger>("as", test_sink, tp,
+                                                             spdlog::async_overflow_policy::block);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < n_threads; t++) {
+            threads.emplace_back([logger, messages] {
+                for (size_t i = 0; i < messages; i++) {
+                    logger->info("message #{}", i);
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+    }
+    // no gap records: the numbers are given in queue order
+    REQUIRE(test_sink->msg_counter() == n_threads * messages);
+    REQUIRE(check_sequence(test_sink->lines()) == 0);
+}
+
+TEST_CASE("parallel formatting keeps the order", "[async]") {
+    for (size_t ring_bytes : {size_t(0), size_t(4096)}) {
+        std::ostringstream oss;
+        auto ostream_sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+        ostream_sink->set_pattern("%q %v");
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_pattern("%q %v");
+        size_t messages = 2000;
+        {
+            spdlog::queue_memory_options mem_options;
+            mem_options.ring_bytes = ring_bytes;
+            auto tp = std::make_shared<spdlog::details::thread_pool>(64, 4, mem_options);
+            tp->set_parallel_formatting(true);
+            auto logger = std::make_shared<spdlog::async_logger>(
+                "as", spdlog::sinks_init_list{ostream_sink, test_sink}, tp,
+                spdlog::async_overflow_policy::block);
+            for (size_t i = 0; i < messages / 2; i++) {
+                logger->info("message #{}", i);
+            }
+            logger->flush();
+            for (size_t i = messages / 2; i < messages; i++) {
+                logger->info("message #{}", i);
+            }
+        }
+        REQUIRE(test_sink->msg_counter() == messages);
+        REQUIRE(check_sequence(test_sink->lines()) == 0);
+
+        std::vector<std::string> lines;
+        std::istringstream iss(oss.str());
+        for (std::string line; std::getline(iss, line);) {
+            lines.push_back(line);
+        }
+        REQUIRE(lines.size() == messages);
+        REQUIRE(check_sequence(lines) == 0);
+        REQUIRE(lines.back() == spdlog::fmt_lib::format("{} message #{}", messages, messages - 1));
+    }
+}
+
+TEST_CASE("parallel formatting enabled after logging started", "[async]") {
+    for (size_t ring_bytes : {size_t(0), size_t(4096)}) {
+        auto test_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+        test_sink->set_pattern("%q %v");
+        size_t messages = 0;
+        {
+            spdlog::queue_memory_options mem_options;
+            mem_options.ring_bytes = ring_bytes;
+            auto tp = std::make_shared<spdlog::details::thread_pool>(64, 4, mem_options);
+            auto logger = std::make_shared<spdlog::async_logger>(
+                "as", test_sink, tp, spdlog::async_overflow_policy::block);
+            // on, off and on again, each after some traffic
+            for (bool enabled : {true, false, true}) {
+                for (size_t i = 0; i < 10; i++) {
+                    logger->info("message #{}", messages++);
+                }
+                logger->flush();
+                tp->set_parallel_formatting(enabled);
+            }
+            for (size_t i = 0; i < 30; i++) {
+                logger->info("message #{}", messages++);
+            }
+            logger->flush();
+        }
+        // no gap records, and the messages of the parallel periods (11..20 and 31..60) in order.
+        // the others are processed by 4 threads in any order.
+        REQUIRE(test_sink->msg_counter() == messages);
+        std::vector<uint64_t> sequences, ordered;
+        for (auto &line : test_sink->lines()) {
+            sequences.push_back(std::stoull(line));
+            if ((sequences.back() > 10 && sequences.back() <= 20) || sequences.back() > 30) {
+                ordered.push_back(sequences.back());
+            }
+        }
+        REQUIRE(std::is_sorted(ordered.begin(), ordered.end()));
+        std::sort(sequences.begin(), sequences.end());
+        for (size_t i = 0; i < sequences.size(); i++) {
+            REQUIRE(sequences[i] == i + 1);
+        }
+    }
+}
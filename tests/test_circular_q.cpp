@@ -47,4 +47,40 @@ TEST_CASE("test_empty", "[circular_q]") {
     q_type q(0);
     q.push_back(1);
     REQUIRE(q.empty());
-}
\ No newline at end of file
+}
+TEST_CASE("test_region_allocator", "[circular_q]") {
+    spdlog::queue_memory_options opts;
+    opts.huge_pages = true;
+    opts.prefault = true;
+    opts.lock = true;
+    const size_t q_size = 1024 * 1024;
+    spdlog::details::circular_q<size_t, spdlog::details::region_allocator<size_t>> q(
+        q_size, spdlog::details::region_allocator<size_t>(opts));
+    for (size_t i = 0; i < q_size + 2; i++) {
+        q.push_back(std::move(i));
+    }
+    REQUIRE(q.size() == q_size);
+    REQUIRE(q.front() == 2);
+    REQUIRE(q.at(q_size - 1) == q_size + 1);
+
+    auto moved = std::move(q);
+    REQUIRE(moved.front() == 2);
+    REQUIRE(q.empty());
+}
+
+TEST_CASE("test_memory_region", "[circular_q]") {
+    using spdlog::details::memory_region;
+    spdlog::queue_memory_options opts;
+    opts.huge_pages = true;
+    opts.prefault = true;
+    const size_t n = 3 * memory_region::huge_page_size + 5;
+    auto *p = static_cast<char *>(memory_region::allocate(n, opts));
+    REQUIRE(p != nullptr);
+    REQUIRE(reinterpret_cast<uintptr_t>(p) % memory_region::header_size == 0);
+    REQUIRE(memory_region::region_header(p).map_size >= n + memory_region::header_size);
+    REQUIRE_FALSE(memory_region::region_header(p).locked);
+    p[0] = 'a';
+    p[n - 1] = 'z';
+    REQUIRE(p[0] + p[n - 1] == 'a' + 'z');
+    memory_region::deallocate(p);
+}
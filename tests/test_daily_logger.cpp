@@ -171,3 +171,20 @@ TEST_CASE("daily_logger rotate", "[daily_file_sink]") {
     test_rotate(days_to_run, 11, 10);
     test_rotate(days_to_run, 20, 10);
 }
+
+TEST_CASE("daily_logger rotates at message time", "[daily_file_sink]") {
+    using spdlog::sinks::daily_file_sink_st;
+    prepare_logdir();
+
+    // a message every hour for 3 days: one rotation per day (not one per message after the first
+    // rotation, as when the next rotation time was computed from the clock)
+    size_t opens = 0;
+    spdlog::file_event_handlers handlers;
+    handlers.after_open = [&opens](const spdlog::filename_t &, std::FILE *) { opens++; };
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/daily_message_time.txt");
+    daily_file_sink_st sink{basename, 2, 30, true, 0, handlers};
+    for (int i = 1; i <= 72; i++) {
+        sink.log(create_msg(std::chrono::seconds{3600 * i}));
+    }
+    REQUIRE(opens == 4);
+}
@@ -167,3 +167,33 @@ TEST_CASE("file_helper_open", "[file_helper]") {
     target_filename += SPDLOG_FILENAME_T("/invalid");
     REQUIRE_THROWS_AS(helper.open(target_filename), spdlog::spdlog_ex);
 }
+
+TEST_CASE("file_helper_dir_removed", "[file_helper]") {
+    prepare_logdir();
+    spdlog::filename_t target_filename = SPDLOG_FILENAME_T("test_logs/dir1/dir2/file.txt");
+    file_helper helper;
+    helper.open(target_filename);
+    helper.close();
+
+    // the directory is cached now. removing it must not make the next open fail
+    prepare_logdir();
+    helper.open(target_filename);
+    write_with_helper(helper, 10);
+    REQUIRE(get_filesize("test_logs/dir1/dir2/file.txt") == 10);
+}
+
+TEST_CASE("file_helper_create_dirs", "[file_helper]") {
+    prepare_logdir();
+    file_helper::clear_dir_cache();
+    file_helper::create_dirs({SPDLOG_FILENAME_T("test_logs/dir1/a.txt"),
+                              SPDLOG_FILENAME_T("test_logs/dir1/b.txt"),
+                              SPDLOG_FILENAME_T("test_logs/dir2/c.txt")});
+    REQUIRE(spdlog::details::os::path_exists(SPDLOG_FILENAME_T("test_logs/dir1")));
+    REQUIRE(spdlog::details::os::path_exists(SPDLOG_FILENAME_T("test_logs/dir2")));
+    // no directory to create for a bare filename
+    REQUIRE_NOTHROW(file_helper::create_dirs({SPDLOG_FILENAME_T("plain.log")}));
+
+    file_helper helper;
+    helper.open(SPDLOG_FILENAME_T("test_logs/dir2/c.txt"));
+    REQUIRE(helper.size() == 0);
+}
@@ -3,6 +3,7 @@
  * https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
  */
 #include "includes.h"
+#include "spdlog/details/thread_formatters.h"
 
 #define SIMPLE_LOG "test_logs/simple_log"
 #define ROTATING_LOG "test_logs/rotating_log"
@@ -101,3 +102,128 @@ TEST_CASE("rotating_file_logger3", "[rotating_logger]") {
     REQUIRE_THROWS_AS(spdlog::rotating_logger_mt("logger", basename, max_size, 0),
                       spdlog::spdlog_ex);
 }
+
+// a derived class's sink_it_() is called for every message
+TEST_CASE("rotating_file_logger derived sink_it_", "[rotating_logger]") {
+    struct counting_sink : spdlog::sinks::rotating_file_sink_mt {
+        using spdlog::sinks::rotating_file_sink_mt::rotating_file_sink_mt;
+        size_t count = 0;
+
+    protected:
+        void sink_it_(const spdlog::details::log_msg &msg) override {
+            count++;
+            spdlog::sinks::rotating_file_sink_mt::sink_it_(msg);
+        }
+    };
+    prepare_logdir();
+    auto sink = std::make_shared<counting_sink>(SPDLOG_FILENAME_T(ROTATING_LOG), 1024 * 10, 0);
+    spdlog::logger logger("logger", sink);
+    logger.info("Test message {}", 1);
+    logger.info("Test message {}", 2);
+    REQUIRE(sink->count == 2);
+}
+
+// messages are formatted by the logging threads, outside of the sink mutex
+TEST_CASE("simple_file_logger_mt_threads", "[simple_logger]") {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(SIMPLE_LOG);
+
+    auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(filename);
+    sink->set_format_unlocked(true);
+    auto logger = std::make_shared<spdlog::logger>("logger", sink);
+    logger->set_pattern("[%n] %v");
+
+    const size_t n_threads = 4;
+    const size_t n_messages = 500;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < n_threads; t++) {
+        threads.emplace_back([&logger, t] {
+            for (size_t i = 0; i < n_messages; i++) {
+                logger->info("thread {} message {}", t, i);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    logger->flush();
+    require_message_count(SIMPLE_LOG, n_threads * n_messages);
+
+    std::ifstream ifs(SIMPLE_LOG);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        REQUIRE(line.compare(0, 15, "[logger] thread") == 0);
+    }
+}
+
+// a thread's formatter clone must not outlive a pattern change
+TEST_CASE("simple_file_logger_set_pattern", "[simple_logger]") {
+    prepare_logdir();
+    spdlog::filename_t filename = SPDLOG_FILENAME_T(SIMPLE_LOG);
+
+    auto sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(filename);
+    sink->set_format_unlocked(true);
+    auto logger = std::make_shared<spdlog::logger>("logger", sink);
+    logger->set_pattern("A %v");
+    logger->info("1");
+    logger->set_pattern("B %v");
+    logger->info("2");
+    std::thread([&logger] { logger->info("3"); }).join();
+    logger->set_pattern("C %v");
+    std::thread([&logger] { logger->info("4"); }).join();
+    logger->flush();
+
+    using spdlog::details::os::default_eol;
+    REQUIRE(file_contents(SIMPLE_LOG) == spdlog::fmt_lib::format("A 1{}B 2{}B 3{}C 4{}",
+                                                                 default_eol, default_eol,
+                                                                 default_eol, default_eol));
+}
+
+#ifndef SPDLOG_NO_TLS
+// by default the sink formats under its mutex, with its own formatter
+TEST_CASE("format_unlocked is opt-in", "[simple_logger]") {
+    std::ostringstream oss;
+    auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(oss);
+    spdlog::logger logger("opt-in", sink);
+    logger.set_pattern("%v");
+    size_t cached = 0;
+    std::thread([&] {
+        logger.info("locked");
+        cached = spdlog::details::thread_formatters::size();
+        sink->set_format_unlocked(true);
+        logger.info("unlocked");
+        cached += spdlog::details::thread_formatters::size();
+    }).join();
+    REQUIRE(cached == 1);
+    using spdlog::details::os::default_eol;
+    REQUIRE(oss.str() == spdlog::fmt_lib::format("locked{0}unlocked{0}", default_eol));
+}
+
+// a thread logging to more sinks than the old fixed cache size keeps a clone for each
+TEST_CASE("formatter clones of many sinks", "[simple_logger]") {
+    const size_t n_sinks = 12;
+    std::vector<std::ostringstream> streams(n_sinks);
+    std::vector<spdlog::sink_ptr> sinks;
+    for (size_t i = 0; i < n_sinks; i++) {
+        auto sink = std::make_shared<spdlog::sinks::ostream_sink_mt>(streams[i]);
+        sink->set_format_unlocked(true);
+        sinks.push_back(sink);
+        sinks.back()->set_pattern(spdlog::fmt_lib::format("{} %v", i));
+    }
+    spdlog::logger logger("many", sinks.begin(), sinks.end());
+    size_t cached = 0;
+    std::thread([&] {
+        for (int round = 0; round < 3; round++) {
+            logger.info("round {}", round);
+        }
+        cached = spdlog::details::thread_formatters::size();
+    }).join();
+    REQUIRE(cached == n_sinks);
+    using spdlog::details::os::default_eol;
+    for (size_t i = 0; i < n_sinks; i++) {
+        REQUIRE(streams[i].str() == spdlog::fmt_lib::format("{0} round 0{1}{0} round 1{1}"
+                                                            "{0} round 2{1}",
+                                                            i, default_eol));
+    }
+}
+#endif
@@ -80,3 +80,23 @@ TEST_CASE("pad9", "[fmt_helper]") {
     test_pad9(123456789, "123456789");
     test_pad9(1234567891, "1234567891");
 }
+
+TEST_CASE("fixed width kernels", "[fmt_helper]") {
+    // compare against fmt over the whole range of each width
+    for (uint32_t n = 0; n < 1000000000; n += 9973) {
+        memory_buf_t buf;
+        spdlog::details::fmt_helper::pad9(n, buf);
+        REQUIRE(to_string_view(buf) == fmt::format("{:09}", n));
+    }
+    for (uint32_t n = 0; n < 1000000; n += 7) {
+        memory_buf_t buf;
+        spdlog::details::fmt_helper::pad6(n, buf);
+        REQUIRE(to_string_view(buf) == fmt::format("{:06}", n));
+    }
+    test_pad9(999999999, "999999999");
+    test_pad9(100000000, "100000000");
+    test_pad9(10000000, "010000000");
+    test_pad9(99999999, "099999999");
+    test_pad6(999999, "999999");
+    test_pad6(1000000, "1000000");
+}
@@ -0,0 +1,169 @@
+#include "includes.h"
+#include "spdlog/sinks/integrity_file_sink.h"
+
+#define TEST_FILENAME "test_logs/integrity_log.txt"
+
+using spdlog::sinks::integrity_file_sink_st;
+using spdlog::sinks::verify_integrity_file;
+
+static void write_integrity_log(size_t n_messages, size_t checkpoint_interval) {
+    auto sink = std::make_shared<integrity_file_sink_st>(SPDLOG_FILENAME_T(TEST_FILENAME),
+                                                         checkpoint_interval);
+    sink->set_pattern("%v");
+    spdlog::logger logger("integrity", sink);
+    for (size_t i = 0; i < n_messages; i++) {
+        logger.info("Test message {}", i);
+    }
+}
+
+// overwrite the byte at the given offset of the test file
+static void patch_file(size_t offset, char c) {
+    std::FILE *f = std::fopen(TEST_FILENAME, "r+b");
+    REQUIRE(f != nullptr);
+    std::fseek(f, static_cast<long>(offset), SEEK_SET);
+    std::fputc(c, f);
+    std::fclose(f);
+}
+
+TEST_CASE("crc32c", "[integrity_file_sink]") {
+    REQUIRE(spdlog::details::crc32c("123456789", 9) == 0xE3069283);
+    REQUIRE(spdlog::details::crc32c("", 0) == 0);
+    // in pieces
+    auto crc = spdlog::details::crc32c("12345", 5);
+    REQUIRE(spdlog::details::crc32c("6789", 4, crc) == 0xE3069283);
+}
+
+TEST_CASE("sha256", "[integrity_file_sink]") {
+    spdlog::details::sha256 hasher;
+    hasher.update("abc", 3);
+    auto digest = hasher.final();
+    spdlog::memory_buf_t hex;
+    spdlog::details::integrity::append_hex(digest.bytes, sizeof(digest.bytes), hex);
+    REQUIRE(std::string(hex.data(), hex.size()) ==
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+}
+
+TEST_CASE("integrity_file_sink", "[integrity_file_sink]") {
+    prepare_logdir();
+    write_integrity_log(100, 30);
+    // chain start + 100 records + 3 checkpoints + final checkpoint
+    REQUIRE(count_lines(TEST_FILENAME) == 105);
+
+    auto report = verify_integrity_file(SPDLOG_FILENAME_T(TEST_FILENAME));
+    REQUIRE(report.ok);
+    REQUIRE(report.records == 100);
+    REQUIRE(report.checkpoints == 5);
+
+    // appending to the file continues the chain: no new chain start, a final checkpoint
+    write_integrity_log(10, 30);
+    REQUIRE(count_lines(TEST_FILENAME) == 116);
+    report = verify_integrity_file(SPDLOG_FILENAME_T(TEST_FILENAME));
+    REQUIRE(report.ok);
+    REQUIRE(report.records == 110);
+    REQUIRE(report.checkpoints == 6);
+    REQUIRE(file_contents(TEST_FILENAME).find("#chain 5 ") != std::string::npos);
+}
+
+TEST_CASE("integrity_file_sink multi line", "[integrity_file_sink]") {
+    prepare_logdir();
+    {
+        auto sink = std::make_shared<integrity_file_sink_st>(SPDLOG_FILENAME_T(TEST_FILENAME));
+        spdlog::logger logger("integrity", sink);
+        logger.info("line 1\nline 2\nline 3");
+        logger.info("single line");
+    }
+    auto report = verify_integrity_file(SPDLOG_FILENAME_T(TEST_FILENAME));
+    REQUIRE(report.ok);
+    REQUIRE(report.records == 2);
+}
+
+TEST_CASE("integrity_file_sink corruption", "[integrity_file_sink]") {
+    prepare_logdir();
+    write_integrity_log(100, 30);
+    auto contents = file_contents(TEST_FILENAME);
+    auto record_offset = contents.find("Test message 42");
+    patch_file(record_offset + 5, 'X');
+
+    auto report = verify_integrity_file(SPDLOG_FILENAME_T(TEST_FILENAME));
+    REQUIRE_FALSE(report.ok);
+    REQUIRE(report.bad_offset == record_offset);
+    REQUIRE(report.error == "checksum mismatch");
+}
+
+TEST_CASE("integrity_file_sink tampering", "[integrity_file_sink]") {
+    prepare_logdir();
+    write_integrity_log(100, 30);
+    // replace a record, with a valid crc
+    auto contents = file_contents(TEST_FILENAME);
+    auto record_offset = contents.find("Test message 42");
+    spdlog::memory_buf_t forged;
+    forged.append(std::string("Test message 24"));
+    spdlog::details::integrity::append_crc_trailer(
+        spdlog::details::crc32c(forged.data(), forged.size()), forged);
+    for (size_t i = 0; i < forged.size(); i++) {
+        patch_file(record_offset + i, forged.data()[i]);
+    }
+
+    auto report = verify_integrity_file(SPDLOG_FILENAME_T(TEST_FILENAME));
+    REQUIRE_FALSE(report.ok);
+    REQUIRE(report.error == "hash chain mismatch in segment");
+    // the segment of messages 30..59 starts after the chain start line, 30 records and a
+    // checkpoint
+    REQUIRE(report.bad_offset == contents.find("Test message 30"));
+}
+
+TEST_CASE("integrity_file_sink chain restart", "[integrity_file_sink]") {
+    // cut 10 records and restart the chain in their place, with a valid crc: in the middle of a
+    // segment, and right after a checkpoint
+    for (int first : {40, 30}) {
+        prepare_logdir();
+        write_integrity_log(100, 30);
+        auto contents = file_contents(TEST_FILENAME);
+        auto cut_begin = contents.find(spdlog::fmt_lib::format("Test message {}", first));
+        auto cut_end = contents.find(spdlog::fmt_lib::format("Test message {}", first + 10));
+        spdlog::memory_buf_t chain_start;
+        chain_start.append(std::string("#chain 0 ") + std::string(64, '0'));
+        spdlog::details::integrity::append_crc_trailer(
+            spdlog::details::crc32c(chain_start.data(), chain_start.size()), chain_start);
+        chain_start.append(std::string(spdlog::details::os::default_eol));
+        contents = contents.substr(0, cut_begin) +
+                   std::string(chain_start.data(), chain_start.size()) + contents.substr(cut_end);
+        {
+            std::FILE *f = std::fopen(TEST_FILENAME, "wb");
+            REQUIRE(f != nullptr);
+            std::fwrite(contents.data(), 1, contents.size(), f);
+            std::fclose(f);
+        }
+
+        auto report = verify_integrity_file(SPDLOG_FILENAME_T(TEST_FILENAME));
+        REQUIRE_FALSE(report.ok);
+        REQUIRE(report.error == "unexpected chain start");
+        REQUIRE(report.bad_offset == cut_begin);
+    }
+}
+
+TEST_CASE("integrity_file_sink truncated", "[integrity_file_sink]") {
+    prepare_logdir();
+    write_integrity_log(10, 30);
+    auto contents = file_contents(TEST_FILENAME);
+    {
+        std::FILE *f = std::fopen(TEST_FILENAME, "ab");
+        std::fputs("partial rec", f);
+        std::fclose(f);
+    }
+    auto report = verify_integrity_file(SPDLOG_FILENAME_T(TEST_FILENAME));
+    REQUIRE_FALSE(report.ok);
+    REQUIRE(report.bad_offset == contents.size());
+    REQUIRE(report.error == "truncated record");
+}
+
+TEST_CASE("integrity_file_sink verify files", "[integrity_file_sink]") {
+    prepare_logdir();
+    write_integrity_log(10, 3);
+    auto reports = spdlog::sinks::verify_integrity_files(
+        {SPDLOG_FILENAME_T(TEST_FILENAME), SPDLOG_FILENAME_T("test_logs/no_such_file")});
+    REQUIRE(reports.size() == 2);
+    REQUIRE(reports[0].ok);
+    REQUIRE(reports[0].records == 10);
+    REQUIRE_FALSE(reports[1].ok);
+}
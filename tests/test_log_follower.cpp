@@ -0,0 +1,129 @@
+#include "includes.h"
+#include "spdlog/details/log_follower.h"
+
+#include <fstream>
+
+using spdlog::details::follow_position;
+using spdlog::details::follow_scheme;
+using spdlog::details::log_follower;
+
+namespace {
+void write_file(const spdlog::filename_t &filename, const std::string &content) {
+    std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
+    ofs << content;
+}
+}  // namespace
+
+TEST_CASE("follow_rotating", "[log_follower]") {
+    prepare_logdir();
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/follow_rotating.txt");
+    const size_t max_files = 20;
+    auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(basename, 1024, max_files);
+    sink->set_pattern("%v");
+    spdlog::logger logger("follower", sink);
+    logger.flush_on(spdlog::level::info);
+
+    std::vector<std::string> expected;
+    std::vector<std::string> got;
+    int next = 0;
+    auto write = [&](int n) {
+        for (int i = 0; i < n; i++, next++) {
+            expected.push_back(fmt::format("message #{} of the follower test", next));
+            logger.info(expected.back());
+        }
+    };
+
+    // follow across rotations, reading after each round
+    follow_position checkpoint;
+    {
+        log_follower follower(basename, follow_scheme::rotating, max_files);
+        for (int round = 0; round < 10; round++) {
+            write(37);
+            follower.read(got, 1024 * 1024);
+            REQUIRE(got == expected);
+        }
+        // max_bytes limits the batch, the rest is read next time
+        write(50);
+        REQUIRE(follower.read(got, 100) < 50);
+        while (follower.read(got, 100) > 0) {
+        }
+        REQUIRE(got == expected);
+        checkpoint = follower.position();
+    }
+
+    // resume after rotations that happened while not following
+    spdlog::filename_t checkpoint_file = SPDLOG_FILENAME_T("test_logs/follow_rotating.ship");
+    log_follower::save_position(checkpoint_file, checkpoint);
+    write(200);
+    follow_position loaded;
+    REQUIRE(log_follower::load_position(checkpoint_file, loaded));
+    REQUIRE(loaded.inode == checkpoint.inode);
+    REQUIRE(loaded.offset == checkpoint.offset);
+    REQUIRE(loaded.filename == checkpoint.filename);
+    log_follower follower(basename, follow_scheme::rotating, max_files, loaded);
+    follower.read(got, 1024 * 1024);
+    REQUIRE(got == expected);
+}
+
+TEST_CASE("follow_daily", "[log_follower]") {
+    prepare_logdir();
+    spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/follow_daily.txt");
+    auto now = std::time(nullptr);
+    auto yesterday = now - 24 * 60 * 60;
+    auto yesterday_file = spdlog::sinks::daily_filename_calculator::calc_filename(
+        basename, spdlog::details::os::localtime(yesterday));
+    auto today_file = spdlog::sinks::daily_filename_calculator::calc_filename(
+        basename, spdlog::details::os::localtime(now));
+    write_file(yesterday_file, "first\nsecond\nthird");  // unterminated last record
+    write_file(today_file, "fourth\r\nfif");
+
+    // resume in yesterday's file, after the first record
+    log_follower first_follower(basename, follow_scheme::daily);
+    std::vector<std::string> got;
+    first_follower.read(got, 1024);
+    REQUIRE(got == std::vector<std::string>{"fourth"});
+
+    follow_position from;
+    from.filename = yesterday_file;
+    from.file_time = yesterday;
+    from.offset = 6;
+    struct stat st;
+    REQUIRE(::stat(yesterday_file.c_str(), &st) == 0);
+    from.inode = static_cast<uint64_t>(st.st_ino);
+    log_follower follower(basename, follow_scheme::daily, 0, from);
+    got.clear();
+    follower.read(got, 1024);
+    REQUIRE(got == std::vector<std::string>{"second", "third", "fourth"});
+    REQUIRE(follower.position().filename == today_file);
+
+    // the partial record is returned once complete
+    std::ofstream(today_file, std::ios::binary | std::ios::app) << "th\n";
+    got.clear();
+    follower.read(got, 1024);
+    REQUIRE(got == std::vector<std::string>{"fifth"});
+    REQUIRE(follower.position().offset == 14);
+}
+
+// a file of a later day than today (the clock was set back) has no next file
+TEST_CASE("follow_daily_future_file", "[log_follower]") {
+    prepare_logdir();
+    spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+    spdlog::filename_t basename = SPDLOG_FILENAME_T("test_logs/follow_daily.txt");
+    auto tomorrow = std::time(nullptr) + 24 * 60 * 60;
+    auto tomorrow_file = spdlog::sinks::daily_filename_calculator::calc_filename(
+        basename, spdlog::details::os::localtime(tomorrow));
+    write_file(tomorrow_file, "first\nsecond\n");
+
+    follow_position from;
+    from.filename = tomorrow_file;
+    from.file_time = tomorrow;
+    struct stat st;
+    REQUIRE(::stat(tomorrow_file.c_str(), &st) == 0);
+    from.inode = static_cast<uint64_t>(st.st_ino);
+    log_follower follower(basename, follow_scheme::daily, 0, from);
+    std::vector<std::string> got;
+    follower.read(got, 1024);
+    REQUIRE(got == std::vector<std::string>{"first", "second"});
+    REQUIRE(follower.position().filename == tomorrow_file);
+}
@@ -4,6 +4,7 @@
  */
 
 #include "includes.h"
+#include "test_sink.h"
 
 #if SPDLOG_ACTIVE_LEVEL != SPDLOG_LEVEL_DEBUG
     #error "Invalid SPDLOG_ACTIVE_LEVEL in test. Should be SPDLOG_LEVEL_DEBUG"
@@ -51,3 +52,61 @@ TEST_CASE("pass logger pointer", "[macros]") {
     SPDLOG_LOGGER_TRACE(&ref, "Test message 1");
     SPDLOG_LOGGER_DEBUG(&ref, "Test message 2");
 }
+
+TEST_CASE("every_n and first_n", "[macros]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    spdlog::logger logger("rate", test_sink);
+    logger.set_pattern("%v");
+    logger.set_level(spdlog::level::trace);
+    int evaluated = 0;
+    for (int i = 0; i < 10; i++) {
+        SPDLOG_LOGGER_INFO_EVERY_N(&logger, 3, "every 3 #{}", i);
+        SPDLOG_LOGGER_WARN_FIRST_N(&logger, 2, "first 2 #{} {}", i, ++evaluated);
+        SPDLOG_LOGGER_DEBUG_ONCE(&logger, "once");
+    }
+    REQUIRE(test_sink->lines() ==
+            std::vector<std::string>{"every 3 #0", "first 2 #0 1", "once", "first 2 #1 2",
+                                     "every 3 #3 (2 skipped)", "every 3 #6 (2 skipped)",
+                                     "every 3 #9 (2 skipped)"});
+    // the arguments of suppressed calls are not evaluated
+    REQUIRE(evaluated == 2);
+
+    // disabled at compile time
+    SPDLOG_LOGGER_TRACE_ONCE(&logger, "Test message {}",
+                             throw std::runtime_error("Should not be evaluated"));
+    REQUIRE(test_sink->lines().size() == 7);
+}
+
+TEST_CASE("limited calls below the level", "[macros]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    spdlog::logger logger("rate", test_sink);
+    logger.set_pattern("%v");
+    logger.set_level(spdlog::level::info);
+    for (int round = 0; round < 2; round++) {
+        SPDLOG_LOGGER_DEBUG_ONCE(&logger, "once");
+        SPDLOG_LOGGER_DEBUG_FIRST_N(&logger, 1, "first 1");
+        // the calls filtered out by the level don't use up the limit
+        logger.set_level(spdlog::level::debug);
+    }
+    REQUIRE(test_sink->lines() == std::vector<std::string>{"once", "first 1"});
+}
+
+TEST_CASE("every_ms", "[macros]") {
+    auto test_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    auto logger = std::make_shared<spdlog::logger>("rate", test_sink);
+    logger->set_pattern("%v");
+    auto orig_default_logger = spdlog::default_logger();
+    spdlog::set_default_logger(logger);
+
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < 5; i++) {
+            SPDLOG_ERROR_EVERY_MS(200, "every 200ms #{}", i);
+        }
+        if (round == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        }
+    }
+    REQUIRE(test_sink->lines() ==
+            std::vector<std::string>{"every 200ms #0", "every 200ms #0 (4 skipped)"});
+    spdlog::set_default_logger(std::move(orig_default_logger));
+}
@@ -74,6 +74,29 @@ TEST_CASE("enqueue_nowait", "[mpmc_blocking_q]") {
     REQUIRE(q.overrun_counter() == 1);
 }
 
+namespace {
+struct counted_item {
+    static size_t constructed;
+    counted_item() { constructed++; }
+    counted_item(counted_item &&) noexcept { constructed++; }
+    counted_item &operator=(counted_item &&) = default;
+};
+size_t counted_item::constructed = 0;
+}  // namespace
+
+// the holder of the overrun item is only constructed if the queue is full
+TEST_CASE("enqueue_nowait constructs no item if not full", "[mpmc_blocking_q]") {
+    spdlog::details::mpmc_blocking_queue<counted_item> q(2);
+    counted_item item;
+    counted_item::constructed = 0;
+    q.enqueue_nowait(std::move(item));
+    q.enqueue_nowait(std::move(item));
+    REQUIRE(counted_item::constructed == 0);
+    q.enqueue_nowait(std::move(item));
+    REQUIRE(counted_item::constructed == 1);
+    REQUIRE(q.overrun_counter() == 1);
+}
+
 TEST_CASE("bad_queue", "[mpmc_blocking_q]") {
     size_t q_size = 0;
     spdlog::details::mpmc_blocking_queue<int> q(q_size);
@@ -112,3 +135,87 @@ TEST_CASE("full_queue", "[mpmc_blocking_q]") {
     q.dequeue(item);
     REQUIRE(item == 123456);
 }
+
+namespace {
+struct ring_header {
+    static int alive;
+    int id;
+    explicit ring_header(int id_in)
+        : id(id_in) {
+        alive++;
+    }
+    ring_header(ring_header &&other)
+        : id(other.id) {
+        alive++;
+    }
+    ~ring_header() { alive--; }
+};
+int ring_header::alive = 0;
+using ring_type = spdlog::details::mpmc_byte_ring<ring_header>;
+
+std::string take_record(ring_type &ring, int &id) {
+    auto *r = ring.take();
+    id = r->header.id;
+    std::string data(r->data().data(), r->data().size());
+    ring.release(r);
+    return data;
+}
+}  // namespace
+
+TEST_CASE("byte_ring_wrap", "[mpmc_byte_ring]") {
+    {
+        // room for 3 records with 100 bytes of data
+        ring_type ring(3 * (sizeof(ring_type::record) + 104));
+        std::string data(100, 'x');
+        int id = 0;
+        for (int i = 0; i < 50; i++) {
+            data[0] = static_cast<char>('a' + i % 26);
+            ring.enqueue(ring_header(i), {data.substr(0, 50), data.substr(50)});
+            ring.enqueue(ring_header(i + 1000), {"small"});
+            REQUIRE(take_record(ring, id) == data);
+            REQUIRE(id == i);
+            REQUIRE(take_record(ring, id) == "small");
+            REQUIRE(id == i + 1000);
+        }
+        REQUIRE(ring.size() == 0);
+        ring.enqueue(ring_header(1), {"left in the ring"});
+    }
+    REQUIRE(ring_header::alive == 0);
+}
+
+TEST_CASE("byte_ring_overflow", "[mpmc_byte_ring]") {
+    const size_t record_size = sizeof(ring_type::record) + 8;
+    ring_type ring(4 * record_size);
+    for (int i = 0; i < 10; i++) {
+        ring.enqueue_nowait(ring_header(i), {"12345678"});
+    }
+    REQUIRE(ring.size() == 4);
+    REQUIRE(ring.overrun_counter() == 6);
+
+    for (int i = 0; i < 10; i++) {
+        ring.enqueue_if_have_room(ring_header(i), {"12345678"});
+    }
+    REQUIRE(ring.discard_counter() == 10);
+
+    int id = 0;
+    for (int i = 6; i < 10; i++) {
+        take_record(ring, id);
+        REQUIRE(id == i);
+    }
+    REQUIRE(ring.size() == 0);
+    REQUIRE(ring_header::alive == 0);
+}
+
+TEST_CASE("byte_ring_truncate", "[mpmc_byte_ring]") {
+    ring_type ring(256);
+    std::string big(1000, 'b');
+    ring.enqueue(ring_header(1), {"name", big});
+    int id = 0;
+    auto data = take_record(ring, id);
+    REQUIRE(data.size() == ring.max_data_size());
+    REQUIRE(data.substr(0, 4) == "name");
+}
+
+TEST_CASE("byte_ring_bad_capacity", "[mpmc_byte_ring]") {
+    REQUIRE_THROWS_AS(ring_type(sizeof(ring_type::record) / 2), spdlog::spdlog_ex);
+}
@@ -630,3 +630,108 @@ TEST_CASE("mdc empty", "[pattern_formatter]") {
     SECTION("Tear down") { spdlog::mdc::clear(); }
 }
 #endif
+
+static std::string format_multiline(const std::string &payload,
+                                    const std::string &pattern,
+                                    spdlog::multiline_policy policy,
+                                    const std::string &prefix = {}) {
+    spdlog::pattern_formatter formatter(pattern, spdlog::pattern_time_type::local, "\n");
+    formatter.set_multiline(policy, prefix);
+    auto clone = formatter.clone();
+    spdlog::details::log_msg msg("logger-name", spdlog::level::info, payload);
+    memory_buf_t formatted;
+    formatted.append(std::string("previous message\n"));
+    clone->format(msg, formatted);
+    return std::string(formatted.data(), formatted.size());
+}
+
+TEST_CASE("multiline keep", "[pattern_formatter]") {
+    REQUIRE(format_multiline("line1\nline2", "[%n] %v", spdlog::multiline_policy::keep) ==
+            "previous message\n[logger-name] line1\nline2\n");
+}
+
+TEST_CASE("multiline escape", "[pattern_formatter]") {
+    REQUIRE(format_multiline("line1\nline2\r\nline3\n", "[%n] %v",
+                             spdlog::multiline_policy::escape) ==
+            "previous message\n[logger-name] line1\\nline2\\r\\nline3\\n\n");
+    REQUIRE(format_multiline("single line", "[%n] %v", spdlog::multiline_policy::escape) ==
+            "previous message\n[logger-name] single line\n");
+}
+
+TEST_CASE("multiline repeat header", "[pattern_formatter]") {
+    REQUIRE(format_multiline("line1\nline2\nline3", "[%l] [%n] %v",
+                             spdlog::multiline_policy::repeat_header) ==
+            "previous message\n[info] [logger-name] line1\n[info] [logger-name] line2\n"
+            "[info] [logger-name] line3\n");
+    // trailing newline doesn't start a new line
+    REQUIRE(format_multiline("line1\n", "[%n] %v", spdlog::multiline_policy::repeat_header) ==
+            "previous message\n[logger-name] line1\n\n");
+}
+
+TEST_CASE("multiline prefix", "[pattern_formatter]") {
+    REQUIRE(format_multiline("line1\nline2\nline3", "[%n] %v", spdlog::multiline_policy::prefix,
+                             "  | ") ==
+            "previous message\n[logger-name] line1\n  | line2\n  | line3\n");
+}
+
+TEST_CASE("multiline padding", "[pattern_formatter]") {
+    // padded and truncated by the size of the escaped payload
+    REQUIRE(format_multiline("a\nb", "[%-8v]", spdlog::multiline_policy::escape) ==
+            "previous message\n[a\\nb    ]\n");
+    REQUIRE(format_multiline("ab\ncd", "[%5!v]", spdlog::multiline_policy::escape) ==
+            "previous message\n[ab\\nc]\n");
+    REQUIRE(format_multiline("a\nb", "%n %-7v|", spdlog::multiline_policy::prefix, "> ") ==
+            "previous message\nlogger-name a\n> b  |\n");
+}
+
+TEST_CASE("multiline full formatter", "[pattern_formatter]") {
+    spdlog::pattern_formatter formatter(spdlog::pattern_time_type::local, "\n");
+    formatter.set_multiline(spdlog::multiline_policy::repeat_header);
+    spdlog::details::log_msg msg("logger-name", spdlog::level::info, "line1\nline2");
+    memory_buf_t formatted;
+    formatter.format(msg, formatted);
+    std::string result(formatted.data(), formatted.size());
+    auto first_line_end = result.find('\n');
+    auto header = result.substr(0, first_line_end - 5);
+    REQUIRE(result == header + "line1\n" + header + "line2\n");
+}
+
+TEST_CASE("monotonic uptime flag", "[pattern_formatter]") {
+    auto mono = spdlog::details::os::mono_start() + std::chrono::milliseconds(1500) +
+                std::chrono::nanoseconds(42);
+    spdlog::details::log_msg msg(mono, spdlog::source_loc{}, "logger-name", spdlog::level::info,
+                                 "msg");
+    spdlog::pattern_formatter formatter("%k|%16k|", spdlog::pattern_time_type::local, "");
+    memory_buf_t formatted;
+    formatter.format(msg, formatted);
+    REQUIRE(to_string_view(formatted) == "1.500000042|     1.500000042|");
+}
+
+TEST_CASE("monotonic elapsed flags", "[pattern_formatter]") {
+    auto wall = spdlog::log_clock::now();
+    auto mono = spdlog::details::os::mono_now() + std::chrono::seconds(10);
+    spdlog::pattern_formatter formatter("%K %u", spdlog::pattern_time_type::local, "");
+
+    memory_buf_t formatted;
+    spdlog::details::log_msg msg1(wall, mono, spdlog::source_loc{}, "logger-name",
+                                  spdlog::level::info, "msg");
+    formatter.format(msg1, formatted);
+
+    // the wall clock stepped back, but the elapsed times follow the monotonic clock
+    formatted.clear();
+    spdlog::details::log_msg msg2(wall - std::chrono::hours(1), mono + std::chrono::nanoseconds(1234),
+                                  spdlog::source_loc{}, "logger-name", spdlog::level::info, "msg");
+    formatter.format(msg2, formatted);
+    REQUIRE(to_string_view(formatted) == "0.000001234 1234");
+}
+
+TEST_CASE("monotonic and wall clock conversion", "[pattern_formatter]") {
+    auto wall = spdlog::log_clock::now();
+    auto mono = spdlog::details::os::wall_to_mono(wall);
+    REQUIRE(spdlog::details::os::mono_to_wall(mono) == wall);
+
+    spdlog::details::log_msg msg("logger-name", spdlog::level::info, "msg");
+    auto drift = msg.time - spdlog::details::os::mono_to_wall(msg.mono_time);
+    REQUIRE(drift < std::chrono::seconds(1));
+    REQUIRE(drift > -std::chrono::seconds(1));
+}
@@ -0,0 +1,85 @@
+#include "includes.h"
+#include "spdlog/sinks/basic_file_sink.h"
+
+#define TEST_FILENAME "test_logs/profiler_log"
+
+namespace {
+const spdlog::profile_entry *find_entry(const std::vector<spdlog::profile_entry> &report,
+                                        const std::string &logger,
+                                        const std::string &sink) {
+    for (auto &e : report) {
+        if (e.logger == logger && e.sink == sink) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+}  // namespace
+
+TEST_CASE("profile_stages", "[profiler]") {
+    using spdlog::profile_stage;
+    prepare_logdir();
+    spdlog::reset_profile();
+    auto logger = spdlog::basic_logger_mt("profiled", SPDLOG_FILENAME_T(TEST_FILENAME));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&logger, t] {
+            for (int i = 0; i < 100; i++) {
+                logger->info("thread {} message {}", t, i);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    logger->flush();
+
+    auto report = spdlog::profile_report();
+    auto *l = find_entry(report, "profiled", "");
+    auto *s = find_entry(report, "profiled", "sink[0]");
+    REQUIRE(l != nullptr);
+    REQUIRE(s != nullptr);
+    REQUIRE(l->counters.calls_of(profile_stage::vformat) == 400);
+    REQUIRE(l->counters.ticks_of(profile_stage::vformat) > 0);
+    REQUIRE(s->counters.calls_of(profile_stage::pattern_format) == 400);
+    REQUIRE(s->counters.ticks_of(profile_stage::pattern_format) > 0);
+    REQUIRE(s->counters.calls_of(profile_stage::lock_wait) == 401);
+    REQUIRE(s->counters.calls_of(profile_stage::write) == 400);
+    REQUIRE(s->counters.calls_of(profile_stage::flush) == 1);
+    REQUIRE(spdlog::format_profile_report(report).find("pattern_format") != std::string::npos);
+
+    spdlog::reset_profile();
+    report = spdlog::profile_report();
+    s = find_entry(report, "profiled", "sink[0]");
+    REQUIRE(s != nullptr);
+    REQUIRE(s->counters.calls_of(profile_stage::write) == 0);
+    spdlog::drop("profiled");
+}
+
+// more owners (a logger and its sinks) than the per thread cache of recent owners holds
+TEST_CASE("profile_many_sinks", "[profiler]") {
+    using spdlog::profile_stage;
+    spdlog::reset_profile();
+    std::vector<spdlog::sink_ptr> sinks;
+    for (int i = 0; i < 6; i++) {
+        sinks.push_back(std::make_shared<spdlog::sinks::null_sink_mt>());
+    }
+    auto logger = std::make_shared<spdlog::logger>("profiled_many", sinks.begin(), sinks.end());
+    spdlog::register_logger(logger);
+    std::thread([&logger] {
+        for (int i = 0; i < 50; i++) {
+            logger->info("message {}", i);
+        }
+    }).join();
+
+    auto report = spdlog::profile_report();
+    auto *l = find_entry(report, "profiled_many", "");
+    REQUIRE(l != nullptr);
+    REQUIRE(l->counters.calls_of(profile_stage::vformat) == 50);
+    for (size_t i = 0; i < sinks.size(); i++) {
+        auto *s = find_entry(report, "profiled_many", spdlog::fmt_lib::format("sink[{}]", i));
+        REQUIRE(s != nullptr);
+        REQUIRE(s->counters.calls_of(profile_stage::lock_wait) == 50);
+    }
+    spdlog::drop("profiled_many");
+}
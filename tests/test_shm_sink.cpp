@@ -0,0 +1,197 @@
+#include "includes.h"
+#include "spdlog/sinks/shm_sink.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using spdlog::details::shm_ring;
+
+namespace {
+std::string test_ring_name(const char *test) {
+    return fmt::format("utest.{}.{}", test, ::getpid());
+}
+
+struct drained_record {
+    spdlog::level::level_enum level;
+    std::string data;
+};
+
+// drain the ring until count records were received or the timeout
+std::vector<drained_record> drain_ring(shm_ring &ring, size_t count) {
+    std::vector<drained_record> records;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    while (records.size() < count && std::chrono::steady_clock::now() < deadline) {
+        auto n = ring.drain(
+            [&](spdlog::level::level_enum lvl, spdlog::log_clock::time_point,
+                spdlog::string_view_t data) {
+                records.push_back({lvl, std::string(data.data(), data.size())});
+            },
+            1000);
+        if (n == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    return records;
+}
+}  // namespace
+
+TEST_CASE("shm_sink_forked_producers", "[shm_sink]") {
+    const auto name = test_ring_name("forked");
+    shm_ring::remove(name);
+    // small ring, so the producers are blocked by back-pressure while the parent drains it
+    shm_ring ring(name, 16, 128);
+
+    const int n_producers = 4;
+    const int n_messages = 2000;
+    std::vector<pid_t> children;
+    for (int p = 0; p < n_producers; p++) {
+        pid_t pid = ::fork();
+        REQUIRE(pid >= 0);
+        if (pid == 0) {
+            {
+                spdlog::sinks::shm_sink_config cfg(name);
+                auto sink = std::make_shared<spdlog::sinks::shm_sink_st>(cfg);
+                sink->set_pattern("[%l] %v");
+                spdlog::logger logger("producer", sink);
+                for (int i = 0; i < n_messages; i++) {
+                    logger.warn("producer {} message {}", p, i);
+                }
+            }
+            ::_exit(0);
+        }
+        children.push_back(pid);
+    }
+
+    auto records = drain_ring(ring, n_producers * n_messages);
+    for (auto pid : children) {
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        REQUIRE(WIFEXITED(status));
+    }
+    REQUIRE(records.size() == n_producers * n_messages);
+
+    // the messages of each producer arrive complete and in order
+    std::vector<int> next(n_producers, 0);
+    for (auto &r : records) {
+        int p = -1, i = -1;
+        REQUIRE(std::sscanf(r.data.c_str(), "[warning] producer %d message %d", &p, &i) == 2);
+        REQUIRE(r.level == spdlog::level::warn);
+        REQUIRE(p >= 0);
+        REQUIRE(p < n_producers);
+        REQUIRE(i == next[p]++);
+    }
+    REQUIRE(ring.dropped() == 0);
+    REQUIRE(ring.skipped() == 0);
+    REQUIRE(ring.size() == 0);
+    shm_ring::remove(name);
+}
+
+TEST_CASE("shm_sink_drop_when_full", "[shm_sink]") {
+    const auto name = test_ring_name("drop");
+    shm_ring::remove(name);
+    spdlog::sinks::shm_sink_config cfg(name);
+    cfg.slots = 8;
+    cfg.slot_size = 64;
+    cfg.block_when_full = false;
+    auto sink = std::make_shared<spdlog::sinks::shm_sink_st>(cfg);
+    sink->set_pattern("%v");
+    spdlog::logger logger("producer", sink);
+    for (int i = 0; i < 20; i++) {
+        logger.info("message {} is longer than the slots of this small ring", i);
+    }
+    REQUIRE(sink->dropped_messages() == 12);
+
+    shm_ring ring(name, 1000, 1000);  // attaches, keeping the existing geometry
+    REQUIRE(ring.slot_count() == 8);
+    auto records = drain_ring(ring, 8);
+    REQUIRE(records.size() == 8);
+    REQUIRE(records[0].data == std::string("message 0 is longer than the slots of this small ring")
+                                   .substr(0, ring.max_record_size()));
+    shm_ring::remove(name);
+}
+
+TEST_CASE("shm_ring_crashed_producers", "[shm_sink]") {
+    const auto name = test_ring_name("crash");
+    shm_ring::remove(name);
+    shm_ring ring(name, 8, 128);
+    ring.set_stale_timeout(std::chrono::milliseconds(50));
+    auto now = spdlog::log_clock::now();
+    auto drain_now = [&ring](std::vector<std::string> &out) {
+        return ring.drain(
+            [&out](spdlog::level::level_enum, spdlog::log_clock::time_point,
+                   spdlog::string_view_t data) { out.emplace_back(data.data(), data.size()); },
+            100);
+    };
+
+    // a producer killed while blocked on the full ring leaves a claimed ticket that is never
+    // written: it is skipped after the stale timeout
+    for (int i = 0; i < 8; i++) {
+        REQUIRE(ring.push(spdlog::level::info, now, fmt::format("record {}", i), true));
+    }
+    pid_t pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+        shm_ring child_ring(name, 8, 128);
+        child_ring.push(spdlog::level::info, now, "lost", true);
+        ::_exit(1);
+    }
+    while (ring.size() < 9) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ::kill(pid, SIGKILL);
+    ::waitpid(pid, nullptr, 0);
+    REQUIRE_FALSE(ring.push(spdlog::level::info, now, "dropped", false));
+    REQUIRE(ring.dropped() == 1);
+
+    std::vector<std::string> records;
+    REQUIRE(drain_now(records) == 8);
+    REQUIRE(records.front() == "record 0");
+    REQUIRE(ring.skipped() == 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    REQUIRE(drain_now(records) == 0);
+    REQUIRE(ring.skipped() == 1);
+    REQUIRE(ring.size() == 0);
+
+    // claim a ticket and mark its slot as being written by the given process, as shm_ring::push
+    // does
+    auto start_writing = [&name](pid_t writer) {
+        int fd = ::shm_open(shm_ring::shm_path(name).c_str(), O_RDWR, 0);
+        size_t size = shm_ring::header_size + 8 * 128;
+        void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        auto *hdr = static_cast<shm_ring::ring_header *>(p);
+        auto t = hdr->tail.fetch_add(1);
+        auto *slot = reinterpret_cast<shm_ring::slot_header *>(
+            static_cast<char *>(p) + shm_ring::header_size + (t % 8) * 128);
+        slot->seq.store((static_cast<uint64_t>(writer) << 1) | 1);
+        ::munmap(p, size);
+    };
+
+    // a producer that died while writing its record is skipped after the stale timeout
+    pid = ::fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+        start_writing(::getpid());
+        ::_exit(0);
+    }
+    ::waitpid(pid, nullptr, 0);
+    REQUIRE(ring.push(spdlog::level::info, now, "after", true));
+    records.clear();
+    REQUIRE(drain_now(records) == 0);
+    REQUIRE(ring.skipped() == 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    REQUIRE(drain_now(records) == 1);
+    REQUIRE(records == std::vector<std::string>{"after"});
+    REQUIRE(ring.skipped() == 2);
+
+    // the slot of a process that still exists is never skipped
+    start_writing(::getpid());
+    REQUIRE(ring.push(spdlog::level::info, now, "blocked", true));
+    REQUIRE(drain_now(records) == 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    REQUIRE(drain_now(records) == 0);
+    REQUIRE(ring.skipped() == 2);
+    shm_ring::remove(name);
+}
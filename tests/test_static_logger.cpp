@@ -0,0 +1,119 @@
+/*
+ * This content is released under the MIT License as specified in
+ * https://raw.githubusercontent.com/gabime/spdlog/master/LICENSE
+ */
+#include "includes.h"
+#include "test_sink.h"
+#include "spdlog/static_logger.h"
+
+#define TEST_FILENAME "test_logs/static_logger_log"
+
+using spdlog::details::os::default_eol;
+
+TEST_CASE("static logger to ostream", "[static_logger]") {
+    std::ostringstream oss;
+    spdlog::static_logger_st<spdlog::pattern_formatter, spdlog::sinks::static_ostream_sink> logger(
+        "static", spdlog::sinks::static_ostream_sink(oss));
+    logger.set_pattern("[%n] [%l] %v");
+
+    logger.info("Hello {}", 1);
+    logger.debug("not logged");
+    logger.warn("Hello");
+    REQUIRE(oss.str() == spdlog::fmt_lib::format("[static] [info] Hello 1{}[static] [warning] Hello{}",
+                                                 default_eol, default_eol));
+}
+
+TEST_CASE("static logger level", "[static_logger]") {
+    std::ostringstream oss;
+    spdlog::static_logger_mt<spdlog::pattern_formatter, spdlog::sinks::static_ostream_sink> logger(
+        "static", spdlog::sinks::static_ostream_sink(oss));
+    logger.set_pattern("%v");
+
+    REQUIRE(logger.level() == spdlog::level::info);
+    REQUIRE_FALSE(logger.should_log(spdlog::level::debug));
+    logger.set_level(spdlog::level::trace);
+    REQUIRE(logger.should_log(spdlog::level::trace));
+    logger.trace("trace");
+    logger.set_level(spdlog::level::off);
+    logger.critical("critical");
+    REQUIRE(oss.str() == spdlog::fmt_lib::format("trace{}", default_eol));
+}
+
+TEST_CASE("static logger multiple sinks", "[static_logger]") {
+    prepare_logdir();
+    std::ostringstream oss;
+    auto dynamic_sink = std::make_shared<spdlog::sinks::test_sink_mt>();
+    dynamic_sink->set_pattern("dynamic %v");
+    {
+        spdlog::static_logger_mt<spdlog::pattern_formatter, spdlog::sinks::static_file_sink,
+                                 spdlog::sinks::static_ostream_sink, spdlog::sinks::static_null_sink,
+                                 spdlog::sinks::static_sink_ref>
+            logger("static", spdlog::sinks::static_file_sink(SPDLOG_FILENAME_T(TEST_FILENAME)),
+                   spdlog::sinks::static_ostream_sink(oss), spdlog::sinks::static_null_sink(),
+                   spdlog::sinks::static_sink_ref(dynamic_sink));
+        logger.set_pattern("%v");
+        logger.info("message {}", 1);
+        logger.error(std::string("message 2"));
+        logger.flush();
+        REQUIRE(logger.sink<0>().filename() == SPDLOG_FILENAME_T(TEST_FILENAME));
+    }
+    auto expected = spdlog::fmt_lib::format("message 1{}message 2{}", default_eol, default_eol);
+    REQUIRE(file_contents(TEST_FILENAME) == expected);
+    REQUIRE(oss.str() == expected);
+    REQUIRE(dynamic_sink->lines() == std::vector<std::string>{"dynamic message 1", "dynamic message 2"});
+    REQUIRE(dynamic_sink->flush_counter() == 1);
+}
+
+TEST_CASE("static logger macros", "[static_logger]") {
+    std::ostringstream oss;
+    spdlog::static_logger_st<spdlog::pattern_formatter, spdlog::sinks::static_ostream_sink> logger(
+        "static", spdlog::sinks::static_ostream_sink(oss));
+    logger.set_pattern("%v");
+    logger.set_level(spdlog::level::trace);
+
+    SPDLOG_LOGGER_TRACE(&logger, "trace {}", 1);
+    SPDLOG_LOGGER_DEBUG(&logger, "debug {}", 2);
+    SPDLOG_LOGGER_INFO(&logger, "info {}", 3);
+    SPDLOG_LOGGER_CRITICAL(&logger, "critical");
+    // SPDLOG_ACTIVE_LEVEL is debug in the tests
+    REQUIRE(oss.str() == spdlog::fmt_lib::format("debug 2{}info 3{}critical{}", default_eol,
+                                                 default_eol, default_eol));
+}
+
+TEST_CASE("static logger rate limited macros", "[static_logger]") {
+    std::ostringstream oss;
+    spdlog::static_logger_st<spdlog::pattern_formatter, spdlog::sinks::static_ostream_sink> logger(
+        "static", spdlog::sinks::static_ostream_sink(oss));
+    logger.set_pattern("%v");
+    for (int i = 0; i < 5; i++) {
+        SPDLOG_LOGGER_INFO_EVERY_N(&logger, 2, "every 2 #{}", i);
+        SPDLOG_LOGGER_DEBUG_ONCE(&logger, "below the level");
+    }
+    REQUIRE(oss.str() == spdlog::fmt_lib::format("every 2 #0{0}every 2 #2 (1 skipped){0}"
+                                                 "every 2 #4 (1 skipped){0}",
+                                                 default_eol));
+}
+
+TEST_CASE("static logger flush_on", "[static_logger]") {
+    auto dynamic_sink = std::make_shared<spdlog::sinks::test_sink_st>();
+    spdlog::static_logger_st<spdlog::pattern_formatter, spdlog::sinks::static_sink_ref> logger(
+        "static", spdlog::sinks::static_sink_ref(dynamic_sink));
+    logger.flush_on(spdlog::level::err);
+    logger.info("no flush");
+    REQUIRE(dynamic_sink->flush_counter() == 0);
+    logger.error("flush");
+    REQUIRE(dynamic_sink->flush_counter() == 1);
+}
+
+#ifndef SPDLOG_NO_EXCEPTIONS
+TEST_CASE("static logger error handler", "[static_logger]") {
+    std::ostringstream oss;
+    spdlog::static_logger_st<spdlog::pattern_formatter, spdlog::sinks::static_ostream_sink> logger(
+        "static", spdlog::sinks::static_ostream_sink(oss));
+    std::string err_msg;
+    logger.set_error_handler([&err_msg](const std::string &msg) { err_msg = msg; });
+    logger.info(SPDLOG_FMT_RUNTIME("Bad format msg {} {}"), "xxx");
+    REQUIRE_FALSE(err_msg.empty());
+    REQUIRE(oss.str().empty());
+}
+#endif
@@ -88,3 +88,59 @@ TEST_CASE("wchar_api", "[stdout]") {
 }
 
 #endif
+
+#ifdef __linux__
+    #include <thread>
+    #include <unistd.h>
+
+TEST_CASE("stdout_sink pipe splice", "[stdout]") {
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+    FILE *write_end = ::fdopen(fds[1], "w");
+    REQUIRE(write_end != nullptr);
+
+    // read everything written to the pipe until it is closed
+    std::string received;
+    std::thread reader([&] {
+        char buf[4096];
+        ssize_t n;
+        while ((n = ::read(fds[0], buf, sizeof(buf))) > 0) {
+            received.append(buf, static_cast<size_t>(n));
+        }
+    });
+
+    std::string expected;
+    {
+        spdlog::sinks::stdout_sink_base<spdlog::details::console_nullmutex> sink(write_end);
+        sink.set_pattern("%v");
+        REQUIRE(sink.enable_pipe_splice(8192));
+        spdlog::logger logger("pipe", spdlog::sink_ptr(&sink, [](spdlog::sinks::sink *) {}));
+        // a message larger than the buffer, then enough to fill the buffer a few times
+        std::string large(10000, 'x');
+        logger.info(large);
+        expected += large + spdlog::details::os::default_eol;
+        for (int i = 0; i < 1000; i++) {
+            logger.info("message #{}", i);
+            expected +=
+                spdlog::fmt_lib::format("message #{}{}", i, spdlog::details::os::default_eol);
+        }
+        logger.flush();
+        logger.info("written by the destructor");
+        expected += std::string("written by the destructor") + spdlog::details::os::default_eol;
+    }
+    ::fclose(write_end);
+    reader.join();
+    ::close(fds[0]);
+    REQUIRE(received == expected);
+}
+
+TEST_CASE("stdout_sink pipe splice not a pipe", "[stdout]") {
+    FILE *file = ::tmpfile();
+    REQUIRE(file != nullptr);
+    {
+        spdlog::sinks::stdout_sink_base<spdlog::details::console_nullmutex> sink(file);
+        REQUIRE_FALSE(sink.enable_pipe_splice());
+    }
+    ::fclose(file);
+}
+#endif
@@ -0,0 +1,194 @@
+#include "includes.h"
+#include "spdlog/sinks/tcp_pool_sink.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// accepts a single tcp connection and saves what was received until the client closed it
+class local_tcp_server {
+public:
+    local_tcp_server() {
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in sa{};
+        sa.sin_family = AF_INET;
+        sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        REQUIRE(::bind(listen_fd_, reinterpret_cast<sockaddr *>(&sa), sizeof(sa)) == 0);
+        REQUIRE(::listen(listen_fd_, 4) == 0);
+        socklen_t len = sizeof(sa);
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&sa), &len);
+        port_ = ntohs(sa.sin_port);
+
+        thread_ = std::thread([this] {
+            int fd = ::accept(listen_fd_, nullptr, nullptr);
+            char buf[4096];
+            ssize_t n;
+            while ((n = ::recv(fd, buf, sizeof(buf), 0)) > 0) {
+                received_.append(buf, static_cast<size_t>(n));
+            }
+            ::close(fd);
+        });
+    }
+
+    ~local_tcp_server() {
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        ::close(listen_fd_);
+    }
+
+    int port() const { return port_; }
+
+    // wait for the client to close the connection and return what was received
+    std::string join() {
+        thread_.join();
+        return received_;
+    }
+
+private:
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::thread thread_;
+    std::string received_;
+};
+
+// return a local port nobody listens on
+static int closed_port() {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in sa{};
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    REQUIRE(::bind(fd, reinterpret_cast<sockaddr *>(&sa), sizeof(sa)) == 0);
+    socklen_t len = sizeof(sa);
+    ::getsockname(fd, reinterpret_cast<sockaddr *>(&sa), &len);
+    ::close(fd);
+    return ntohs(sa.sin_port);
+}
+
+static std::string expected_messages(int from, int to, int step) {
+    std::string rv;
+    for (int i = from; i < to; i += step) {
+        rv += fmt::format("msg #{}{}", i, spdlog::details::os::default_eol);
+    }
+    return rv;
+}
+
+TEST_CASE("tcp_pool_sink round robin", "[tcp_pool_sink]") {
+    local_tcp_server server1, server2;
+    {
+        spdlog::sinks::tcp_pool_sink_config cfg(
+            {{"127.0.0.1", server1.port()}, {"127.0.0.1", server2.port()}});
+        cfg.batch_size = 0;  // every message is a batch of its own
+        auto sink = std::make_shared<spdlog::sinks::tcp_pool_sink_st>(cfg);
+        sink->set_pattern("%v");
+        spdlog::logger logger("tcp_pool", sink);
+        for (int i = 0; i < 10; i++) {
+            logger.info("msg #{}", i);
+        }
+        REQUIRE(sink->batches_sent() == std::vector<size_t>{5, 5});
+        REQUIRE(sink->healthy_endpoints() == 2);
+    }
+    REQUIRE(server1.join() == expected_messages(0, 10, 2));
+    REQUIRE(server2.join() == expected_messages(1, 10, 2));
+}
+
+TEST_CASE("tcp_pool_sink batches", "[tcp_pool_sink]") {
+    local_tcp_server server;
+    {
+        spdlog::sinks::tcp_pool_sink_config cfg({{"127.0.0.1", server.port()}});
+        cfg.policy = spdlog::sinks::tcp_balance_policy::least_outstanding_bytes;
+        cfg.batch_size = 1024;
+        auto sink = std::make_shared<spdlog::sinks::tcp_pool_sink_st>(cfg);
+        sink->set_pattern("%v");
+        spdlog::logger logger("tcp_pool", sink);
+        for (int i = 0; i < 10; i++) {
+            logger.info("msg #{}", i);
+        }
+        REQUIRE(sink->batches_sent() == std::vector<size_t>{0});
+        logger.flush();
+        REQUIRE(sink->batches_sent() == std::vector<size_t>{1});
+    }
+    REQUIRE(server.join() == expected_messages(0, 10, 1));
+}
+
+TEST_CASE("tcp_pool_sink failover", "[tcp_pool_sink]") {
+    local_tcp_server server;
+    {
+        spdlog::sinks::tcp_pool_sink_config cfg(
+            {{"127.0.0.1", closed_port()}, {"127.0.0.1", server.port()}});
+        cfg.batch_size = 0;
+        auto sink = std::make_shared<spdlog::sinks::tcp_pool_sink_st>(cfg);
+        sink->set_pattern("%v");
+        spdlog::logger logger("tcp_pool", sink);
+        for (int i = 0; i < 10; i++) {
+            logger.info("msg #{}", i);
+        }
+        REQUIRE(sink->healthy_endpoints() == 1);
+        REQUIRE(sink->batches_sent() == std::vector<size_t>{0, 10});
+    }
+    REQUIRE(server.join() == expected_messages(0, 10, 1));
+}
+
+TEST_CASE("tcp_pool_sink no healthy endpoint", "[tcp_pool_sink]") {
+    spdlog::sinks::tcp_pool_sink_config cfg({{"127.0.0.1", closed_port()}});
+    cfg.batch_size = 0;
+    auto sink = std::make_shared<spdlog::sinks::tcp_pool_sink_st>(cfg);
+    sink->set_pattern("%v");
+    spdlog::details::log_msg msg("test", spdlog::level::info, "hello");
+    REQUIRE_THROWS_AS(sink->log(msg), spdlog::spdlog_ex);
+    REQUIRE(sink->healthy_endpoints() == 0);
+    // ejected endpoints are skipped without trying to connect
+    REQUIRE_THROWS_AS(sink->log(msg), spdlog::spdlog_ex);
+}
+
+TEST_CASE("tcp_pool_sink no endpoints", "[tcp_pool_sink]") {
+    REQUIRE_THROWS_AS(spdlog::sinks::tcp_pool_sink_st(spdlog::sinks::tcp_pool_sink_config({})),
+                      spdlog::spdlog_ex);
+}
+
+TEST_CASE("tcp_pool_sink framed", "[tcp_pool_sink]") {
+    local_tcp_server server;
+    {
+        spdlog::sinks::tcp_pool_sink_config cfg({{"127.0.0.1", server.port()}});
+        cfg.batch_size = 1024;
+        cfg.framed = true;
+        auto sink = std::make_shared<spdlog::sinks::tcp_pool_sink_st>(cfg);
+        sink->set_pattern("%v");
+        spdlog::logger logger("tcp_pool", sink);
+        for (int i = 0; i < 10; i++) {
+            logger.info("msg #{}", i);
+        }
+        logger.flush();
+    }
+    auto received = server.join();
+    std::string decoded;
+    uint32_t records = 0;
+    spdlog::details::frame_decoder decoder;
+    // a batch cut short is not decoded
+    decoder.feed(received.data(), received.size() - 1,
+                 [&](spdlog::string_view_t data, uint32_t n) {
+                     decoded.append(data.data(), data.size());
+                     records += n;
+                 });
+    REQUIRE(decoded.empty());
+    decoder.feed(received.data() + received.size() - 1, 1,
+                 [&](spdlog::string_view_t data, uint32_t n) {
+                     decoded.append(data.data(), data.size());
+                     records += n;
+                 });
+    REQUIRE(decoded == expected_messages(0, 10, 1));
+    REQUIRE(records == 10);
+}
+
+TEST_CASE("tcp_pool_sink connect timeout", "[tcp_pool_sink]") {
+    // a non routable address: the connect doesn't fail fast, so only the timeout ends it
+    spdlog::sinks::tcp_pool_sink_config cfg({{"10.255.255.1", 9}});
+    cfg.batch_size = 0;
+    cfg.send_timeout = std::chrono::milliseconds(200);
+    auto sink = std::make_shared<spdlog::sinks::tcp_pool_sink_st>(cfg);
+    spdlog::details::log_msg msg("test", spdlog::level::info, "hello");
+    auto start = std::chrono::steady_clock::now();
+    REQUIRE_THROWS_AS(sink->log(msg), spdlog::spdlog_ex);
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    REQUIRE(sink->healthy_endpoints() == 0);
+}
@@ -0,0 +1,142 @@
+#include "includes.h"
+#include "spdlog/sinks/tcp_sink.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+// accepts a single tcp connection and decodes the frames received until the client closed it
+class framed_tcp_server {
+public:
+    framed_tcp_server() {
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in sa{};
+        sa.sin_family = AF_INET;
+        sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        REQUIRE(::bind(listen_fd_, reinterpret_cast<sockaddr *>(&sa), sizeof(sa)) == 0);
+        REQUIRE(::listen(listen_fd_, 1) == 0);
+        socklen_t len = sizeof(sa);
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&sa), &len);
+        port_ = ntohs(sa.sin_port);
+
+        thread_ = std::thread([this] {
+            int fd = ::accept(listen_fd_, nullptr, nullptr);
+            spdlog::details::frame_decoder decoder;
+            char buf[1000];
+            ssize_t n;
+            while ((n = ::recv(fd, buf, sizeof(buf), 0)) > 0) {
+                received_bytes_ += static_cast<size_t>(n);
+                decoder.feed(buf, static_cast<size_t>(n), [this](spdlog::string_view_t data,
+                                                                 uint32_t records) {
+                    decoded_.append(data.data(), data.size());
+                    records_ += records;
+                    frames_++;
+                });
+            }
+            ::close(fd);
+        });
+    }
+
+    ~framed_tcp_server() {
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        ::close(listen_fd_);
+    }
+
+    int port() const { return port_; }
+
+    // wait for the client to close the connection
+    void join() { thread_.join(); }
+
+    const std::string &decoded() const { return decoded_; }
+    size_t records() const { return records_; }
+    size_t frames() const { return frames_; }
+    size_t received_bytes() const { return received_bytes_; }
+
+private:
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::thread thread_;
+    std::string decoded_;
+    size_t records_ = 0;
+    size_t frames_ = 0;
+    size_t received_bytes_ = 0;
+};
+
+void test_framing(spdlog::sinks::tcp_framing framing) {
+    framed_tcp_server server;
+    std::string expected;
+    {
+        spdlog::sinks::tcp_sink_config cfg("127.0.0.1", server.port());
+        cfg.framing = framing;
+        cfg.frame_size = 4096;
+        auto sink = std::make_shared<spdlog::sinks::tcp_sink_mt>(cfg);
+        sink->set_pattern("[%l] %v");
+        spdlog::logger logger("test", sink);
+        for (int i = 0; i < 1000; i++) {
+            logger.info("message #{} of the framed tcp test", i);
+            expected += spdlog::fmt_lib::format("[info] message #{} of the framed tcp test{}",
+                                                i, spdlog::details::os::default_eol);
+        }
+        logger.flush();
+    }
+    server.join();
+    REQUIRE(server.decoded() == expected);
+    REQUIRE(server.records() == 1000);
+    REQUIRE(server.frames() > 1);
+    if (framing != spdlog::sinks::tcp_framing::stored) {
+        REQUIRE(server.received_bytes() < expected.size() / 4);
+    }
+}
+}  // namespace
+
+TEST_CASE("stored framing", "[tcp_sink]") { test_framing(spdlog::sinks::tcp_framing::stored); }
+
+#ifdef SPDLOG_ZSTD
+TEST_CASE("zstd framing", "[tcp_sink]") { test_framing(spdlog::sinks::tcp_framing::zstd); }
+#else
+TEST_CASE("zstd framing not available", "[tcp_sink]") {
+    spdlog::sinks::tcp_sink_config cfg("127.0.0.1", 0);
+    cfg.framing = spdlog::sinks::tcp_framing::zstd;
+    cfg.lazy_connect = true;
+    REQUIRE_THROWS_AS(spdlog::sinks::tcp_sink_mt(cfg), spdlog::spdlog_ex);
+}
+#endif
+
+#ifdef SPDLOG_LZ4
+TEST_CASE("lz4 framing", "[tcp_sink]") { test_framing(spdlog::sinks::tcp_framing::lz4); }
+#endif
+
+TEST_CASE("frame decoder", "[tcp_sink]") {
+    spdlog::details::frame_encoder encoder(spdlog::details::frame_codec::stored);
+    spdlog::memory_buf_t stream;
+    encoder.encode("first", 1, stream);
+    encoder.encode("", 0, stream);
+    encoder.encode("second\nthird", 2, stream);
+    REQUIRE(stream.size() == 3 * spdlog::details::frame_header::size + 17);
+
+    // fed one byte at a time
+    spdlog::details::frame_decoder decoder;
+    std::vector<std::string> frames;
+    for (size_t i = 0; i < stream.size(); i++) {
+        decoder.feed(stream.data() + i, 1, [&frames](spdlog::string_view_t data, uint32_t) {
+            frames.emplace_back(data.data(), data.size());
+        });
+    }
+    REQUIRE(frames == std::vector<std::string>{"first", "", "second\nthird"});
+    REQUIRE(decoder.pending() == 0);
+
+    spdlog::details::frame_decoder bad_decoder;
+    auto noop = [](spdlog::string_view_t, uint32_t) {};
+    std::string garbage(spdlog::details::frame_header::size, 'x');
+    REQUIRE_THROWS_AS(bad_decoder.feed(garbage.data(), garbage.size(), noop), spdlog::spdlog_ex);
+
+    // a frame larger than the max is rejected from its header, before it is received
+    spdlog::details::frame_decoder small_decoder(16);
+    spdlog::memory_buf_t large;
+    encoder.encode("more than sixteen bytes", 1, large);
+    REQUIRE_THROWS_AS(small_decoder.feed(large.data(), spdlog::details::frame_header::size, noop),
+                      spdlog::spdlog_ex);
+}
@@ -0,0 +1,187 @@
+#include "includes.h"
+#include "spdlog/sinks/tcp_sink.h"
+
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+#include <csignal>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define TEST_CERT_FILE "test_logs/tls_cert.pem"
+#define TEST_KEY_FILE "test_logs/tls_key.pem"
+
+// create a self signed certificate for 127.0.0.1 and save it and its key to the test files
+static void create_self_signed_cert() {
+    prepare_logdir();
+    spdlog::details::os::create_dir(SPDLOG_FILENAME_T("test_logs"));
+
+    EVP_PKEY *pkey = nullptr;
+    EVP_PKEY_CTX *pctx = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr);
+    REQUIRE(EVP_PKEY_keygen_init(pctx) == 1);
+    EVP_PKEY_CTX_set_rsa_keygen_bits(pctx, 2048);
+    REQUIRE(EVP_PKEY_keygen(pctx, &pkey) == 1);
+    EVP_PKEY_CTX_free(pctx);
+
+    X509 *x509 = X509_new();
+    ASN1_INTEGER_set(X509_get_serialNumber(x509), 1);
+    X509_gmtime_adj(X509_getm_notBefore(x509), 0);
+    X509_gmtime_adj(X509_getm_notAfter(x509), 3600);
+    X509_set_pubkey(x509, pkey);
+    auto *name = X509_get_subject_name(x509);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char *>("spdlog-test"), -1, -1, 0);
+    X509_set_issuer_name(x509, name);
+    X509V3_CTX v3ctx;
+    X509V3_set_ctx_nodb(&v3ctx);
+    X509V3_set_ctx(&v3ctx, x509, x509, nullptr, nullptr, 0);
+    auto *san = X509V3_EXT_conf_nid(nullptr, &v3ctx, NID_subject_alt_name,
+                                    const_cast<char *>("IP:127.0.0.1"));
+    X509_add_ext(x509, san, -1);
+    X509_EXTENSION_free(san);
+    REQUIRE(X509_sign(x509, pkey, EVP_sha256()) > 0);
+
+    FILE *f = fopen(TEST_KEY_FILE, "wb");
+    PEM_write_PrivateKey(f, pkey, nullptr, nullptr, 0, nullptr, nullptr);
+    fclose(f);
+    f = fopen(TEST_CERT_FILE, "wb");
+    PEM_write_X509(f, x509);
+    fclose(f);
+    X509_free(x509);
+    EVP_PKEY_free(pkey);
+}
+
+// accepts n_connections tls connections one after the other and saves what was received
+class local_tls_server {
+public:
+    explicit local_tls_server(int n_connections, bool send_tickets = false) {
+        ctx_ = SSL_CTX_new(TLS_server_method());
+        if (!send_tickets) {
+            // tickets sent after a short lived client already closed would fail the connection
+            SSL_CTX_set_num_tickets(ctx_, 0);
+        }
+        REQUIRE(SSL_CTX_use_certificate_file(ctx_, TEST_CERT_FILE, SSL_FILETYPE_PEM) == 1);
+        REQUIRE(SSL_CTX_use_PrivateKey_file(ctx_, TEST_KEY_FILE, SSL_FILETYPE_PEM) == 1);
+
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in sa{};
+        sa.sin_family = AF_INET;
+        sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        REQUIRE(::bind(listen_fd_, reinterpret_cast<sockaddr *>(&sa), sizeof(sa)) == 0);
+        REQUIRE(::listen(listen_fd_, 4) == 0);
+        socklen_t len = sizeof(sa);
+        ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&sa), &len);
+        port_ = ntohs(sa.sin_port);
+
+        thread_ = std::thread([this, n_connections] {
+            // clients that fail verification close the connection mid handshake
+            sigset_t pipe_set;
+            sigemptyset(&pipe_set);
+            sigaddset(&pipe_set, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &pipe_set, nullptr);
+            for (int i = 0; i < n_connections; i++) {
+                serve_one_();
+            }
+        });
+    }
+
+    ~local_tls_server() {
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        ::close(listen_fd_);
+        SSL_CTX_free(ctx_);
+    }
+
+    int port() const { return port_; }
+
+    // wait for all connections to be served and return what was received on each
+    std::vector<std::string> join() {
+        thread_.join();
+        return received_;
+    }
+
+private:
+    void serve_one_() {
+        int fd = ::accept(listen_fd_, nullptr, nullptr);
+        SSL *ssl = SSL_new(ctx_);
+        SSL_set_fd(ssl, fd);
+        std::string data;
+        if (SSL_accept(ssl) == 1) {
+            char buf[4096];
+            int n;
+            while ((n = SSL_read(ssl, buf, sizeof(buf))) > 0) {
+                data.append(buf, static_cast<size_t>(n));
+            }
+        }
+        received_.push_back(data);
+        SSL_free(ssl);
+        ::close(fd);
+    }
+
+    SSL_CTX *ctx_ = nullptr;
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::thread thread_;
+    std::vector<std::string> received_;
+};
+
+TEST_CASE("tls_sink", "[tls_sink]") {
+    create_self_signed_cert();
+    local_tls_server server(1);
+    {
+        spdlog::sinks::tcp_sink_config cfg("127.0.0.1", server.port());
+        cfg.use_tls = true;
+        cfg.tls.ca_file = TEST_CERT_FILE;
+        auto sink = std::make_shared<spdlog::sinks::tcp_sink_st>(cfg);
+        sink->set_pattern("%v");
+        spdlog::logger logger("tls", sink);
+        for (int i = 0; i < 1000; i++) {
+            logger.info("Test message {}", i);
+        }
+        logger.flush();
+    }
+    auto received = server.join();
+    REQUIRE(received.size() == 1);
+
+    std::string expected;
+    for (int i = 0; i < 1000; i++) {
+        expected += fmt::format("Test message {}{}", i, spdlog::details::os::default_eol);
+    }
+    REQUIRE(received[0] == expected);
+}
+
+TEST_CASE("tls_sink verify failure", "[tls_sink]") {
+    create_self_signed_cert();
+    local_tls_server server(1);
+    spdlog::sinks::tcp_sink_config cfg("127.0.0.1", server.port());
+    cfg.use_tls = true;  // no ca_file - the self signed certificate must be rejected
+    REQUIRE_THROWS_AS(spdlog::sinks::tcp_sink_st(cfg), spdlog::spdlog_ex);
+}
+
+TEST_CASE("tls_client session resumption", "[tls_sink]") {
+    create_self_signed_cert();
+    local_tls_server server(2, true);
+
+    spdlog::details::tls_config cfg;
+    cfg.ca_file = TEST_CERT_FILE;
+    spdlog::details::tls_client client(cfg);
+    client.connect("127.0.0.1", server.port());
+    REQUIRE_FALSE(client.session_reused());
+    client.send("first\n", 6);
+    // let the server's session tickets arrive and be processed by the next send
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    client.send("second\n", 7);
+    client.close();
+
+    client.connect("127.0.0.1", server.port());
+    REQUIRE(client.session_reused());
+    client.send("third\n", 6);
+    client.close();
+
+    auto received = server.join();
+    REQUIRE(received.size() == 2);
+    REQUIRE(received[0] == "first\nsecond\n");
+    REQUIRE(received[1] == "third\n");
+}
@@ -0,0 +1,103 @@
+#include "includes.h"
+#include "spdlog/sinks/udp_sink.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// bind a udp socket on the loopback to an ephemeral port and return its port number
+static int open_udp_listener(const char *addr, int family, uint16_t &port) {
+    int fd = ::socket(family, SOCK_DGRAM, 0);
+    REQUIRE(fd != -1);
+    struct timeval tv {};
+    tv.tv_sec = 2;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    if (family == AF_INET) {
+        sockaddr_in sa{};
+        sa.sin_family = AF_INET;
+        ::inet_pton(AF_INET, addr, &sa.sin_addr);
+        REQUIRE(::bind(fd, reinterpret_cast<sockaddr *>(&sa), sizeof(sa)) == 0);
+        socklen_t len = sizeof(sa);
+        ::getsockname(fd, reinterpret_cast<sockaddr *>(&sa), &len);
+        port = ntohs(sa.sin_port);
+    } else {
+        sockaddr_in6 sa{};
+        sa.sin6_family = AF_INET6;
+        ::inet_pton(AF_INET6, addr, &sa.sin6_addr);
+        if (::bind(fd, reinterpret_cast<sockaddr *>(&sa), sizeof(sa)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        socklen_t len = sizeof(sa);
+        ::getsockname(fd, reinterpret_cast<sockaddr *>(&sa), &len);
+        port = ntohs(sa.sin6_port);
+    }
+    return fd;
+}
+
+static std::string recv_datagram(int fd) {
+    char buf[1024];
+    auto n = ::recv(fd, buf, sizeof(buf), 0);
+    REQUIRE(n > 0);
+    return std::string(buf, static_cast<size_t>(n));
+}
+
+TEST_CASE("udp_sink", "[udp_sink]") {
+    uint16_t port = 0;
+    int fd = open_udp_listener("127.0.0.1", AF_INET, port);
+
+    spdlog::sinks::udp_sink_config cfg("127.0.0.1", port);
+    auto sink = std::make_shared<spdlog::sinks::udp_sink_st>(cfg);
+    sink->set_pattern("%v");
+    spdlog::logger logger("udp", sink);
+    logger.info("Hello {}", 1);
+    logger.info("Hello {}", 2);
+
+    REQUIRE(recv_datagram(fd) == std::string("Hello 1") + spdlog::details::os::default_eol);
+    REQUIRE(recv_datagram(fd) == std::string("Hello 2") + spdlog::details::os::default_eol);
+    REQUIRE(sink->dropped_messages() == 0);
+    ::close(fd);
+}
+
+TEST_CASE("udp_sink batch", "[udp_sink]") {
+    uint16_t port = 0;
+    int fd = open_udp_listener("127.0.0.1", AF_INET, port);
+
+    spdlog::sinks::udp_sink_config cfg("127.0.0.1", port);
+    cfg.batch_size = 4;
+    auto sink = std::make_shared<spdlog::sinks::udp_sink_st>(cfg);
+    sink->set_pattern("%v");
+    spdlog::logger logger("udp", sink);
+    for (int i = 0; i < 10; i++) {
+        logger.info("msg #{}", i);
+    }
+    // 8 messages were sent in two batches, the last 2 are sent on flush
+    logger.flush();
+
+    for (int i = 0; i < 10; i++) {
+        auto expected = fmt::format("msg #{}{}", i, spdlog::details::os::default_eol);
+        REQUIRE(recv_datagram(fd) == expected);
+    }
+    REQUIRE(sink->dropped_messages() == 0);
+    ::close(fd);
+}
+
+TEST_CASE("udp_sink ipv6", "[udp_sink]") {
+    uint16_t port = 0;
+    int fd = open_udp_listener("::1", AF_INET6, port);
+    if (fd == -1) {
+        return;  // no ipv6 loopback on this host
+    }
+
+    spdlog::sinks::udp_sink_config cfg("::1", port);
+    auto sink = std::make_shared<spdlog::sinks::udp_sink_st>(cfg);
+    sink->set_pattern("%v");
+    spdlog::logger logger("udp", sink);
+    logger.info("Hello ipv6");
+
+    REQUIRE(recv_datagram(fd) == std::string("Hello ipv6") + spdlog::details::os::default_eol);
+    ::close(fd);
+}
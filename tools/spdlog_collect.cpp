@@ -0,0 +1,173 @@
+//
+// Copyright(c) 2015 Gabi Melman.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+// Drain the shared memory rings written by shm_sink and write each ring's records to its own
+// rotating file, <dir>/<ring name>.log, in large sequential writes.
+// Usage: spdlog_collect --dir <dir> [--max-size bytes] [--max-files n] [--scan] [ring ...]
+// --scan: also collect every ring found in /dev/shm (linux), checked again every second.
+
+#include "spdlog/details/shm_ring.h"
+#include "spdlog/sinks/rotating_file_sink.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+std::atomic<bool> stop_requested{false};
+
+void on_signal(int) { stop_requested = true; }
+
+struct options {
+    std::string dir;
+    size_t max_size = 64 * 1024 * 1024;
+    size_t max_files = 10;
+    bool scan = false;
+    std::vector<std::string> rings;
+};
+
+bool parse_args(int argc, char *argv[], options &opts) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--scan") == 0) {
+            opts.scan = true;
+        } else if (std::strcmp(arg, "--dir") == 0 && value != nullptr) {
+            opts.dir = value;
+            i++;
+        } else if (std::strcmp(arg, "--max-size") == 0 && value != nullptr) {
+            opts.max_size = static_cast<size_t>(std::atoll(value));
+            i++;
+        } else if (std::strcmp(arg, "--max-files") == 0 && value != nullptr) {
+            opts.max_files = static_cast<size_t>(std::atoi(value));
+            i++;
+        } else if (arg[0] == '-') {
+            return false;
+        } else {
+            opts.rings.emplace_back(arg);
+        }
+    }
+    return !opts.dir.empty() && (opts.scan || !opts.rings.empty()) && opts.max_size > 0;
+}
+
+struct collected_ring {
+    std::unique_ptr<spdlog::details::shm_ring> ring;
+    std::shared_ptr<spdlog::sinks::rotating_file_sink_st> sink;
+    bool dirty = false;  // written since the last flush
+};
+
+// names of the rings in /dev/shm
+std::vector<std::string> scan_rings() {
+    std::vector<std::string> names;
+    DIR *dir = ::opendir("/dev/shm");
+    if (dir == nullptr) {
+        return names;
+    }
+    const std::string prefix = "spdlog.";
+    while (auto *entry = ::readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0) {
+            names.push_back(name.substr(prefix.size()));
+        }
+    }
+    ::closedir(dir);
+    return names;
+}
+
+void add_ring(const options &opts,
+              const std::string &name,
+              std::map<std::string, collected_ring> &rings) {
+    if (rings.count(name) != 0) {
+        return;
+    }
+    try {
+        collected_ring r;
+        r.ring = spdlog::details::make_unique<spdlog::details::shm_ring>(name, 4096, 512);
+        r.sink = std::make_shared<spdlog::sinks::rotating_file_sink_st>(
+            opts.dir + "/" + name + ".log", opts.max_size, opts.max_files);
+        r.sink->set_pattern("%v");  // the records were formatted by the producers
+        rings.emplace(name, std::move(r));
+    } catch (const std::exception &ex) {
+        std::fprintf(stderr, "spdlog_collect: %s\n", ex.what());
+    }
+}
+
+// write up to max_records records of the ring to its sink. return the number written.
+size_t collect(const std::string &name, collected_ring &r, size_t max_records) {
+    auto n = r.ring->drain(
+        [&](spdlog::level::level_enum lvl, spdlog::log_clock::time_point time,
+            spdlog::string_view_t data) {
+            spdlog::details::log_msg msg(time, spdlog::source_loc{}, name, lvl, data);
+            r.sink->log(msg);
+        },
+        max_records);
+    r.dirty = r.dirty || n > 0;
+    return n;
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    options opts;
+    if (!parse_args(argc, argv, opts)) {
+        std::fprintf(stderr,
+                     "Usage: %s --dir <dir> [--max-size bytes] [--max-files n] [--scan] "
+                     "[ring ...]\n",
+                     argv[0]);
+        return 2;
+    }
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    std::map<std::string, collected_ring> rings;
+    for (auto &name : opts.rings) {
+        add_ring(opts, name, rings);
+    }
+    auto last_scan = spdlog::log_clock::time_point{};
+    int idle_ms = 0;
+    for (;;) {
+        // drain the rings round robin, in chunks so a busy ring doesn't starve the others
+        const bool stopping = stop_requested;
+        size_t total = 0;
+        for (auto &r : rings) {
+            try {
+                total += collect(r.first, r.second, 4096);
+            } catch (const std::exception &ex) {
+                std::fprintf(stderr, "spdlog_collect: %s: %s\n", r.first.c_str(), ex.what());
+            }
+        }
+        if (total > 0) {
+            idle_ms = 0;
+            continue;
+        }
+        // idle: flush what was written and back off (up to 20ms)
+        for (auto &r : rings) {
+            if (r.second.dirty) {
+                r.second.sink->flush();
+                r.second.dirty = false;
+            }
+        }
+        if (stopping) {
+            break;
+        }
+        auto now = spdlog::log_clock::now();
+        if (opts.scan && now - last_scan > std::chrono::seconds(1)) {
+            for (auto &name : scan_rings()) {
+                add_ring(opts, name, rings);
+            }
+            last_scan = now;
+        }
+        idle_ms = (std::min)(idle_ms + 1, 20);
+        std::this_thread::sleep_for(std::chrono::milliseconds(idle_ms));
+    }
+    return 0;
+}
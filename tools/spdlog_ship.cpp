@@ -0,0 +1,195 @@
+//
+// Copyright(c) 2015 Gabi Melman.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+// Follow the files written by a rotating or daily file sink and forward their records, in
+// batches, to a tcp or udp sink. The position of the last forwarded batch is checkpointed to a
+// file, so after a crash or restart shipping resumes where it stopped, and the records after the
+// checkpoint are sent again (so a batch may be received twice).
+// The checkpoint is written once the sink accepted the batch, which guarantees less than
+// delivery, depending on the transport:
+// --tcp:  each record is written to the socket when logged (flush is a no-op), or with
+//         --framing, the batch is written as frames on flush. Either way the checkpoint only means
+//         the batch was handed to the kernel: if the connection breaks before the collector
+//         read it, the batch is lost (the sink has no acknowledgements).
+// --udp:  datagrams may be dropped by the network or the collector without any error, so records
+//         can be lost silently.
+//
+// Usage: spdlog_ship --file <base filename> [--daily] [--max-files n]
+//                    (--tcp host:port | --udp host:port) [--framing none|stored|zstd|lz4]
+//                    [--checkpoint file] [--batch-bytes n] [--interval-ms n]
+// --file is the filename given to the file sink (without the rotation index or date).
+
+#include "spdlog/details/log_follower.h"
+#include "spdlog/sinks/tcp_sink.h"
+#include "spdlog/sinks/udp_sink.h"
+
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+std::atomic<bool> stop_requested{false};
+
+void on_signal(int) { stop_requested = true; }
+
+struct options {
+    spdlog::filename_t file;
+    spdlog::details::follow_scheme scheme = spdlog::details::follow_scheme::rotating;
+    size_t max_files = 0;
+    bool tcp = true;
+    std::string host;
+    int port = 0;
+    spdlog::sinks::tcp_framing framing = spdlog::sinks::tcp_framing::none;
+    spdlog::filename_t checkpoint;
+    size_t batch_bytes = 64 * 1024;
+    int interval_ms = 1000;
+};
+
+bool parse_endpoint(const char *s, options &opts) {
+    const char *colon = std::strrchr(s, ':');
+    if (colon == nullptr || colon == s) {
+        return false;
+    }
+    opts.host.assign(s, colon);
+    opts.port = std::atoi(colon + 1);
+    return opts.port > 0 && opts.port < 65536;
+}
+
+bool parse_framing(const char *s, spdlog::sinks::tcp_framing &framing) {
+    using spdlog::sinks::tcp_framing;
+    static const struct {
+        const char *name;
+        tcp_framing framing;
+    } names[] = {{"none", tcp_framing::none},
+                 {"stored", tcp_framing::stored},
+                 {"zstd", tcp_framing::zstd},
+                 {"lz4", tcp_framing::lz4}};
+    for (auto &n : names) {
+        if (std::strcmp(s, n.name) == 0) {
+            framing = n.framing;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_args(int argc, char *argv[], options &opts) {
+    bool have_endpoint = false;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--daily") == 0) {
+            opts.scheme = spdlog::details::follow_scheme::daily;
+            continue;
+        }
+        if (value == nullptr) {
+            return false;
+        }
+        i++;
+        if (std::strcmp(arg, "--file") == 0) {
+            opts.file = value;
+        } else if (std::strcmp(arg, "--max-files") == 0) {
+            opts.max_files = static_cast<size_t>(std::atoi(value));
+        } else if (std::strcmp(arg, "--tcp") == 0 || std::strcmp(arg, "--udp") == 0) {
+            opts.tcp = std::strcmp(arg, "--tcp") == 0;
+            if (!parse_endpoint(value, opts)) {
+                return false;
+            }
+            have_endpoint = true;
+        } else if (std::strcmp(arg, "--framing") == 0) {
+            if (!parse_framing(value, opts.framing)) {
+                return false;
+            }
+        } else if (std::strcmp(arg, "--checkpoint") == 0) {
+            opts.checkpoint = value;
+        } else if (std::strcmp(arg, "--batch-bytes") == 0) {
+            opts.batch_bytes = static_cast<size_t>(std::atoll(value));
+        } else if (std::strcmp(arg, "--interval-ms") == 0) {
+            opts.interval_ms = std::atoi(value);
+        } else {
+            return false;
+        }
+    }
+    if (opts.checkpoint.empty()) {
+        opts.checkpoint = opts.file + ".ship";
+    }
+    return !opts.file.empty() && have_endpoint && opts.batch_bytes > 0;
+}
+
+std::shared_ptr<spdlog::sinks::sink> make_sink(const options &opts) {
+    std::shared_ptr<spdlog::sinks::sink> sink;
+    if (opts.tcp) {
+        spdlog::sinks::tcp_sink_config cfg(opts.host, opts.port);
+        cfg.lazy_connect = true;
+        cfg.framing = opts.framing;
+        sink = std::make_shared<spdlog::sinks::tcp_sink_st>(cfg);
+    } else {
+        sink = std::make_shared<spdlog::sinks::udp_sink_st>(
+            spdlog::sinks::udp_sink_config(opts.host, static_cast<uint16_t>(opts.port)));
+    }
+    sink->set_pattern("%v");  // the records are forwarded as they were written
+    return sink;
+}
+
+// forward batches until stopped. throws on sink errors.
+void ship(const options &opts, spdlog::details::follow_position &checkpoint) {
+    using spdlog::details::log_follower;
+    auto sink = make_sink(opts);
+    log_follower follower(opts.file, opts.scheme, opts.max_files, checkpoint);
+    std::vector<std::string> records;
+    while (!stop_requested) {
+        records.clear();
+        follower.read(records, opts.batch_bytes);
+        if (records.empty()) {
+            follower.wait(std::chrono::milliseconds(opts.interval_ms));
+            continue;
+        }
+        for (auto &r : records) {
+            spdlog::details::log_msg msg(spdlog::string_view_t{}, spdlog::level::info,
+                                         spdlog::string_view_t(r.data(), r.size()));
+            sink->log(msg);
+        }
+        sink->flush();
+        // only checkpoint once the batch was sent
+        checkpoint = follower.position();
+        log_follower::save_position(opts.checkpoint, checkpoint);
+    }
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    options opts;
+    if (!parse_args(argc, argv, opts)) {
+        std::fprintf(stderr,
+                     "Usage: %s --file <base filename> [--daily] [--max-files n]\n"
+                     "          (--tcp host:port | --udp host:port) "
+                     "[--framing none|stored|zstd|lz4]\n"
+                     "          [--checkpoint file] [--batch-bytes n] [--interval-ms n]\n",
+                     argv[0]);
+        return 2;
+    }
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    spdlog::details::follow_position checkpoint;
+    spdlog::details::log_follower::load_position(opts.checkpoint, checkpoint);
+    while (!stop_requested) {
+        try {
+            ship(opts, checkpoint);
+        } catch (const std::exception &ex) {
+            // resend from the last checkpoint, after a pause
+            std::fprintf(stderr, "spdlog_ship: %s, retrying from %s offset %llu\n", ex.what(),
+                         spdlog::details::os::filename_to_str(checkpoint.filename).c_str(),
+                         static_cast<unsigned long long>(checkpoint.offset));
+            std::this_thread::sleep_for(std::chrono::milliseconds(opts.interval_ms));
+        }
+    }
+    return 0;
+}
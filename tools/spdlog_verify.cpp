@@ -0,0 +1,51 @@
+//
+// Copyright(c) 2015 Gabi Melman.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+// Verify log files written by integrity_file_sink.
+// Usage: spdlog_verify [-j threads] file1 [file2 ...]
+// Exits with 1 if any file failed verification.
+
+#include "spdlog/sinks/integrity_file_sink.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char *argv[]) {
+    size_t n_threads = 0;
+    std::vector<spdlog::filename_t> filenames;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            n_threads = static_cast<size_t>(std::atoi(argv[++i]));
+        } else {
+#ifdef SPDLOG_WCHAR_FILENAMES
+            spdlog::wmemory_buf_t buf;
+            spdlog::details::os::utf8_to_wstrbuf(argv[i], buf);
+            filenames.emplace_back(buf.data(), buf.size());
+#else
+            filenames.emplace_back(argv[i]);
+#endif
+        }
+    }
+    if (filenames.empty()) {
+        std::fprintf(stderr, "Usage: %s [-j threads] file1 [file2 ...]\n", argv[0]);
+        return 2;
+    }
+
+    auto reports = spdlog::sinks::verify_integrity_files(filenames, n_threads);
+    int rv = 0;
+    for (size_t i = 0; i < reports.size(); i++) {
+        auto name = spdlog::details::os::filename_to_str(filenames[i]);
+        const auto &r = reports[i];
+        if (r.ok) {
+            std::printf("%s: OK (%zu records, %zu checkpoints)\n", name.c_str(), r.records,
+                        r.checkpoints);
+        } else {
+            std::printf("%s: FAILED at offset %zu: %s\n", name.c_str(), r.bad_offset,
+                        r.error.c_str());
+            rv = 1;
+        }
+    }
+    return rv;
+}